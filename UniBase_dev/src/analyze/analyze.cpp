@@ -45,9 +45,13 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         get_clause(x->conds, query->conds);
         check_clause({x->tab_name}, query->conds);        
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
-        // 处理insert 的values值
-        for (auto &sv_val : x->vals) {
-            query->values.push_back(convert_sv_value(sv_val));
+        // 处理insert 的values值，一条语句可以插入多行
+        for (auto &sv_row : x->rows) {
+            std::vector<Value> row;
+            for (auto &sv_val : sv_row) {
+                row.push_back(convert_sv_value(sv_val));
+            }
+            query->values.push_back(std::move(row));
         }
     } else {
         // do nothing
@@ -121,17 +125,60 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
         ColType lhs_type = lhs_col->type;
         ColType rhs_type;
         if (cond.is_rhs_val) {
-            cond.rhs_val.init_raw(lhs_col->len);
             rhs_type = cond.rhs_val.type;
+            if (lhs_type != rhs_type) {
+                throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
+            }
+            if (lhs_col->is_dict()) {
+                check_dict_clause(cond, *lhs_col, nullptr);
+            } else {
+                cond.rhs_val.init_raw(lhs_col->len);
+            }
         } else {
             TabMeta &rhs_tab = sm_manager_->db_.get_table(cond.rhs_col.tab_name);
             auto rhs_col = rhs_tab.get_col(cond.rhs_col.col_name);
             rhs_type = rhs_col->type;
+            if (lhs_type != rhs_type) {
+                throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
+            }
+            if (lhs_col->is_dict() || rhs_col->is_dict()) {
+                check_dict_clause(cond, *lhs_col, &*rhs_col);
+            }
         }
-        if (lhs_type != rhs_type) {
-            throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
+    }
+}
+
+/**
+ * @description: 处理涉及字典编码字段的条件
+ * 与常量的等值比较把常量换成编码，执行时直接比较记录中的编码，常量不在字典中时换成不等于任何编码的NO_CODE；
+ * 范围比较以及不同字典之间的比较只能先解码再比较字符串，此时在条件中记下需要解码的一侧的字典
+ * @param {Condition&} cond 条件
+ * @param {ColMeta&} lhs_col 条件左侧的字段
+ * @param {ColMeta*} rhs_col 条件右侧的字段，右侧为常量时为nullptr
+ */
+void Analyze::check_dict_clause(Condition &cond, const ColMeta &lhs_col, const ColMeta *rhs_col) {
+    bool is_eq = cond.op == OP_EQ || cond.op == OP_NE;
+    ColDict *lhs_dict = sm_manager_->get_col_dict(lhs_col);
+    if (rhs_col == nullptr) {
+        if ((int)cond.rhs_val.str_val.size() > lhs_col.dict_len) {
+            throw StringOverflowError();
         }
+        if (is_eq) {
+            int code = lhs_dict->lookup(cond.rhs_val.str_val);
+            cond.rhs_val.raw = std::make_shared<RmRecord>(sizeof(int));
+            memcpy(cond.rhs_val.raw->data, &code, sizeof(int));
+        } else {
+            cond.rhs_val.init_raw(lhs_col.dict_len);
+            cond.lhs_dict = lhs_dict;
+        }
+        return;
+    }
+    ColDict *rhs_dict = sm_manager_->get_col_dict(*rhs_col);
+    if (is_eq && lhs_dict == rhs_dict) {
+        return;
     }
+    cond.lhs_dict = lhs_dict;
+    cond.rhs_dict = rhs_dict;
 }
 
 
@@ -22,8 +22,8 @@ class Query{
     std::vector<std::string> tables;
     // update 的set 值
     std::vector<SetClause> set_clauses;
-    //insert 的values值
-    std::vector<Value> values;
+    //insert 的values值，每行一个
+    std::vector<std::vector<Value>> values;
 
     Query(){}
 
@@ -44,6 +44,7 @@ private:
     void get_all_cols(const std::vector<std::string> &tab_names, std::vector<ColMeta> &all_cols);
     void get_clause(const std::vector<std::shared_ptr<ast::BinaryExpr>> &sv_conds, std::vector<Condition> &conds);
     void check_clause(const std::vector<std::string> &tab_names, std::vector<Condition> &conds);
+    void check_dict_clause(Condition &cond, const ColMeta &lhs_col, const ColMeta *rhs_col);
     Value convert_sv_value(const std::shared_ptr<ast::Value> &sv_val);
     CompOp convert_sv_comp_op(ast::SvCompOp op);
 };
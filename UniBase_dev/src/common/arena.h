@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * @description: 按语句分配内存的arena（bump allocator）
+ * 每次分配只在当前内存块中移动指针，不单独释放；语句结束时随Context析构或reset一次性释放全部内存。
+ * 超过块大小一半的分配单独占用一个内存块，避免浪费当前块的剩余空间
+ * @note 不是线程安全的，同一个arena只能由执行该语句的线程使用
+ */
+class Arena {
+   public:
+    explicit Arena(size_t block_size = ARENA_BLOCK_SIZE) : block_size_(block_size) {}
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @description: 分配size字节，返回的地址按align对齐
+     * @param {size_t} size 分配的字节数
+     * @param {size_t} align 对齐要求，必须是2的幂
+     */
+    char *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(ptr_) % align) % align;
+        if (ptr_ != nullptr && pad + size <= remaining_) {
+            char *result = ptr_ + pad;
+            ptr_ += pad + size;
+            remaining_ -= pad + size;
+            return result;
+        }
+        if (size > block_size_ / 2) {
+            // 大块内存单独存放，当前块剩余的空间之后仍然可用
+            large_blocks_.emplace_back(new char[size + align]);
+            memory_usage_ += size + align;
+            return align_up(large_blocks_.back().get(), align);
+        }
+        new_block();
+        return allocate(size, align);
+    }
+
+    /* 分配n个T大小的空间，不调用构造函数，只用于平凡类型 */
+    template <typename T>
+    T *allocate_array(size_t n) {
+        return reinterpret_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /* 释放所有分配，只保留第一个内存块供下一条语句复用 */
+    void reset() {
+        large_blocks_.clear();
+        if (blocks_.empty()) {
+            memory_usage_ = 0;
+            return;
+        }
+        blocks_.resize(1);
+        ptr_ = blocks_[0].get();
+        remaining_ = block_size_;
+        memory_usage_ = block_size_;
+    }
+
+    /* 已经向系统申请的内存总量 */
+    size_t memory_usage() const { return memory_usage_; }
+
+   private:
+    size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;   // 大小为block_size_的块，最后一个为当前分配所用的块
+    std::vector<std::unique_ptr<char[]>> large_blocks_;
+    char *ptr_ = nullptr;                           // 当前块中下一次分配的位置
+    size_t remaining_ = 0;                          // 当前块剩余的字节数
+    size_t memory_usage_ = 0;
+
+    static char *align_up(char *ptr, size_t align) {
+        return ptr + (align - reinterpret_cast<uintptr_t>(ptr) % align) % align;
+    }
+
+    void new_block() {
+        blocks_.emplace_back(new char[block_size_]);
+        ptr_ = blocks_.back().get();
+        remaining_ = block_size_;
+        memory_usage_ += block_size_;
+    }
+};
@@ -43,9 +43,14 @@ struct Value {
         str_val = std::move(str_val_);
     }
 
-    void init_raw(int len) {
+    /**
+     * @description: 把值转换为长度为len的字段原始数据
+     * @param {int} len 字段长度
+     * @param {Arena*} arena 不为空时原始数据从语句的arena中分配
+     */
+    void init_raw(int len, Arena *arena = nullptr) {
         assert(raw == nullptr);
-        raw = std::make_shared<RmRecord>(len);
+        raw = arena == nullptr ? std::make_shared<RmRecord>(len) : std::make_shared<RmRecord>(len, arena);
         if (type == TYPE_INT) {
             assert(len == sizeof(int));
             *(int *)(raw->data) = int_val;
@@ -64,12 +69,17 @@ struct Value {
 
 enum CompOp { OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE };
 
+class ColDict;
+
 struct Condition {
     TabCol lhs_col;   // left-hand side column
     CompOp op;        // comparison operator
     bool is_rhs_val;  // true if right-hand side is a value (not a column)
     TabCol rhs_col;   // right-hand side column
     Value rhs_val;    // right-hand side value
+    // 需要先解码成字符串再比较的字典编码字段的字典；等值比较直接比较编码，此时为nullptr
+    const ColDict *lhs_dict = nullptr;
+    const ColDict *rhs_dict = nullptr;
 };
 
 struct SetClause {
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <string>
 
 #define BUFFER_LENGTH 8192
 
@@ -26,6 +27,15 @@ static constexpr int BUFFER_POOL_SIZE = 65536;                                //
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int ARENA_BLOCK_SIZE = (16 * PAGE_SIZE);                    // size of a per-statement arena block
+static constexpr int SEQ_SCAN_MORSEL_PAGES = 64;                              // pages per morsel in parallel seq scan
+static constexpr int SEQ_SCAN_PARALLEL_MIN_PAGES = 256;                       // smaller tables are scanned serially
+static constexpr size_t IX_SORT_MEMORY = (64 * 1024 * 1024);                  // memory for sorting entries in CREATE INDEX 64MB
+static constexpr double IX_FILL_FACTOR = 0.9;                                 // fill factor of bulk-loaded B+tree nodes
+static constexpr int IX_BUILD_PARALLEL_MIN_PAGES = 256;                       // smaller tables are scanned serially in CREATE INDEX
+static constexpr int IX_BUILD_MIN_LEAVES_PER_WORKER = 64;                     // leaves each thread builds at least in parallel bulk load
+static constexpr int IX_COMPRESS_MIN_KEY_LEN = 16;                            // string keys at least this long use compressed B+tree nodes
+static constexpr int IX_SIMD_LINEAR_KEYS = 64;                                // numeric keys scanned linearly with SIMD after binary search narrows to this
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/arena.h"
 #include "transaction/transaction.h"
 #include "transaction/concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
@@ -25,4 +26,5 @@ public:
     char *data_send_;
     int *offset_;
     bool ellipsis_;
+    Arena arena_;       // 本条语句的临时内存，RmRecord、索引键等从这里分配，随Context析构一次性释放
 };
\ No newline at end of file
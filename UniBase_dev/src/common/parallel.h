@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * @description: 用num_workers个线程分别执行task(0), ..., task(num_workers - 1)，等待全部结束后返回
+ * num_workers为1时直接在当前线程执行；任务抛出异常时等其他任务结束后重新抛出编号最小的任务的异常
+ * @param {size_t} num_workers 线程个数
+ * @param {function<void(size_t)>} task 任务，参数为任务编号
+ */
+inline void parallel_for(size_t num_workers, const std::function<void(size_t)> &task) {
+    if (num_workers <= 1) {
+        task(0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(num_workers);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_workers; i++) {
+        workers.emplace_back([&, i] {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto &error : errors) {
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/* 默认的工作线程个数 */
+inline size_t default_num_workers() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
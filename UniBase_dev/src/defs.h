@@ -42,6 +42,12 @@ inline std::string coltype2str(ColType type) {
     return m.at(type);
 }
 
+/* 索引的组织方式，在建索引时用USING指定 */
+enum IndexType {
+    INDEX_BTREE,    // B+树，支持等值查找和范围扫描
+    INDEX_HASH      // 可扩展哈希，只支持等值查找
+};
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -61,6 +61,21 @@ class InvalidRecordSizeError : public UniBaseError {
     InvalidRecordSizeError(int record_size) : UniBaseError("Invalid record size: " + std::to_string(record_size)) {}
 };
 
+class InvalidStorageTypeError : public UniBaseError {
+   public:
+    InvalidStorageTypeError(const std::string &storage) : UniBaseError("Invalid storage type: " + storage) {}
+};
+
+class InvalidIndexTypeError : public UniBaseError {
+   public:
+    InvalidIndexTypeError(const std::string &type) : UniBaseError("Invalid index type: " + type) {}
+};
+
+class VacuumInTransactionError : public UniBaseError {
+   public:
+    VacuumInTransactionError() : UniBaseError("VACUUM cannot run inside a transaction block") {}
+};
+
 // IX errors
 class InvalidColLengthError : public UniBaseError {
    public:
@@ -122,6 +137,11 @@ class IndexExistsError : public UniBaseError {
     }
 };
 
+class IndexDuplicateKeyError : public UniBaseError {
+   public:
+    IndexDuplicateKeyError() : UniBaseError("Duplicate key in unique index") {}
+};
+
 // QL errors
 class InvalidValueCountError : public UniBaseError {
    public:
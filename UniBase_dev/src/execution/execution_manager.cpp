@@ -13,20 +13,23 @@
 const char *help_info = "Supported SQL syntax:\n"
                    "  command ;\n"
                    "command:\n"
-                   "  CREATE TABLE table_name (column_name type [, column_name type ...])\n"
+                   "  CREATE TABLE table_name (column_name type [, column_name type ...]) [USING {FIXED | SLOTTED | PAX}]\n"
                    "  DROP TABLE table_name\n"
-                   "  CREATE INDEX table_name (column_name)\n"
+                   "  CREATE [NONUNIQUE] INDEX table_name (column_name) [INCLUDE (column_name [, column_name ...])]\n"
+                   "    [USING {BTREE | HASH}]\n"
                    "  DROP INDEX table_name (column_name)\n"
+                   "  VACUUM table_name\n"
                    "  INSERT INTO table_name VALUES (value [, value ...])\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
                    "type:\n"
-                   "  {INT | FLOAT | CHAR(n)}\n"
+                   "  {INT | FLOAT | CHAR(n) [DICT]}\n"
                    "where_clause:\n"
                    "  condition [AND condition ...]\n"
                    "condition:\n"
                    "  column op {column | value}\n"
+                   "  column BETWEEN value AND value\n"
                    "column:\n"
                    "  [table_name.]column_name\n"
                    "op:\n"
@@ -40,7 +43,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->storage_type_);
                 break;
             }
             case T_DropTable:
@@ -50,7 +53,8 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->unique_index_,
+                                          x->include_col_names_, x->index_type_);
                 break;
             }
             case T_DropIndex:
@@ -58,6 +62,11 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
                 sm_manager_->drop_index(x->tab_name_, x->tab_col_names_, context);
                 break;
             }
+            case T_VacuumTable:
+            {
+                sm_manager_->vacuum_table(x->tab_name_, context);
+                break;
+            }
             default:
                 throw InternalError("Unexpected field type");
                 break;  
@@ -140,16 +149,25 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
     }
     outfile << "\n";
 
+    // 字典编码字段输出时需要解码
+    std::vector<const ColDict *> dicts;
+    for (auto &col : executorTreeRoot->cols()) {
+        dicts.push_back(sm_manager_->get_col_dict(col));
+    }
+
     // Print records
     size_t num_rec = 0;
     // 执行query_plan
     for (executorTreeRoot->beginTuple(); !executorTreeRoot->is_end(); executorTreeRoot->nextTuple()) {
         auto Tuple = executorTreeRoot->Next();
         std::vector<std::string> columns;
-        for (auto &col : executorTreeRoot->cols()) {
+        for (size_t i = 0; i < executorTreeRoot->cols().size(); i++) {
+            auto &col = executorTreeRoot->cols()[i];
             std::string col_str;
             char *rec_buf = Tuple->data + col.offset;
-            if (col.type == TYPE_INT) {
+            if (dicts[i] != nullptr) {
+                col_str = dicts[i]->decode(*(int *)rec_buf);
+            } else if (col.type == TYPE_INT) {
                 col_str = std::to_string(*(int *)rec_buf);
             } else if (col.type == TYPE_FLOAT) {
                 col_str = std::to_string(*(float *)rec_buf);
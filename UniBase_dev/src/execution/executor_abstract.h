@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include "execution_defs.h"
 #include "common/common.h"
 #include "index/ix.h"
@@ -43,4 +45,105 @@ class AbstractExecutor {
         }
         return pos;
     }
+
+    /**
+     * @description: 直接在记录的原始数据上判断所有条件是否成立，不需要把记录或字段拷贝出来
+     * @param {vector<ColMeta>&} rec_cols 记录的字段
+     * @param {vector<Condition>&} conds 条件，多个条件之间为AND
+     * @param {char*} data 记录数据，可以直接指向缓冲池中的页面
+     */
+    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const char *data) {
+        for (auto &cond : conds) {
+            if (!eval_cond(rec_cols, cond, data)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const char *data) {
+        auto lhs_col = get_col(rec_cols, cond.lhs_col);
+        const char *lhs = data + lhs_col->offset;
+        int cmp;
+        if (!cond.is_rhs_val) {
+            auto rhs_col = get_col(rec_cols, cond.rhs_col);
+            cmp = compare_cond(cond, *lhs_col, lhs, rhs_col->type, data + rhs_col->offset, rhs_col->len);
+        } else {
+            std::string buf;
+            const char *rhs = get_rhs_raw(*lhs_col, cond, &buf);
+            cmp = compare_cond(cond, *lhs_col, lhs, cond.rhs_val.type, rhs, get_rhs_len(*lhs_col, cond));
+        }
+        return eval_op(cond.op, cmp);
+    }
+
+    /**
+     * @description: 比较条件两侧的原始数据；条件中记有字典时，先把该侧的编码解码成字符串，再按字符串比较
+     * @param {Condition&} cond 条件
+     * @param {ColMeta&} lhs_col 条件左侧的字段
+     * @param {char*} lhs 左侧的原始数据
+     * @param {ColType} rhs_type 右侧的类型
+     * @param {char*} rhs 右侧的原始数据
+     * @param {int} rhs_len 右侧原始数据的长度
+     */
+    static int compare_cond(const Condition &cond, const ColMeta &lhs_col, const char *lhs, ColType rhs_type,
+                            const char *rhs, int rhs_len) {
+        if (cond.lhs_dict == nullptr && cond.rhs_dict == nullptr) {
+            return compare_raw(lhs_col.type, lhs, rhs_type, rhs, lhs_col.len);
+        }
+        return get_str(cond.lhs_dict, lhs, lhs_col.len).compare(get_str(cond.rhs_dict, rhs, rhs_len));
+    }
+
+    // CHAR字段的值，不含末尾补齐的'\0'；dict不为空时raw中是编码
+    static std::string_view get_str(const ColDict *dict, const char *raw, int len) {
+        if (dict != nullptr) {
+            return dict->decode(*reinterpret_cast<const int *>(raw));
+        }
+        return std::string_view(raw, strnlen(raw, len));
+    }
+
+    // 条件右侧常量原始数据的长度
+    static int get_rhs_len(const ColMeta &lhs_col, const Condition &cond) {
+        return cond.rhs_val.raw != nullptr ? cond.rhs_val.raw->size : lhs_col.len;
+    }
+
+    /**
+     * @description: 取出条件右侧常量的原始数据，与左侧字段按compare_raw比较
+     * @param {ColMeta&} lhs_col 条件左侧的字段
+     * @param {Condition&} cond 右侧为常量的条件
+     * @param {string*} buf 字符串常量需要补齐到字段长度，补齐后的数据放在buf中
+     */
+    static const char *get_rhs_raw(const ColMeta &lhs_col, const Condition &cond, std::string *buf) {
+        if (cond.rhs_val.raw != nullptr) {
+            return cond.rhs_val.raw->data;
+        }
+        if (cond.rhs_val.type == TYPE_STRING) {
+            *buf = cond.rhs_val.str_val;
+            buf->resize(lhs_col.len, '\0');
+            return buf->data();
+        }
+        return reinterpret_cast<const char *>(&cond.rhs_val.int_val);
+    }
+
+    // 根据比较结果判断条件是否成立
+    static bool eval_op(CompOp op, int cmp) {
+        switch (op) {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            case OP_GE: return cmp >= 0;
+            default: return false;
+        }
+    }
+
+    // 比较两个字段的原始数据，INT和FLOAT之间按数值比较，CHAR按len字节比较
+    static int compare_raw(ColType lhs_type, const char *lhs, ColType rhs_type, const char *rhs, int len) {
+        if (lhs_type == TYPE_STRING || rhs_type == TYPE_STRING) {
+            return memcmp(lhs, rhs, len);
+        }
+        double lhs_val = lhs_type == TYPE_INT ? *reinterpret_cast<const int *>(lhs) : *reinterpret_cast<const float *>(lhs);
+        double rhs_val = rhs_type == TYPE_INT ? *reinterpret_cast<const int *>(rhs) : *reinterpret_cast<const float *>(rhs);
+        return lhs_val < rhs_val ? -1 : (lhs_val > rhs_val ? 1 : 0);
+    }
 };
\ No newline at end of file
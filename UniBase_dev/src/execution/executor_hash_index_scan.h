@@ -0,0 +1,61 @@
+#pragma once
+
+#include "executor_index_scan.h"
+
+/**
+ * 哈希索引扫描：所有key字段上都有等值条件，用这些值拼成key在哈希索引中查找一次，得到全部匹配的rid后逐个读取记录
+ * 其余条件仍需在记录上判断
+ */
+class HashIndexScanExecutor : public IndexScanExecutor {
+    std::vector<Rid> rids_;     // 哈希索引中查到的rid，按(page_no, slot_no)排列
+    size_t pos_;                // 下一个要读取的rid在rids_中的下标
+
+public:
+    HashIndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                          std::vector<std::string> index_col_names, Context *context)
+        : IndexScanExecutor(sm_manager, std::move(tab_name), std::move(conds), std::move(index_col_names), context) {}
+
+    std::string getType() override { return "HashIndexScanExecutor"; }
+
+    void beginTuple() override {
+        // INCLUDE字段不参与查找，填0即可
+        std::vector<char> key(index_meta_.col_tot_len, 0);
+        int offset = 0;
+        for (size_t i = 0; i < index_meta_.key_num(); i++) {
+            const ColMeta &col = index_meta_.cols[i];
+            auto eq = std::find_if(fed_conds_.begin(), fed_conds_.end(), [&](const Condition &cond) {
+                return cond.op == OP_EQ && is_index_cond(cond, col);
+            });
+            if (eq == fed_conds_.end()) {
+                throw InternalError("Hash index scan without equality condition on " + col.name);
+            }
+            std::string buf;
+            memcpy(key.data() + offset, get_rhs_raw(col, *eq, &buf), col.len);
+            offset += col.len;
+        }
+        rids_.clear();
+        ih_->get_value(key.data(), &rids_, context_ == nullptr ? nullptr : context_->txn_);
+        pos_ = 0;
+        end_ = false;
+        find_next();
+    }
+
+    void nextTuple() override {
+        if (!end_) {
+            find_next();
+        }
+    }
+
+protected:
+    /* 从rids_的当前位置起找到第一条满足所有条件的记录 */
+    void find_next() override {
+        while (pos_ < rids_.size()) {
+            rid_ = rids_[pos_++];
+            if (fetch_if_match(rid_)) {
+                return;
+            }
+        }
+        rec_ = nullptr;
+        end_ = true;
+    }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "executor_index_scan.h"
+
+/**
+ * 仅索引扫描：查询用到的字段都在索引的键字段或INCLUDE字段中，直接由索引项拼出记录，不再读取表中的记录
+ * 扫描范围的确定与IndexScanExecutor相同
+ */
+class IndexOnlyScanExecutor : public IndexScanExecutor {
+public:
+    IndexOnlyScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
+                          std::vector<std::string> index_col_names, Context *context)
+        : IndexScanExecutor(sm_manager, std::move(tab_name), std::move(conds), std::move(index_col_names), context) {}
+
+    std::string getType() override { return "IndexOnlyScanExecutor"; }
+
+    void beginTuple() override {
+        // 不读表中的记录也就不会加行锁，改为给整张表加S锁
+        if (context_ != nullptr && context_->lock_mgr_ != nullptr) {
+            context_->lock_mgr_->lock_shared_on_table(context_->txn_, fh_->GetFd());
+        }
+        IndexScanExecutor::beginTuple();
+    }
+
+protected:
+    /**
+     * @description: 从扫描的当前位置起找到第一个满足所有条件的索引项，把索引中的字段值放到记录的对应位置上
+     * 不在索引中的字段填0，上层不会用到这些字段
+     */
+    void find_next() override {
+        std::vector<char> key(index_meta_.col_tot_len);
+        for (; !scan_->is_end(); scan_->next()) {
+            scan_->get_entry(key.data(), &rid_);
+            rec_ = std::make_unique<RmRecord>(len_);
+            memset(rec_->data, 0, len_);
+            int offset = 0;
+            for (auto &col : index_meta_.cols) {
+                memcpy(rec_->data + col.offset, key.data() + offset, col.len);
+                offset += col.len;
+            }
+            if (eval_conds(cols_, fed_conds_, rec_->data)) {
+                return;
+            }
+        }
+        rec_ = nullptr;
+        end_ = true;
+    }
+};
@@ -1,63 +1,17 @@
 #pragma once
 
+#include <climits>
+#include <limits>
+#include <map>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
-#include <map>
-
-// 定义比较操作符
-enum CompOp
-{
-    OP_EQ, // Equal
-    OP_NE, // Not equal
-    OP_LT, // Less than
-    OP_LE, // Less than or equal to
-    OP_GT, // Greater than
-    OP_GE  // Greater than or equal to
-};
-
-// 示例 Value 类，假设包含一个简单的 int 值
-class Value
-{
-public:
-    int val;
-
-    bool equals(const Value &other) const
-    {
-        return val == other.val;
-    }
 
-    bool not_equals(const Value &other) const
-    {
-        return val != other.val;
-    }
-
-    bool less_than(const Value &other) const
-    {
-        return val < other.val;
-    }
-
-    bool less_than_equal(const Value &other) const
-    {
-        return val <= other.val;
-    }
-
-    bool greater_than(const Value &other) const
-    {
-        return val > other.val;
-    }
-
-    bool greater_than_equal(const Value &other) const
-    {
-        return val >= other.val;
-    }
-};
-
-class IndexScanExecutor : public AbstractExecutor
-{
-private:
+class IndexScanExecutor : public AbstractExecutor {
+protected:
     std::string tab_name_;             // 表名称
     TabMeta tab_;                      // 表的元数据
     std::vector<Condition> conds_;     // 扫描条件
@@ -70,17 +24,16 @@ private:
     IndexMeta index_meta_;                     // 索引的元数据
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
     SmManager *sm_manager_;
-    BufferPoolManager *bpm_;  // 缓冲池管理器
-    const IxIndexHandle *ih_; // 索引句柄
+    IxIndexHandle *ih_;                 // 索引句柄
+    bool end_;
+    std::unique_ptr<RmRecord> rec_;     // 当前满足条件的记录
+    RmRecordView view_;                 // 判断条件时使用的记录视图，不满足条件的记录不拷贝
 
 public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds,
-                      std::vector<std::string> index_col_names, Context *context,
-                      BufferPoolManager *bpm, const IxIndexHandle *ih)
-        : bpm_(bpm), ih_(ih)
-    {
+                      std::vector<std::string> index_col_names, Context *context) {
         sm_manager_ = sm_manager;
         context_ = context;
         tab_name_ = std::move(tab_name);
@@ -89,81 +42,69 @@ public:
         index_col_names_ = std::move(index_col_names);
         index_meta_ = *(tab_.get_index_meta(index_col_names_));
         fh_ = sm_manager_->fhs_.at(tab_name_).get();
+        ih_ = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index_meta_.cols)).get();
         cols_ = tab_.cols;
         len_ = cols_.back().offset + cols_.back().len;
+        end_ = true;
 
-        // 处理扫描条件，确保连接运算的条件谓词正确
+        // 把本表的字段换到条件左侧，便于按索引字段查找条件
         std::map<CompOp, CompOp> swap_op = {
             {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
         };
 
-        for (auto &cond : conds_)
-        {
-            if (cond.lhs_col.tab_name != tab_name_)
-            {
+        for (auto &cond : conds_) {
+            if (cond.lhs_col.tab_name != tab_name_) {
                 assert(!cond.is_rhs_val && cond.rhs_col.tab_name == tab_name_);
                 std::swap(cond.lhs_col, cond.rhs_col);
+                std::swap(cond.lhs_dict, cond.rhs_dict);
                 cond.op = swap_op.at(cond.op);
             }
         }
         fed_conds_ = conds_;
     }
 
-    void beginTuple() override
-    {
-        // 初始化索引扫描
-        Iid lower = ih_->leaf_begin();
-        Iid upper = ih_->leaf_end();
+    size_t tupleLen() const override { return len_; }
 
-        // 根据条件调整 lower 和 upper
-        adjust_bounds(lower, upper);
+    const std::vector<ColMeta> &cols() const override { return cols_; }
 
-        scan_ = std::make_unique<IxScan>(ih_, lower, upper, bpm_);
+    std::string getType() override { return "IndexScanExecutor"; }
 
-        // 找到第一个满足谓词条件的元组
-        nextTuple();
+    void beginTuple() override {
+        Iid lower, upper;
+        if (!get_bounds(&lower, &upper)) {
+            scan_ = nullptr;
+            rec_ = nullptr;
+            end_ = true;
+            return;
+        }
+        scan_ = std::make_unique<IxScan>(ih_, lower, upper, sm_manager_->get_bpm());
+        end_ = false;
+        find_next();
     }
 
-    void nextTuple() override
-    {
-        while (!scan_->is_end())
-        {
+    void nextTuple() override {
+        if (!end_) {
             scan_->next();
-            rid_ = scan_->rid();
-            try
-            {
-                auto rec = fh_->get_record(rid_, context_);
-                if (eval_conds(rec.get()))
-                {
-                    return; // 满足谓词条件，停止扫描
-                }
-            }
-            catch (RecordNotFoundError &e)
-            {
-                std::cerr << e.what() << std::endl;
-            }
+            find_next();
         }
     }
 
-    std::unique_ptr<RmRecord> Next() override
-    {
-        if (scan_->is_end())
-        {
-            return nullptr; // 如果扫描结束，返回空指针
+    bool is_end() const override { return end_; }
+
+    std::unique_ptr<RmRecord> Next() override {
+        if (end_) {
+            return nullptr;
         }
-        auto rec = fh_->get_record(rid_, context_);
-        nextTuple(); // 准备下一个满足谓词条件的记录
-        return rec;  // 返回当前满足谓词条件的记录
+        auto rec = std::move(rec_);
+        nextTuple();
+        return rec;
     }
 
-    void updateFeed(const std::map<TabCol, Value> &feed_dict)
-    {
+    void updateFeed(const std::map<TabCol, Value> &feed_dict) {
         fed_conds_.clear();
-        for (auto &cond : conds_)
-        {
+        for (auto &cond : conds_) {
             Condition new_cond = cond;
-            if (feed_dict.find(cond.lhs_col) != feed_dict.end())
-            {
+            if (feed_dict.find(cond.lhs_col) != feed_dict.end()) {
                 new_cond.rhs_val = feed_dict.at(cond.lhs_col);
                 new_cond.is_rhs_val = true;
             }
@@ -173,76 +114,152 @@ public:
 
     Rid &rid() override { return rid_; }
 
-private:
-    bool eval_conds(const RmRecord *record)
-    {
-        for (const auto &cond : fed_conds_)
-        {
-            // 获取记录中左列和右值（或右列）的值
-            Value lhs_value = get_value(record, cond.lhs_col);
-            Value rhs_value = cond.is_rhs_val ? cond.rhs_val : get_value(record, cond.rhs_col);
-
-            // 判断条件是否满足
-            if (!compare(lhs_value, rhs_value, cond.op))
-            {
-                return false; // 如果有一个条件不满足，返回false
+protected:
+    /**
+     * @description: 从扫描的当前位置起找到第一条满足所有条件的记录，放到rec_中由Next交给上层
+     * 扫描范围只由索引前导字段上的条件确定，其余条件仍需在记录上判断
+     */
+    virtual void find_next() {
+        for (; !scan_->is_end(); scan_->next()) {
+            rid_ = scan_->rid();
+            if (fetch_if_match(rid_)) {
+                return;
             }
         }
-        return true; // 所有条件都满足，返回true
+        rec_ = nullptr;
+        end_ = true;
     }
 
-    Value get_value(const RmRecord *record, const TabCol &col)
-    {
-        // 获取列元数据
-        auto col_meta = std::find_if(cols_.begin(), cols_.end(), [&](const ColMeta &meta)
-                                     { return meta.tab_name == col.tab_name && meta.name == col.col_name; });
-        if (col_meta == cols_.end())
-        {
-            throw std::runtime_error("Column not found");
+    /**
+     * @description: 在记录视图上判断rid处的记录是否满足所有条件，满足时才把记录拷贝到rec_中
+     * @return {bool} 记录存在且满足条件
+     */
+    bool fetch_if_match(const Rid &rid) {
+        try {
+            fh_->get_record_view(rid, context_, &view_);
+        } catch (RecordNotFoundError &e) {
+            return false;
+        }
+        bool match = eval_conds(cols_, fed_conds_, view_.data());
+        if (match) {
+            rec_ = view_.to_record();
         }
-        Value value;
-        memcpy(&value.val, record->data + col_meta->offset, sizeof(int));
-        return value;
+        // 视图持有页面的读锁，推进索引扫描之前释放
+        view_.release();
+        return match;
     }
 
-    bool compare(const Value &lhs, const Value &rhs, CompOp op)
-    {
-        // 使用 Value 类中的比较方法进行比较
-        switch (op)
-        {
-        case OP_EQ:
-            return lhs.equals(rhs);
-        case OP_NE:
-            return lhs.not_equals(rhs);
-        case OP_LT:
-            return lhs.less_than(rhs);
-        case OP_LE:
-            return lhs.less_than_equal(rhs);
-        case OP_GT:
-            return lhs.greater_than(rhs);
-        case OP_GE:
-            return lhs.greater_than_equal(rhs);
-        default:
-            return false;
-        }
+    /**
+     * @description: 条件能否用来确定索引字段col上的扫描范围：本表字段与常量比较，且不是需要解码比较的字典编码字段
+     */
+    bool is_index_cond(const Condition &cond, const ColMeta &col) const {
+        return cond.is_rhs_val && cond.op != OP_NE && cond.lhs_dict == nullptr &&
+               cond.lhs_col.tab_name == tab_name_ && cond.lhs_col.col_name == col.name;
     }
 
-    void adjust_bounds(Iid &lower, Iid &upper)
-    {
-        // 根据条件调整 lower 和 upper 的逻辑
-        for (const auto &cond : fed_conds_)
-        {
-            // 示例逻辑，可以根据具体情况调整
-            if (cond.op == OP_LT || cond.op == OP_LE)
-            {
-                // 调整 upper
-                // 示例：upper = ih_->find_upper_bound(cond.value);
+    /**
+     * @description: 根据索引前导字段上的条件确定扫描范围[lower, upper)
+     * 从第一个索引字段开始，有等值条件的字段固定为该值后继续看下一个字段；
+     * 遇到只有<、<=、>、>=条件的字段时取其中最紧的上下界后停止，之后的字段和INCLUDE字段用该类型的最小值或最大值补齐
+     * @param {Iid*} lower 扫描的起点
+     * @param {Iid*} upper 扫描的终点，不含
+     * @return {bool} 上下界矛盾、范围为空时返回false
+     */
+    bool get_bounds(Iid *lower, Iid *upper) {
+        std::vector<char> lower_key(index_meta_.col_tot_len);
+        std::vector<char> upper_key(index_meta_.col_tot_len);
+        int lower_len = 0;          // lower_key中由条件确定的前缀长度
+        int upper_len = 0;
+        bool lower_open = false;    // 下界不含边界值本身，即条件为>
+        bool upper_open = false;    // 上界不含边界值本身，即条件为<
+        for (size_t i = 0; i < index_meta_.key_num(); i++) {
+            const ColMeta &col = index_meta_.cols[i];
+            int offset = lower_len;
+            auto eq = std::find_if(fed_conds_.begin(), fed_conds_.end(), [&](const Condition &cond) {
+                return cond.op == OP_EQ && is_index_cond(cond, col);
+            });
+            if (eq != fed_conds_.end()) {
+                std::string buf;
+                const char *rhs = get_rhs_raw(col, *eq, &buf);
+                memcpy(lower_key.data() + offset, rhs, col.len);
+                memcpy(upper_key.data() + offset, rhs, col.len);
+                lower_len += col.len;
+                upper_len += col.len;
+                continue;
             }
-            else if (cond.op == OP_GT || cond.op == OP_GE)
-            {
-                // 调整 lower
-                // 示例：lower = ih_->find_lower_bound(cond.value);
+            bool has_lower = false;
+            bool has_upper = false;
+            for (auto &cond : fed_conds_) {
+                if (!is_index_cond(cond, col)) {
+                    continue;
+                }
+                std::string buf;
+                const char *rhs = get_rhs_raw(col, cond, &buf);
+                bool open = cond.op == OP_GT || cond.op == OP_LT;
+                if (cond.op == OP_GT || cond.op == OP_GE) {
+                    int cmp = has_lower ? compare_raw(col.type, rhs, col.type, lower_key.data() + offset, col.len) : 1;
+                    if (cmp > 0 || (cmp == 0 && open)) {
+                        memcpy(lower_key.data() + offset, rhs, col.len);
+                        lower_open = open;
+                        has_lower = true;
+                    }
+                } else {
+                    int cmp = has_upper ? compare_raw(col.type, rhs, col.type, upper_key.data() + offset, col.len) : -1;
+                    if (cmp < 0 || (cmp == 0 && open)) {
+                        memcpy(upper_key.data() + offset, rhs, col.len);
+                        upper_open = open;
+                        has_upper = true;
+                    }
+                }
             }
+            if (has_lower && has_upper) {
+                int cmp = compare_raw(col.type, lower_key.data() + offset, col.type, upper_key.data() + offset, col.len);
+                if (cmp > 0 || (cmp == 0 && (lower_open || upper_open))) {
+                    return false;
+                }
+            }
+            lower_len += has_lower ? col.len : 0;
+            upper_len += has_upper ? col.len : 0;
+            break;
+        }
+
+        // 下界为>=时补最小值、从第一个不小于它的键开始；为>时补最大值、跳过所有等于边界值的键。上界反之
+        int offset = 0;
+        for (auto &col : index_meta_.cols) {
+            if (offset >= lower_len) {
+                fill_bound(col, lower_open, lower_key.data() + offset);
+            }
+            if (offset >= upper_len) {
+                fill_bound(col, !upper_open, upper_key.data() + offset);
+            }
+            offset += col.len;
+        }
+        if (lower_len == 0) {
+            *lower = ih_->leaf_begin();
+        } else {
+            *lower = lower_open ? ih_->upper_bound(lower_key.data()) : ih_->lower_bound(lower_key.data());
+        }
+        if (upper_len == 0) {
+            *upper = ih_->leaf_end();
+        } else {
+            *upper = upper_open ? ih_->lower_bound(upper_key.data()) : ih_->upper_bound(upper_key.data());
+        }
+        return true;
+    }
+
+    /**
+     * @description: 用字段类型的最大值或最小值填充键中没有条件约束的字段
+     * @param {bool} is_max 为true时填最大值，否则填最小值
+     */
+    static void fill_bound(const ColMeta &col, bool is_max, char *dest) {
+        if (col.type == TYPE_INT) {
+            int val = is_max ? INT_MAX : INT_MIN;
+            memcpy(dest, &val, sizeof(int));
+        } else if (col.type == TYPE_FLOAT) {
+            float val = is_max ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+            memcpy(dest, &val, sizeof(float));
+        } else {
+            memset(dest, is_max ? 0xff : 0, col.len);
         }
     }
 };
@@ -8,53 +8,87 @@
 class InsertExecutor : public AbstractExecutor {
    private:
     TabMeta tab_;                   // 表的元数据
-    std::vector<Value> values_;     // 需要插入的数据
+    std::vector<std::vector<Value>> values_;    // 需要插入的数据，每行一个
     RmFileHandle *fh_;              // 表的数据文件句柄
     std::string tab_name_;          // 表名称
-    Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值
+    Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值；多行时为最后一行的位置
     SmManager *sm_manager_;
 
    public:
-    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Value> values, Context *context) {
+    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<std::vector<Value>> values,
+                   Context *context) {
         sm_manager_ = sm_manager;
         tab_ = sm_manager_->db_.get_table(tab_name);
-        values_ = values;
+        values_ = std::move(values);
         tab_name_ = tab_name;
-        if (values.size() != tab_.cols.size()) {
+        if (values_.empty()) {
             throw InvalidValueCountError();
         }
+        for (auto &row : values_) {
+            if (row.size() != tab_.cols.size()) {
+                throw InvalidValueCountError();
+            }
+        }
         fh_ = sm_manager_->fhs_.at(tab_name).get();
         context_ = context;
     };
 
     std::unique_ptr<RmRecord> Next() override {
-        // Make record buffer
-        RmRecord rec(fh_->get_file_hdr().record_size);
-        for (size_t i = 0; i < values_.size(); i++) {
-            auto &col = tab_.cols[i];
-            auto &val = values_[i];
-            if (col.type != val.type) {
-                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
-            }
-            val.init_raw(col.len);
-            memcpy(rec.data + col.offset, val.raw->data, col.len);
+        // Make record buffer，多行的记录连续存放
+        int record_size = fh_->get_file_hdr().record_size;
+        char *bufs = context_->arena_.allocate((size_t)record_size * values_.size());
+        for (size_t r = 0; r < values_.size(); r++) {
+            make_record(values_[r], bufs + (size_t)r * record_size);
+        }
+
+        // Insert into record file，多行时走批量插入，每个页面只pin一次、整页的记录一次加锁
+        std::vector<Rid> rids;
+        if (values_.size() == 1) {
+            rids.push_back(fh_->insert_record(bufs, context_));
+        } else {
+            rids = fh_->insert_records(bufs, values_.size(), context_);
         }
-        // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
+        rid_ = rids.back();
         
         // Insert into index
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            char* key = context_->arena_.allocate(index.col_tot_len);
+            for (size_t r = 0; r < rids.size(); r++) {
+                const char *rec = bufs + r * record_size;
+                int offset = 0;
+                for(size_t j = 0; j < index.col_num; ++j) {
+                    memcpy(key + offset, rec + index.cols[j].offset, index.cols[j].len);
+                    offset += index.cols[j].len;
+                }
+                ih->insert_entry(key, rids[r], context_->txn_);
             }
-            ih->insert_entry(key, rid_, context_->txn_);
         }
         return nullptr;
     }
     Rid &rid() override { return rid_; }
+
+   private:
+    /* 把一行的值按字段写入记录缓冲区 */
+    void make_record(std::vector<Value> &row, char *data) {
+        for (size_t i = 0; i < row.size(); i++) {
+            auto &col = tab_.cols[i];
+            auto &val = row[i];
+            if (col.type != val.type) {
+                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+            }
+            if (col.is_dict()) {
+                // 字典编码字段只存放编码，新值在这里加入字典
+                if ((int)val.str_val.size() > col.dict_len) {
+                    throw StringOverflowError();
+                }
+                int code = sm_manager_->get_col_dict(col)->encode(val.str_val);
+                memcpy(data + col.offset, &code, sizeof(int));
+                continue;
+            }
+            val.init_raw(col.len, &context_->arena_);
+            memcpy(data + col.offset, val.raw->data, col.len);
+        }
+    }
 };
\ No newline at end of file
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -8,6 +14,27 @@
 
 class SeqScanExecutor : public AbstractExecutor {
 private:
+    /* 一个morsel（连续的一段页面）中满足条件的记录 */
+    struct Morsel {
+        std::vector<Rid> rids;
+        std::vector<std::unique_ptr<RmRecord>> recs;
+    };
+
+    /* 并行扫描的共享状态，除workers外都由latch保护 */
+    struct ParallelScan {
+        std::mutex latch;
+        std::condition_variable cv;
+        int num_morsels;
+        size_t window;                      // 最多同时有多少个morsel已被领取但还没有交给上层，限制缓存的记录数
+        int next_morsel = 0;                // 下一个待领取的morsel
+        int next_output = 0;                // 保序输出时下一个交给上层的morsel
+        int num_consumed = 0;               // 已交给上层的morsel个数
+        std::map<int, Morsel> finished;     // 已扫描完、还没有交给上层的morsel
+        bool stop = false;
+        std::exception_ptr error;           // 工作线程抛出的第一个异常，由上层线程重新抛出
+        std::vector<std::thread> workers;
+    };
+
     std::string tab_name_;
     std::vector<Condition> conds_;
     RmFileHandle *fh_;
@@ -15,11 +42,30 @@ private:
     size_t len_;
     std::vector<Condition> fed_conds_;
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<RmScan> scan_;
     SmManager *sm_manager_;
+    std::vector<Rid> rids_;             // 当前页面中的记录号
+    std::vector<RmColumnView> columns_; // 当前页面中各个字段的值
+    std::vector<size_t> sel_;           // 当前页面中满足条件的记录在rids_中的下标
+    size_t sel_pos_;
+    bool end_;
+    std::unique_ptr<RmRecord> rec_;     // 当前满足条件的记录
+
+    size_t num_workers_;                // 并行扫描的线程数上限
+    bool keep_order_;                   // 并行扫描时是否按页面顺序输出
+    std::unique_ptr<ParallelScan> parallel_;    // 为nullptr时在当前线程中串行扫描
+    bool scanned_ = false;              // 是否已经扫描过一遍，作为连接的内表重复扫描时不再启动工作线程
+    Morsel batch_;                      // 并行扫描时正在输出的morsel
+    size_t batch_pos_;
 
 public:
-    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context) {
+    /**
+     * @param {size_t} num_workers 并行扫描的线程数上限，为0时取CPU核数；表的页数少于SEQ_SCAN_PARALLEL_MIN_PAGES时总是串行扫描
+     * @param {bool} keep_order 并行扫描时是否保持与串行扫描相同的输出顺序，不需要顺序时先扫完的morsel先输出
+     * @note 只有第一次beginTuple可能并行扫描，之后的重新扫描（如嵌套循环连接的内表）都在当前线程中串行进行
+     */
+    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context,
+                    size_t num_workers = 0, bool keep_order = true) {
         sm_manager_ = sm_manager;
         tab_name_ = std::move(tab_name);
         conds_ = std::move(conds);
@@ -29,44 +75,53 @@ public:
         len_ = cols_.back().offset + cols_.back().len;
         context_ = context;
         fed_conds_ = conds_;
+        num_workers_ = num_workers != 0 ? num_workers : std::max(std::thread::hardware_concurrency(), 1u);
+        keep_order_ = keep_order;
     }
 
+    ~SeqScanExecutor() override { stop_parallel(); }
+
     void beginTuple() override {
-        scan_ = std::make_unique<RmScan>(fh_);
-        while (!scan_->is_end()) {
-            rid_ = scan_->rid();
-            try {
-                auto rec = fh_->get_record(rid_, context_);
-                if (eval_conds(rec.get())) {
-                    return;
-                }
-            } catch (RecordNotFoundError &e) {
-                std::cerr << e.what() << std::endl;
-            }
-            scan_->next();
+        // 扫描不加行锁，给整张表加IS锁，VACUUM移动记录、截断文件（表级X锁）时不会漏掉移到扫描位置之前的记录
+        if (context_ != nullptr && context_->lock_mgr_ != nullptr) {
+            context_->lock_mgr_->lock_IS_on_table(context_->txn_, fh_->GetFd());
+        }
+        stop_parallel();
+        scan_ = nullptr;
+        sel_.clear();
+        sel_pos_ = 0;
+        batch_ = Morsel();
+        batch_pos_ = 0;
+        end_ = false;
+
+        int num_pages = fh_->get_file_hdr().num_pages;
+        int num_morsels = (num_pages - RM_FIRST_RECORD_PAGE + SEQ_SCAN_MORSEL_PAGES - 1) / SEQ_SCAN_MORSEL_PAGES;
+        size_t num_workers = std::min(num_workers_, (size_t)std::max(num_morsels, 0));
+        if (!scanned_ && num_pages >= SEQ_SCAN_PARALLEL_MIN_PAGES && num_workers > 1) {
+            start_parallel(num_morsels, num_workers);
+        } else {
+            scan_ = std::make_unique<RmScan>(fh_);
         }
+        scanned_ = true;
+        find_next();
     }
 
     void nextTuple() override {
-        while (!scan_->is_end()) {
-            scan_->next();
-            rid_ = scan_->rid();
-            try {
-                auto rec = fh_->get_record(rid_, context_);
-                if (eval_conds(rec.get())) {
-                    return;
-                }
-            } catch (RecordNotFoundError &e) {
-                std::cerr << e.what() << std::endl;
-            }
+        if (!end_) {
+            find_next();
         }
     }
 
+    bool is_end() const override { return end_; }
+
+    /* 当前这一遍扫描是否由工作线程并行进行 */
+    bool is_parallel() const { return parallel_ != nullptr; }
+
     std::unique_ptr<RmRecord> Next() override {
-        if (scan_->is_end()) {
+        if (end_) {
             return nullptr;
         }
-        auto rec = fh_->get_record(rid_, context_);
+        auto rec = std::move(rec_);
         nextTuple();
         return rec;
     }
@@ -86,46 +141,227 @@ public:
     Rid &rid() override { return rid_; }
 
 private:
-    bool eval_conds(const RmRecord *record) {
-        for (const auto &cond : fed_conds_) {
-            Value lhs_value = get_value(record, cond.lhs_col);
-            Value rhs_value = cond.is_rhs_val ? cond.rhs_val : get_value(record, cond.rhs_col);
-            if (!compare(lhs_value, rhs_value, cond.op)) {
-                return false;
+    /**
+     * @description: 找到下一条满足条件的记录，放到rec_中由Next交给上层
+     * 串行扫描一次取出一个页面，先在页面上按字段对整页记录判断条件，得到满足条件的记录下标，
+     * 释放页面读锁后再逐条加锁读出记录；并行扫描时直接从工作线程扫完的morsel中依次取出
+     */
+    void find_next() {
+        if (parallel_ != nullptr) {
+            while (batch_pos_ >= batch_.recs.size()) {
+                if (!fetch_morsel()) {
+                    rec_ = nullptr;
+                    end_ = true;
+                    return;
+                }
             }
+            rid_ = batch_.rids[batch_pos_];
+            rec_ = std::move(batch_.recs[batch_pos_++]);
+            return;
         }
-        return true;
+        while (true) {
+            while (sel_pos_ < sel_.size()) {
+                rid_ = rids_[sel_[sel_pos_++]];
+                rec_ = fetch_record(rid_);
+                if (rec_ != nullptr) {
+                    return;
+                }
+            }
+            if (!scan_->next_page_columns(&rids_, &columns_)) {
+                rec_ = nullptr;
+                end_ = true;
+                return;
+            }
+            filter_page(rids_, columns_, &sel_);
+            scan_->unlatch();
+            sel_pos_ = 0;
+        }
+    }
+
+    /**
+     * @description: 加锁读出记录并重新判断条件；释放页面读锁之后记录可能已被删除或修改
+     * @return {unique_ptr<RmRecord>} 满足条件的记录，不满足时为nullptr
+     */
+    std::unique_ptr<RmRecord> fetch_record(const Rid &rid) {
+        std::unique_ptr<RmRecord> rec;
+        try {
+            rec = fh_->get_record(rid, context_);
+        } catch (RecordNotFoundError &e) {
+            return nullptr;
+        }
+        if (!eval_conds(cols_, fed_conds_, rec->data)) {
+            return nullptr;
+        }
+        return rec;
     }
 
-    Value get_value(const RmRecord *record, const TabCol &col) {
-        // 获取列元数据
-        auto col_meta = std::find_if(cols_.begin(), cols_.end(), [&](const ColMeta &meta) { return meta.tab_name == col.tab_name && meta.name == col.col_name; });
-        // 检查是否找到列
-        if (col_meta == cols_.end()) {
-            throw std::runtime_error("Column not found");
+    /**
+     * @description: 对一个页面逐个条件过滤出满足条件的记录，每个条件只访问所涉及字段的值
+     * PAX格式下同一字段的值连续存放，一个条件扫描的是一段连续的数组
+     * @param {vector<Rid>&} rids 页面中的记录号
+     * @param {vector<RmColumnView>&} columns 页面中各个字段的值
+     * @param {vector<size_t>*} sel 满足条件的记录在rids中的下标
+     */
+    void filter_page(const std::vector<Rid> &rids, const std::vector<RmColumnView> &columns,
+                     std::vector<size_t> *sel) {
+        sel->resize(rids.size());
+        for (size_t i = 0; i < rids.size(); i++) {
+            (*sel)[i] = i;
+        }
+        for (auto &cond : fed_conds_) {
+            auto lhs_col = get_col(cols_, cond.lhs_col);
+            RmColumnView lhs = get_column(columns, lhs_col);
+            RmColumnView rhs{nullptr, 0};
+            ColType rhs_type = cond.rhs_val.type;
+            int rhs_len;
+            std::string buf;
+            if (cond.is_rhs_val) {
+                rhs.base = get_rhs_raw(*lhs_col, cond, &buf);
+                rhs_len = get_rhs_len(*lhs_col, cond);
+            } else {
+                auto rhs_col = get_col(cols_, cond.rhs_col);
+                rhs = get_column(columns, rhs_col);
+                rhs_type = rhs_col->type;
+                rhs_len = rhs_col->len;
+            }
+            size_t num_sel = 0;
+            for (size_t i : *sel) {
+                int slot_no = rids[i].slot_no;
+                int cmp = compare_cond(cond, *lhs_col, lhs.base + slot_no * lhs.stride, rhs_type,
+                                       rhs.base + slot_no * rhs.stride, rhs_len);
+                if (eval_op(cond.op, cmp)) {
+                    (*sel)[num_sel++] = i;
+                }
+            }
+            sel->resize(num_sel);
+        }
+    }
+
+    /**
+     * @description: 字段col在页面中的值；文件头中没有字段信息时按记录内的偏移从整条记录中取
+     */
+    RmColumnView get_column(const std::vector<RmColumnView> &columns, std::vector<ColMeta>::const_iterator col) const {
+        if (columns.size() == cols_.size()) {
+            return columns[col - cols_.begin()];
+        }
+        return RmColumnView{columns[0].base + col->offset, columns[0].stride};
+    }
+
+    /**
+     * @description: 把表的页面按SEQ_SCAN_MORSEL_PAGES切分成morsel，启动工作线程领取并扫描
+     * 工作线程与上层共用context_，只通过线程安全的锁管理器和缓冲池访问表，不使用context_中的arena
+     */
+    void start_parallel(int num_morsels, size_t num_workers) {
+        parallel_ = std::make_unique<ParallelScan>();
+        parallel_->num_morsels = num_morsels;
+        parallel_->window = num_workers * 2;
+        for (size_t i = 0; i < num_workers; i++) {
+            parallel_->workers.emplace_back([this] { run_worker(); });
+        }
+    }
+
+    /* 通知工作线程退出并等待其结束，丢弃还没有交给上层的结果 */
+    void stop_parallel() {
+        if (parallel_ == nullptr) {
+            return;
+        }
+        {
+            std::scoped_lock lock{parallel_->latch};
+            parallel_->stop = true;
+        }
+        parallel_->cv.notify_all();
+        for (auto &worker : parallel_->workers) {
+            worker.join();
+        }
+        parallel_ = nullptr;
+    }
+
+    void run_worker() {
+        ParallelScan &state = *parallel_;
+        while (true) {
+            int morsel_no;
+            {
+                std::unique_lock lock{state.latch};
+                state.cv.wait(lock, [&] {
+                    return state.stop || state.next_morsel >= state.num_morsels ||
+                           (size_t)(state.next_morsel - state.num_consumed) < state.window;
+                });
+                if (state.stop || state.next_morsel >= state.num_morsels) {
+                    return;
+                }
+                morsel_no = state.next_morsel++;
+            }
+            Morsel morsel;
+            try {
+                scan_morsel(morsel_no, state.num_morsels, &morsel);
+            } catch (...) {
+                std::scoped_lock lock{state.latch};
+                if (state.error == nullptr) {
+                    state.error = std::current_exception();
+                }
+                state.stop = true;
+                state.cv.notify_all();
+                return;
+            }
+            {
+                std::scoped_lock lock{state.latch};
+                state.finished.emplace(morsel_no, std::move(morsel));
+            }
+            state.cv.notify_all();
+        }
+    }
+
+    /**
+     * @description: 在工作线程中扫描一个morsel，最后一个morsel扫描到表的末尾，与串行扫描看到的页面一致
+     */
+    void scan_morsel(int morsel_no, int num_morsels, Morsel *morsel) {
+        int start = RM_FIRST_RECORD_PAGE + morsel_no * SEQ_SCAN_MORSEL_PAGES;
+        int end = morsel_no == num_morsels - 1 ? -1 : start + SEQ_SCAN_MORSEL_PAGES;
+        RmScan scan(fh_, start, end);
+        std::vector<Rid> rids;
+        std::vector<RmColumnView> columns;
+        std::vector<size_t> sel;
+        while (scan.next_page_columns(&rids, &columns)) {
+            filter_page(rids, columns, &sel);
+            scan.unlatch();
+            for (size_t i : sel) {
+                auto rec = fetch_record(rids[i]);
+                if (rec != nullptr) {
+                    morsel->rids.push_back(rids[i]);
+                    morsel->recs.push_back(std::move(rec));
+                }
+            }
         }
-        Value value;
-        memcpy(&value.val, record->data + col_meta->offset, sizeof(int));
-        return value;
     }
 
-    bool compare(const Value &lhs, const Value &rhs, CompOp op) {
-        // 使用 Value 类中的比较方法进行比较
-        switch (op) {
-        case OP_EQ:
-            return lhs.equals(rhs);
-        case OP_NE:
-            return lhs.not_equals(rhs);
-        case OP_LT:
-            return lhs.less_than(rhs);
-        case OP_LE:
-            return lhs.less_than_equal(rhs);
-        case OP_GT:
-            return lhs.greater_than(rhs);
-        case OP_GE:
-            return lhs.greater_than_equal(rhs);
-        default:
+    /**
+     * @description: 取出下一个扫完的morsel放到batch_中；保序时按morsel编号依次取出，否则取任意一个已完成的
+     * @return {bool} 所有morsel都已取出时返回false
+     */
+    bool fetch_morsel() {
+        ParallelScan &state = *parallel_;
+        std::unique_lock lock{state.latch};
+        state.cv.wait(lock, [&] {
+            return state.error != nullptr || state.num_consumed == state.num_morsels ||
+                   (keep_order_ ? state.finished.count(state.next_output) > 0 : !state.finished.empty());
+        });
+        if (state.error != nullptr) {
+            std::exception_ptr error = state.error;
+            lock.unlock();
+            stop_parallel();
+            std::rethrow_exception(error);
+        }
+        if (state.num_consumed == state.num_morsels) {
             return false;
         }
+        auto pos = keep_order_ ? state.finished.find(state.next_output) : state.finished.begin();
+        batch_ = std::move(pos->second);
+        batch_pos_ = 0;
+        state.finished.erase(pos);
+        state.next_output++;
+        state.num_consumed++;
+        lock.unlock();
+        state.cv.notify_all();
+        return true;
     }
 };
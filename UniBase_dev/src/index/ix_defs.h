@@ -2,6 +2,7 @@
 #ifndef IX_DEFS_H
 #define IX_DEFS_H
 
+#include <climits>
 #include <vector>
 
 #include "defs.h"
@@ -13,6 +14,12 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;  //初始根节点的页号
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;   //列的最大长度
+// 非唯一索引按上层的key查找时，与key组成该key最小和最大的索引key
+constexpr Rid IX_MIN_RID = {INT_MIN, INT_MIN};
+constexpr Rid IX_MAX_RID = {INT_MAX, INT_MAX};
+
+/* 索引key的形式，打开索引时根据字段类型选择一次，结点内的查找和比较按key的形式实例化 */
+enum class IxKeySchema { GENERIC, INT, FLOAT, BYTES };
 
 class IxFileHdr {
 public: 
@@ -30,22 +37,43 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    bool compressed_;                   // 结点是否使用压缩格式（前缀压缩和后缀截断），只用于按字节比较的key
+    bool encoded_;                      // key是否编码为按字节比较的格式（见ix_encode_key），用于包含数值字段的多字段索引
+    bool unique_;                       // 是否为唯一索引；非唯一索引把rid作为key的最后一个字段，使索引中的key各不相同
+    int include_len_;                   // INCLUDE字段的总长度，INCLUDE字段紧跟在key字段之后、rid字段之前，只用于index-only扫描
+    IndexType index_type_;              // INDEX_HASH时文件中是可扩展哈希表（见ix_hash.h），不使用B+树的字段
+    IxKeySchema key_schema_;            // key的形式，不写入磁盘，deserialize时根据字段类型确定
+    int cmp_len_;                       // 按字节比较时比较的长度，唯一索引不比较INCLUDE字段；不写入磁盘
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
+        compressed_ = false;
+        encoded_ = false;
+        unique_ = true;
+        include_len_ = 0;
+        index_type_ = INDEX_BTREE;
+        key_schema_ = IxKeySchema::GENERIC;
+        cmp_len_ = 0;
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
                 int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
                 col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                    compressed_ = false;
+                    encoded_ = false;
+                    unique_ = true;
+                    include_len_ = 0;
+                    index_type_ = INDEX_BTREE;
+                    key_schema_ = IxKeySchema::GENERIC;
+                    cmp_len_ = col_tot_len;
                     tot_len_ = 0;
                 } 
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 8 + sizeof(bool) * 3;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -79,6 +107,16 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &compressed_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &encoded_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &unique_, sizeof(bool));
+        offset += sizeof(bool);
+        memcpy(dest + offset, &include_len_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &index_type_, sizeof(int));
+        offset += sizeof(int);
         assert(offset == tot_len_);
     }
 
@@ -117,7 +155,47 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        compressed_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        encoded_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        unique_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
+        include_len_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        index_type_ = static_cast<IndexType>(*reinterpret_cast<const int*>(src + offset));
+        offset += sizeof(int);
         assert(offset == tot_len_);
+        init_key_schema();
+    }
+
+    /* 根据字段类型确定key的形式：单个INT或FLOAT按数值比较，全部是字符串或者编码过的key按字节比较，其他情况逐个字段比较 */
+    void init_key_schema() {
+        // 有INCLUDE字段时key总是编码过或者全部是字符串，按字节比较
+        cmp_len_ = unique_ ? col_tot_len_ - include_len_ : col_tot_len_;
+        key_schema_ = IxKeySchema::GENERIC;
+        if (encoded_ || is_all_string()) {
+            key_schema_ = IxKeySchema::BYTES;
+        } else if (col_num_ == 1 && col_types_[0] == TYPE_INT && col_lens_[0] == sizeof(int)) {
+            key_schema_ = IxKeySchema::INT;
+        } else if (col_num_ == 1 && col_types_[0] == TYPE_FLOAT && col_lens_[0] == sizeof(float)) {
+            key_schema_ = IxKeySchema::FLOAT;
+        }
+    }
+
+    /* 上层传入的key的长度，包括INCLUDE字段，非唯一索引不包括最后的rid字段 */
+    int user_key_len() const { return unique_ ? col_tot_len_ : col_tot_len_ - (int)sizeof(Rid); }
+
+    /* key中用于查找的字段的长度，不包括INCLUDE字段和rid字段 */
+    int search_key_len() const { return user_key_len() - include_len_; }
+
+    bool is_all_string() const {
+        for (int i = 0; i < col_num_; i++) {
+            if (col_types_[i] != TYPE_STRING) {
+                return false;
+            }
+        }
+        return col_num_ > 0;
     }
 };
 
@@ -131,6 +209,23 @@ public:
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
 };
 
+/* 压缩格式结点的页面布局：| IxPageHdr | IxCompactHdr | IxSlot[num_key] | 空闲空间 | 前缀和各个key的后缀 |
+ * 前缀和后缀从页尾向前分配；一个key解码为 前缀 + 后缀 + 补齐到col_tot_len的'\0' */
+class IxCompactHdr {
+public:
+    uint16_t prefix_off;            // 结点内所有key的公共前缀在页面中的偏移
+    uint16_t prefix_len;            // 公共前缀的长度
+    uint16_t heap_begin;            // [heap_begin, PAGE_SIZE)存放前缀和后缀
+    uint16_t dead_bytes;            // [heap_begin, PAGE_SIZE)中已删除的后缀占用的字节数，空间不够时整理
+};
+
+class IxSlot {
+public:
+    uint16_t key_off;               // key的后缀在页面中的偏移
+    uint16_t key_len;               // key去掉前缀和末尾的'\0'之后的长度
+    Rid rid;
+};
+
 class Iid {
 public:
     int page_no;
@@ -0,0 +1,340 @@
+#include "ix_hash.h"
+
+#include <algorithm>
+
+IxHashTable::IxHashTable(BufferPoolManager *buffer_pool_manager, int fd, IxFileHdr *file_hdr,
+                         std::mutex *file_hdr_latch)
+    : buffer_pool_manager_(buffer_pool_manager), fd_(fd), file_hdr_(file_hdr), file_hdr_latch_(file_hdr_latch) {
+    key_len_ = file_hdr_->user_key_len();
+    search_len_ = file_hdr_->search_key_len();
+    entry_len_ = key_len_ + sizeof(Rid);
+    capacity_ = std::min(BUCKET_SIZE, static_cast<int>((PAGE_SIZE - sizeof(IxHashBucketHdr)) / entry_len_));
+
+    Page *page = fetch_page(IX_HASH_DIR_PAGE);
+    auto dir = reinterpret_cast<IxHashDirHdr *>(page->get_data());
+    auto segments = reinterpret_cast<page_id_t *>(page->get_data() + sizeof(IxHashDirHdr));
+    global_depth_ = dir->global_depth;
+    segments_.assign(segments, segments + dir->num_segments);
+    unpin_page(page, false);
+}
+
+/**
+ * @description: 在刚创建的索引文件中写入初始的目录页、第一个目录段和一个空桶，全局深度为0
+ */
+void IxHashTable::init_file(DiskManager *disk_manager, int fd) {
+    char page_buf[PAGE_SIZE];
+
+    memset(page_buf, 0, PAGE_SIZE);
+    auto dir = reinterpret_cast<IxHashDirHdr *>(page_buf);
+    *dir = {.global_depth = 0, .num_segments = 1};
+    page_id_t segment = IX_HASH_INIT_SEGMENT_PAGE;
+    memcpy(page_buf + sizeof(IxHashDirHdr), &segment, sizeof(page_id_t));
+    disk_manager->write_page(fd, IX_HASH_DIR_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    page_id_t bucket = IX_HASH_INIT_BUCKET_PAGE;
+    memcpy(page_buf, &bucket, sizeof(page_id_t));
+    disk_manager->write_page(fd, IX_HASH_INIT_SEGMENT_PAGE, page_buf, PAGE_SIZE);
+
+    memset(page_buf, 0, PAGE_SIZE);
+    *reinterpret_cast<IxHashBucketHdr *>(page_buf) = {.local_depth = 0, .num_entries = 0, .next_page = IX_NO_PAGE};
+    disk_manager->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+}
+
+/**
+ * @description: 查找key对应的所有rid，非唯一索引的结果按rid排列，与B+树的get_value一致
+ * @return {bool} key是否存在
+ */
+bool IxHashTable::get_value(const char *key, std::vector<Rid> *result) {
+    std::shared_lock lock{dir_latch_};
+    Page *head = fetch_page(get_bucket(dir_slot(hash(key))));
+    head->rlatch();
+    size_t old_size = result->size();
+    for (Page *page = head; page != nullptr;) {
+        auto hdr = bucket_hdr(page);
+        for (int i = 0; i < hdr->num_entries; i++) {
+            char *entry = entry_at(page, i);
+            if (memcmp(entry, key, search_len_) == 0) {
+                result->push_back(*reinterpret_cast<Rid *>(entry + key_len_));
+            }
+        }
+        page_id_t next = hdr->next_page;
+        if (page != head) {
+            unpin_page(page, false);
+        }
+        page = next == IX_NO_PAGE ? nullptr : fetch_page(next);
+    }
+    head->runlatch();
+    unpin_page(head, false);
+    std::sort(result->begin() + old_size, result->end(), [](const Rid &a, const Rid &b) {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    });
+    return result->size() > old_size;
+}
+
+/**
+ * @description: 插入键值对；桶已满时先分裂桶，桶中的key都与要插入的key哈希值相同、分裂也分不开时链接溢出页面
+ * @return {page_id_t} 插入到的页面号，key已存在时返回IX_NO_PAGE
+ */
+page_id_t IxHashTable::insert_entry(const char *key, const Rid &rid) {
+    uint32_t h = hash(key);
+    while (true) {
+        {
+            std::shared_lock lock{dir_latch_};
+            Page *head = fetch_page(get_bucket(dir_slot(h)));
+            head->wlatch();
+            page_id_t page_no = IX_NO_PAGE;
+            InsertResult res = try_insert(head, h, key, rid, &page_no);
+            head->wunlatch();
+            unpin_page(head, res == InsertResult::INSERTED);
+            if (res != InsertResult::FULL) {
+                return page_no;
+            }
+        }
+        // 桶已满，加目录写锁分裂之后重试；其他线程可能已经分裂了这个桶
+        std::unique_lock lock{dir_latch_};
+        split(h);
+    }
+}
+
+/**
+ * @description: 删除键值对，唯一索引只按key删除，与B+树的delete_entry一致；空出的位置用页面中最后一个键值对填上，桶不合并
+ * @return {bool} 键值对是否存在并被删除
+ */
+bool IxHashTable::delete_entry(const char *key, const Rid &rid) {
+    std::shared_lock lock{dir_latch_};
+    Page *head = fetch_page(get_bucket(dir_slot(hash(key))));
+    head->wlatch();
+    bool found = false;
+    for (Page *page = head; page != nullptr && !found;) {
+        auto hdr = bucket_hdr(page);
+        for (int i = 0; i < hdr->num_entries; i++) {
+            if (match(entry_at(page, i), key, rid)) {
+                hdr->num_entries--;
+                memmove(entry_at(page, i), entry_at(page, hdr->num_entries), entry_len_);
+                found = true;
+                break;
+            }
+        }
+        page_id_t next = hdr->next_page;
+        if (page != head) {
+            unpin_page(page, found);
+        }
+        page = next == IX_NO_PAGE ? nullptr : fetch_page(next);
+    }
+    head->wunlatch();
+    unpin_page(head, found);
+    return found;
+}
+
+/* 键值对entry与(key, rid)是否相同：唯一索引只比较key，非唯一索引还要比较rid */
+bool IxHashTable::match(const char *entry, const char *key, const Rid &rid) const {
+    if (memcmp(entry, key, search_len_) != 0) {
+        return false;
+    }
+    return file_hdr_->unique_ || *reinterpret_cast<const Rid *>(entry + key_len_) == rid;
+}
+
+Page *IxHashTable::fetch_page(page_id_t page_no) { return buffer_pool_manager_->fetch_page(PageId{fd_, page_no}); }
+
+void IxHashTable::unpin_page(Page *page, bool is_dirty) {
+    buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty);
+}
+
+/**
+ * @description: 分配一个页面，优先使用分裂时释放的溢出页面；返回的页面已pin，内容由调用者初始化
+ */
+Page *IxHashTable::new_page(page_id_t *page_no) {
+    {
+        std::scoped_lock lock{*file_hdr_latch_};
+        if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+            *page_no = file_hdr_->first_free_page_no_;
+            Page *page = fetch_page(*page_no);
+            file_hdr_->first_free_page_no_ = bucket_hdr(page)->next_page;
+            return page;
+        }
+        file_hdr_->num_pages_++;
+    }
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    *page_no = page_id.page_no;
+    return page;
+}
+
+/* 把页面放回空闲链表，并unpin */
+void IxHashTable::free_page(Page *page) {
+    std::scoped_lock lock{*file_hdr_latch_};
+    bucket_hdr(page)->next_page = file_hdr_->first_free_page_no_;
+    file_hdr_->first_free_page_no_ = page->get_page_id().page_no;
+    unpin_page(page, true);
+}
+
+/* 目录的第slot项，调用者持有dir_latch_ */
+page_id_t IxHashTable::get_bucket(uint32_t slot) {
+    Page *page = fetch_page(segments_[slot / IX_HASH_DIR_SLOTS]);
+    page_id_t page_no = reinterpret_cast<page_id_t *>(page->get_data())[slot % IX_HASH_DIR_SLOTS];
+    unpin_page(page, false);
+    return page_no;
+}
+
+/* 修改目录的第slot项，调用者持有dir_latch_写锁 */
+void IxHashTable::set_bucket(uint32_t slot, page_id_t page_no) {
+    Page *page = fetch_page(segments_[slot / IX_HASH_DIR_SLOTS]);
+    reinterpret_cast<page_id_t *>(page->get_data())[slot % IX_HASH_DIR_SLOTS] = page_no;
+    unpin_page(page, true);
+}
+
+/* 把内存中的全局深度和目录段页面号写回目录页，调用者持有dir_latch_写锁 */
+void IxHashTable::write_dir() {
+    Page *page = fetch_page(IX_HASH_DIR_PAGE);
+    *reinterpret_cast<IxHashDirHdr *>(page->get_data()) = {.global_depth = global_depth_,
+                                                           .num_segments = (int)segments_.size()};
+    memcpy(page->get_data() + sizeof(IxHashDirHdr), segments_.data(), segments_.size() * sizeof(page_id_t));
+    unpin_page(page, true);
+}
+
+/**
+ * @description: 在桶的溢出链中插入键值对，调用者持有桶的第一个页面的写锁
+ * @return {InsertResult} 桶已满并且可以通过分裂腾出空间时返回FULL，由调用者分裂后重试
+ */
+IxHashTable::InsertResult IxHashTable::try_insert(Page *head, uint32_t hash, const char *key, const Rid &rid,
+                                                  page_id_t *page_no) {
+    Page *target = nullptr;     // 第一个有空位的页面
+    Page *last = nullptr;       // 溢出链的最后一个页面
+    bool same_hash = true;      // 桶中所有key的哈希值都与要插入的key相同
+    std::vector<Page *> pages;
+    for (Page *page = head;;) {
+        pages.push_back(page);
+        auto hdr = bucket_hdr(page);
+        for (int i = 0; i < hdr->num_entries; i++) {
+            char *entry = entry_at(page, i);
+            if (match(entry, key, rid)) {
+                for (size_t j = 1; j < pages.size(); j++) {
+                    unpin_page(pages[j], false);
+                }
+                return InsertResult::DUPLICATE;
+            }
+            same_hash = same_hash && this->hash(entry) == hash;
+        }
+        if (target == nullptr && hdr->num_entries < capacity_) {
+            target = page;
+        }
+        if (hdr->next_page == IX_NO_PAGE) {
+            last = page;
+            break;
+        }
+        page = fetch_page(hdr->next_page);
+    }
+
+    InsertResult res = InsertResult::INSERTED;
+    if (target == nullptr) {
+        if (!same_hash && bucket_hdr(head)->local_depth < IX_HASH_MAX_DEPTH) {
+            res = InsertResult::FULL;
+        } else {
+            page_id_t overflow;
+            target = new_page(&overflow);
+            *bucket_hdr(target) = {.local_depth = bucket_hdr(head)->local_depth, .num_entries = 0, .next_page = IX_NO_PAGE};
+            bucket_hdr(last)->next_page = overflow;
+            pages.push_back(target);
+        }
+    }
+    if (res == InsertResult::INSERTED) {
+        auto hdr = bucket_hdr(target);
+        char *entry = entry_at(target, hdr->num_entries++);
+        memcpy(entry, key, key_len_);
+        memcpy(entry + key_len_, &rid, sizeof(Rid));
+        *page_no = target->get_page_id().page_no;
+    }
+    for (size_t j = 1; j < pages.size(); j++) {
+        unpin_page(pages[j], res == InsertResult::INSERTED);
+    }
+    return res;
+}
+
+/* 在桶的溢出链末尾追加键值对，最后一个页面满时链接新的溢出页面；调用者持有dir_latch_写锁 */
+void IxHashTable::append(Page *head, const char *entry) {
+    Page *page = head;
+    while (bucket_hdr(page)->num_entries == capacity_) {
+        page_id_t next = bucket_hdr(page)->next_page;
+        Page *next_page;
+        if (next == IX_NO_PAGE) {
+            next_page = new_page(&next);
+            *bucket_hdr(next_page) = {.local_depth = bucket_hdr(head)->local_depth, .num_entries = 0, .next_page = IX_NO_PAGE};
+            bucket_hdr(page)->next_page = next;
+        } else {
+            next_page = fetch_page(next);
+        }
+        if (page != head) {
+            unpin_page(page, true);
+        }
+        page = next_page;
+    }
+    auto hdr = bucket_hdr(page);
+    memcpy(entry_at(page, hdr->num_entries++), entry, entry_len_);
+    if (page != head) {
+        unpin_page(page, true);
+    }
+}
+
+/* 目录扩大一倍，后一半的第i项与前一半的第i项指向同一个桶；调用者持有dir_latch_写锁 */
+void IxHashTable::grow_dir() {
+    uint32_t size = 1u << global_depth_;
+    while (segments_.size() * IX_HASH_DIR_SLOTS < 2 * size) {
+        page_id_t page_no;
+        Page *page = new_page(&page_no);
+        memset(page->get_data(), 0, PAGE_SIZE);
+        unpin_page(page, true);
+        segments_.push_back(page_no);
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        set_bucket(i + size, get_bucket(i));
+    }
+    global_depth_++;
+    write_dir();
+}
+
+/**
+ * @description: 分裂hash所在的桶：局部深度加1，哈希值第local_depth位为1的键值对移到新桶，目录中对应的项指向新桶；
+ * 局部深度等于全局深度时先扩大目录。原来的溢出页面放回空闲链表，键值对重新装入两个桶。调用者持有dir_latch_写锁
+ */
+void IxHashTable::split(uint32_t hash) {
+    page_id_t head_no = get_bucket(dir_slot(hash));
+    Page *head = fetch_page(head_no);
+    auto head_hdr = bucket_hdr(head);
+    int depth = head_hdr->local_depth;
+    // 其他线程已经分裂过这个桶，或者删除之后又有了空位
+    bool has_room = head_hdr->num_entries < capacity_ && head_hdr->next_page == IX_NO_PAGE;
+    if (has_room || depth >= IX_HASH_MAX_DEPTH) {
+        unpin_page(head, false);
+        return;
+    }
+    if (depth == global_depth_) {
+        grow_dir();
+    }
+
+    std::vector<char> entries(head_hdr->num_entries * entry_len_);
+    memcpy(entries.data(), entry_at(head, 0), entries.size());
+    for (page_id_t next = head_hdr->next_page; next != IX_NO_PAGE;) {
+        Page *page = fetch_page(next);
+        auto hdr = bucket_hdr(page);
+        entries.insert(entries.end(), entry_at(page, 0), entry_at(page, hdr->num_entries));
+        next = hdr->next_page;
+        free_page(page);
+    }
+    *head_hdr = {.local_depth = depth + 1, .num_entries = 0, .next_page = IX_NO_PAGE};
+    page_id_t sibling_no;
+    Page *sibling = new_page(&sibling_no);
+    *bucket_hdr(sibling) = {.local_depth = depth + 1, .num_entries = 0, .next_page = IX_NO_PAGE};
+
+    // 低depth位与hash相同、第depth位为1的目录项指向新桶
+    uint32_t low = hash & ((1u << depth) - 1);
+    for (uint32_t slot = low | (1u << depth); slot < (1u << global_depth_); slot += 1u << (depth + 1)) {
+        set_bucket(slot, sibling_no);
+    }
+    for (size_t offset = 0; offset < entries.size(); offset += entry_len_) {
+        const char *entry = entries.data() + offset;
+        append((this->hash(entry) >> depth) & 1 ? sibling : head, entry);
+    }
+    unpin_page(sibling, true);
+    unpin_page(head, true);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "ix_defs.h"
+#include "storage/disk_manager.h"
+
+/* 可扩展哈希索引的文件布局：
+ * 第IX_FILE_HDR_PAGE页是文件头；第IX_HASH_DIR_PAGE页是目录页，存放全局深度和各目录段页面的页面号；
+ * 目录段页面依次存放目录项，每一项是一个桶的第一个页面的页面号，目录的第i项在第i / IX_HASH_DIR_SLOTS个目录段中；
+ * 桶页面存放(key, rid)，桶装满而其中的key不能再按哈希值分开时（重复的key或者哈希冲突）在后面链接溢出页面 */
+constexpr int IX_HASH_DIR_PAGE = 1;
+constexpr int IX_HASH_INIT_SEGMENT_PAGE = 2;
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 3;
+constexpr int IX_HASH_INIT_NUM_PAGES = 4;
+
+/* 目录页的开头，之后是num_segments个目录段页面号 */
+struct IxHashDirHdr {
+    int global_depth;   // 目录有2^global_depth项，按key的哈希值的低global_depth位找到桶
+    int num_segments;   // 目录段页面的个数
+};
+
+constexpr int IX_HASH_DIR_SLOTS = PAGE_SIZE / sizeof(page_id_t);  // 每个目录段页面的目录项个数
+constexpr int IX_HASH_MAX_SEGMENTS = (PAGE_SIZE - sizeof(IxHashDirHdr)) / sizeof(page_id_t);
+constexpr int IX_HASH_MAX_DEPTH = 19;  // 全局深度的上限，之后桶只能链接溢出页面
+static_assert((1 << IX_HASH_MAX_DEPTH) / IX_HASH_DIR_SLOTS <= IX_HASH_MAX_SEGMENTS, "hash directory too large");
+
+/* 桶页面的开头，之后是num_entries个键值对 */
+struct IxHashBucketHdr {
+    int local_depth;        // 桶中key的哈希值的低local_depth位都相同，目录中有2^(global_depth - local_depth)项指向这个桶；溢出页面不使用
+    int num_entries;        // 这个页面中键值对的个数
+    page_id_t next_page;    // 下一个溢出页面，IX_NO_PAGE表示没有；空闲页面也用它串成链表
+};
+
+/* key的哈希值：FNV-1a之后再打散一次，使低位也分布均匀；桶的位置写在磁盘上，不能使用与实现有关的std::hash */
+inline uint32_t ix_hash_key(const char *key, int len) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/**
+ * 可扩展哈希表，建在INDEX_HASH类型的索引文件上，由IxIndexHandle创建并转发等值查找、插入和删除，页面通过BufferPoolManager读写
+ * 键值对为上层传入的key（file_hdr->user_key_len()字节，包括INCLUDE字段）加rid，只按前search_key_len()字节查找；
+ * 唯一索引中key不能重复，非唯一索引中(key, rid)不能重复
+ * 并发：目录的读写锁dir_latch_，查找、插入和删除加读锁，分裂桶和扩大目录加写锁；桶的第一个页面的页锁保护整个溢出链
+ */
+class IxHashTable {
+public:
+    IxHashTable(BufferPoolManager *buffer_pool_manager, int fd, IxFileHdr *file_hdr, std::mutex *file_hdr_latch);
+
+    static void init_file(DiskManager *disk_manager, int fd);
+
+    bool get_value(const char *key, std::vector<Rid> *result);
+
+    page_id_t insert_entry(const char *key, const Rid &rid);
+
+    bool delete_entry(const char *key, const Rid &rid);
+
+    int get_global_depth() {
+        std::shared_lock lock{dir_latch_};
+        return global_depth_;
+    }
+
+private:
+    enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    IxFileHdr *file_hdr_;
+    std::mutex *file_hdr_latch_;    // IxIndexHandle的file_hdr_latch_，分配和释放页面时修改num_pages_和空闲链表
+    int key_len_;                   // 键值对中key的长度
+    int search_len_;                // 用于查找和计算哈希值的key的前缀长度
+    int entry_len_;                 // 一个键值对的长度
+    int capacity_;                  // 每个桶页面最多的键值对个数，不超过BUCKET_SIZE
+    std::shared_mutex dir_latch_;
+    // 目录页的内容，只在持有dir_latch_写锁时修改并写回目录页；查找时只需要再读目录段页面和桶页面
+    int global_depth_;
+    std::vector<page_id_t> segments_;
+
+    uint32_t hash(const char *key) const { return ix_hash_key(key, search_len_); }
+
+    uint32_t dir_slot(uint32_t hash) const { return hash & ((1u << global_depth_) - 1); }
+
+    static IxHashBucketHdr *bucket_hdr(Page *page) { return reinterpret_cast<IxHashBucketHdr *>(page->get_data()); }
+
+    char *entry_at(Page *page, int i) const { return page->get_data() + sizeof(IxHashBucketHdr) + i * entry_len_; }
+
+    bool match(const char *entry, const char *key, const Rid &rid) const;
+
+    Page *fetch_page(page_id_t page_no);
+
+    void unpin_page(Page *page, bool is_dirty);
+
+    Page *new_page(page_id_t *page_no);
+
+    void free_page(Page *page);
+
+    page_id_t get_bucket(uint32_t slot);
+
+    void set_bucket(uint32_t slot, page_id_t page_no);
+
+    void write_dir();
+
+    InsertResult try_insert(Page *head, uint32_t hash, const char *key, const Rid &rid, page_id_t *page_no);
+
+    void append(Page *head, const char *entry);
+
+    void grow_dir();
+
+    void split(uint32_t hash);
+};
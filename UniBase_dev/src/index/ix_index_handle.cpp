@@ -1,7 +1,12 @@
 
 #include "ix_index_handle.h"
 
+#include <algorithm>
+#include <optional>
+
+#include "common/parallel.h"
 #include "ix_scan.h"
+#include "ix_search.h"
 
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
@@ -14,17 +19,25 @@ int IxNodeHandle::lower_bound(const char *target) const {
     // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
     // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
 
-    int index, numKey = this->page_hdr->num_key;
-    while (index < numKey) {
-        int mid = (index + numKey) >> 1;
-        if (ix_compare(get_key(mid), target, file_hdr->col_types_, file_hdr->col_lens_) >= 0) {
-            numKey = mid;  // mid大于等于target
-        } else {
-            index = mid + 1;  // 小于
+    int index = 0, numKey = this->page_hdr->num_key;
+    if (is_compressed() && numKey > 0) {
+        // 先与结点的公共前缀比较一次，前缀不同时所有key都比target大或者都比target小；之后只比较后缀，不解码key
+        int res = memcmp(page->get_data() + compact_hdr->prefix_off, target, compact_hdr->prefix_len);
+        if (res != 0) {
+            return res > 0 ? 0 : numKey;
+        }
+        int target_len = ix_trimmed_len(target, file_hdr->col_tot_len_);
+        while (index < numKey) {
+            int mid = (index + numKey) >> 1;
+            if (compare_suffix(mid, target, target_len) >= 0) {
+                numKey = mid;
+            } else {
+                index = mid + 1;
+            }
         }
+        return index;
     }
-
-    return index;
+    return search_fixed<false>(index, numKey, target);
 }
 
 /**
@@ -39,18 +52,58 @@ int IxNodeHandle::upper_bound(const char *target) const {
     // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
 
     int index = 1, numKey = this->page_hdr->num_key;  // 从1开始
-    while (index < numKey) {
-        int mid = (index + numKey) >> 2;  // 二分查找
-        if (ix_compare(get_key(mid), target, file_hdr->col_types_, file_hdr->col_lens_) >= 0) {
-            numKey = mid;  // mid大于等于target
+    if (is_compressed() && numKey > 1) {
+        int res = memcmp(page->get_data() + compact_hdr->prefix_off, target, compact_hdr->prefix_len);
+        if (res != 0) {
+            return res > 0 ? index : numKey;
+        }
+        int target_len = ix_trimmed_len(target, file_hdr->col_tot_len_);
+        while (index < numKey) {
+            int mid = (index + numKey) >> 1;
+            if (compare_suffix(mid, target, target_len) > 0) {
+                numKey = mid;
+            } else {
+                index = mid + 1;
+            }
+        }
+        return index;
+    }
+    return search_fixed<true>(index, std::max(index, numKey), target);
+}
+
+/**
+ * @brief 定长格式：在[lo, hi)中二分查找第一个>=target（upper为true时>target）的key_idx，按key的形式实例化
+ */
+template <typename Key, bool upper>
+int IxNodeHandle::search_as(int lo, int hi, const char *target) const {
+    const int key_len = Key::len(file_hdr);
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;  // 二分查找
+        int res = Key::compare(keys + mid * key_len, target, file_hdr);
+        if (upper ? res > 0 : res >= 0) {
+            hi = mid;  // mid大于（等于）target
         } else {
-            index = mid + 1;  // 小于
+            lo = mid + 1;
         }
     }
-    if (ix_compare(get_key(index), target, file_hdr->col_types_, file_hdr->col_lens_) == 0) {
-        index++;
+    return lo;
+}
+
+/**
+ * @brief 定长格式：按IxFileHdr::key_schema_选择查找方式，单个INT或FLOAT字段用SIMD查找
+ */
+template <bool upper>
+int IxNodeHandle::search_fixed(int lo, int hi, const char *target) const {
+    switch (file_hdr->key_schema_) {
+    case IxKeySchema::INT:
+        return ix_numeric_bound<int, upper>(keys, lo, hi, target);
+    case IxKeySchema::FLOAT:
+        return ix_numeric_bound<float, upper>(keys, lo, hi, target);
+    case IxKeySchema::BYTES:
+        return search_as<IxBytesKey, upper>(lo, hi, target);
+    default:
+        return search_as<IxGenericKey, upper>(lo, hi, target);
     }
-    return index;
 }
 
 // someQuestions:
@@ -72,7 +125,7 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {  // value 是一
     // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
     // 提示：可以调用lower_bound()和get_rid()函数。
     int keyIdx = lower_bound(key);  // 在叶子节点中获取目标key所在位置
-    if (keyIdx == get_size() || ix_compare(key, get_key(keyIdx), file_hdr->col_types_, file_hdr->col_lens_) != 0) {
+    if (keyIdx == get_size() || compare_key(keyIdx, key) != 0) {
         return false;  // 到末尾或者没有等于
     }
     *value = get_rid(keyIdx);  // 获取对应的rid
@@ -117,16 +170,26 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
     if (!(pos >= 0 && pos <= key_size)) {  // 判断pos的合法性
         return;
     }
-    // 原pos及以后数据后移n位
-    for (int i = key_size - 1; i >= pos; i--) {  // key永远比num(size)小1
-        set_key(i + n, get_key(i));              // i位置的key挪到数组i+n位置
-        set_rid(i + n, *get_rid(i));
-    }
-    // 插入
-    for (int j = 0; j < n; j++) {
-        set_key(pos + j, key + file_hdr->col_tot_len_ * j);  // key每个单位长度为file_hdr->col_len
-        set_rid(pos + j, rid[j]);                            // rid为值数组的首地址，直接数组索引
+    if (is_compressed()) {
+        // 压缩格式：单个键值对尽量原地插入；多个键值对时解码全部键值对，插入之后重新编码
+        if (n == 1) {
+            insert_compact(pos, key, *rid);
+            return;
+        }
+        std::vector<char> all_keys;
+        std::vector<Rid> all_rids;
+        read_pairs(0, key_size, &all_keys, &all_rids);
+        all_keys.insert(all_keys.begin() + pos * file_hdr->col_tot_len_, key, key + n * file_hdr->col_tot_len_);
+        all_rids.insert(all_rids.begin() + pos, rid, rid + n);
+        assign_pairs(all_keys.data(), all_rids.data(), key_size + n);
+        return;
     }
+    // 原pos及以后数据整体后移n位，再插入n个键值对；key和rid分别连续存放，各用一次memmove
+    int key_len = file_hdr->col_tot_len_;
+    memmove(keys + (pos + n) * key_len, keys + pos * key_len, (key_size - pos) * key_len);
+    memmove(rids + pos + n, rids + pos, (key_size - pos) * sizeof(Rid));
+    memcpy(keys + pos * key_len, key, n * key_len);
+    memcpy(rids + pos, rid, n * sizeof(Rid));
     set_size(key_size + n);
 }
 
@@ -144,8 +207,8 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
     // 3. 如果key不重复则插入键值对
     // 4. 返回完成插入操作之后的键值对数量
 
-    int pos = lower_bound(key);                                                           // 查找要插入的键值对应该插入到当前节点的哪个位置
-    if (ix_compare(key, get_key(pos), file_hdr->col_types_, file_hdr->col_lens_) != 0) {  // 如果key不重复则插入键值对
+    int pos = lower_bound(key);  // 查找要插入的键值对应该插入到当前节点的哪个位置
+    if (pos == get_size() || compare_key(pos, key) != 0) {  // 如果key不重复则插入键值对
         insert_pair(pos, key, value);                                                     // 相当于调用的是insert_pairs
     }
     return get_size();
@@ -162,11 +225,21 @@ void IxNodeHandle::erase_pair(int pos) {  // erase_pair 是给定位置
     // 2. 删除该位置的rid
     // 3. 更新结点的键值对数量
     int key_size = get_size();
-    for (int i = key_size; i > pos; i--) {
-        set_key(i, get_key(i));
-        set_rid(i, *get_rid(i));
+    if (is_compressed()) {
+        // 后缀占用的空间留到下次整理时回收
+        compact_hdr->dead_bytes += slots[pos].key_len;
+        memmove(slots + pos, slots + pos + 1, (key_size - pos - 1) * sizeof(IxSlot));
+        set_size(key_size - 1);
+        if (key_size == 1) {
+            init_compact();
+        }
+        return;
     }
-    set_size(get_size() - 1);
+    // pos之后的键值对前移一位
+    int key_len = file_hdr->col_tot_len_;
+    memmove(keys + pos * key_len, keys + (pos + 1) * key_len, (key_size - pos - 1) * key_len);
+    memmove(rids + pos, rids + pos + 1, (key_size - pos - 1) * sizeof(Rid));
+    set_size(key_size - 1);
 }
 
 /**
@@ -182,12 +255,224 @@ int IxNodeHandle::remove(const char *key) {  // remove 通过键值删除，调
     // 2. 如果要删除的键值对存在，删除键值对
     // 3. 返回完成删除操作后的键值对数量
     int pos = lower_bound(key);
-    if (ix_compare(key, get_key(pos), file_hdr->col_types_, file_hdr->col_lens_) == 0) {
+    if (pos < get_size() && compare_key(pos, key) == 0) {
         erase_pair(pos);
     }
     return get_size();  // （前面已经更新过size，这里直接输出就行了）
 }
 
+/**
+ * @brief 比较第key_idx个key与target
+ *
+ * @return 小于0、等于0、大于0分别表示key小于、等于、大于target
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *target) const {
+    if (!is_compressed()) {
+        return ix_compare(get_key(key_idx), target, file_hdr);
+    }
+    int res = memcmp(page->get_data() + compact_hdr->prefix_off, target, compact_hdr->prefix_len);
+    if (res != 0) {
+        return res;
+    }
+    return compare_suffix(key_idx, target, ix_trimmed_len(target, file_hdr->col_tot_len_));
+}
+
+/**
+ * @brief 压缩格式：已知target以结点的公共前缀开头，比较第key_idx个key的后缀与target前缀之后的部分
+ *
+ * @param target_len target去掉末尾的'\0'之后的长度
+ * @note key在后缀之后全是'\0'，后缀相同而target在这之后还有非'\0'的字节时target更大
+ */
+int IxNodeHandle::compare_suffix(int key_idx, const char *target, int target_len) const {
+    const IxSlot &slot = slots[key_idx];
+    int prefix_len = compact_hdr->prefix_len;
+    int res = memcmp(page->get_data() + slot.key_off, target + prefix_len, slot.key_len);
+    if (res != 0) {
+        return res;
+    }
+    return target_len > prefix_len + slot.key_len ? -1 : 0;
+}
+
+/**
+ * @brief 把第key_idx个key复制到dest，压缩格式的key在这里解码为定长的key
+ *
+ * @param dest 长度为file_hdr->col_tot_len_
+ */
+void IxNodeHandle::read_key(int key_idx, char *dest) const {
+    int key_len = file_hdr->col_tot_len_;
+    if (!is_compressed()) {
+        memcpy(dest, get_key(key_idx), key_len);
+        return;
+    }
+    const IxSlot &slot = slots[key_idx];
+    int prefix_len = compact_hdr->prefix_len;
+    memcpy(dest, page->get_data() + compact_hdr->prefix_off, prefix_len);
+    memcpy(dest + prefix_len, page->get_data() + slot.key_off, slot.key_len);
+    memset(dest + prefix_len + slot.key_len, 0, key_len - prefix_len - slot.key_len);
+}
+
+/**
+ * @brief 把[begin, end)的键值对复制出来，key依次存放，每个key的长度为file_hdr->col_tot_len_
+ */
+void IxNodeHandle::read_pairs(int begin, int end, std::vector<char> *keys, std::vector<Rid> *rids) const {
+    int key_len = file_hdr->col_tot_len_;
+    keys->resize((end - begin) * key_len);
+    rids->resize(end - begin);
+    for (int i = begin; i < end; i++) {
+        read_key(i, keys->data() + (i - begin) * key_len);
+        (*rids)[i - begin] = *get_rid(i);
+    }
+}
+
+/**
+ * @brief 结点是否少于半满，需要合并或重分配
+ * 定长格式按键值对个数判断，压缩格式按占用的字节数判断
+ */
+bool IxNodeHandle::is_underflow() const {
+    if (!is_compressed()) {
+        return page_hdr->num_key < (file_hdr->btree_order_ + 1) / 2;  // get_min_size()
+    }
+    const int hdr_len = sizeof(IxPageHdr) + sizeof(IxCompactHdr);
+    return used_bytes() - hdr_len < (PAGE_SIZE - hdr_len) / 2;
+}
+
+/* 压缩格式：初始化为空结点 */
+void IxNodeHandle::init_compact() {
+    compact_hdr->prefix_off = PAGE_SIZE;
+    compact_hdr->prefix_len = 0;
+    compact_hdr->heap_begin = PAGE_SIZE;
+    compact_hdr->dead_bytes = 0;
+}
+
+/* 压缩格式：结点已经占用的字节数，不包括已删除的后缀 */
+int IxNodeHandle::used_bytes() const {
+    return sizeof(IxPageHdr) + sizeof(IxCompactHdr) + page_hdr->num_key * sizeof(IxSlot) + PAGE_SIZE -
+           compact_hdr->heap_begin - compact_hdr->dead_bytes;
+}
+
+/**
+ * @brief 压缩格式：n个key的公共前缀长度
+ * 内部结点的第0个key不参与查找，不保存它的内容，也不参与计算公共前缀；只有一个key时整个key都是前缀
+ */
+int IxNodeHandle::compact_prefix_len(const char *key, int n) const {
+    int key_len = file_hdr->col_tot_len_;
+    int first = page_hdr->is_leaf ? 0 : 1;
+    if (n - first <= 0) {
+        return 0;
+    }
+    const char *first_key = key + first * key_len;
+    if (n - first == 1) {
+        return ix_trimmed_len(first_key, key_len);
+    }
+    int prefix_len = key_len;
+    for (int i = first + 1; i < n; i++) {
+        prefix_len = ix_common_prefix_len(first_key, key + i * key_len, prefix_len);
+    }
+    return prefix_len;
+}
+
+/**
+ * @brief 压缩格式：n个key编码到一个结点中需要的字节数
+ */
+int IxNodeHandle::compact_bytes(const char *key, int n) const {
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = compact_prefix_len(key, n);
+    int bytes = sizeof(IxPageHdr) + sizeof(IxCompactHdr) + n * sizeof(IxSlot) + prefix_len;
+    for (int i = page_hdr->is_leaf ? 0 : 1; i < n; i++) {
+        bytes += std::max(0, ix_trimmed_len(key + i * key_len, key_len) - prefix_len);
+    }
+    return bytes;
+}
+
+/**
+ * @brief 压缩格式：用n个键值对重新编码整个结点，公共前缀重新计算，已删除的后缀占用的空间被回收
+ *
+ * @param (key, rid) n个键值对，key不能指向本结点的页面
+ */
+void IxNodeHandle::assign_pairs(const char *key, const Rid *rid, int n) {
+    int key_len = file_hdr->col_tot_len_;
+    int prefix_len = compact_prefix_len(key, n);
+    int first = is_leaf_page() ? 0 : 1;
+    init_compact();
+    char *data = page->get_data();
+    if (n > first) {
+        compact_hdr->heap_begin -= prefix_len;
+        memcpy(data + compact_hdr->heap_begin, key + first * key_len, prefix_len);
+    }
+    compact_hdr->prefix_off = compact_hdr->heap_begin;
+    compact_hdr->prefix_len = prefix_len;
+    for (int i = 0; i < n; i++) {
+        const char *cur = key + i * key_len;
+        int len = i < first ? 0 : std::max(0, ix_trimmed_len(cur, key_len) - prefix_len);
+        compact_hdr->heap_begin -= len;
+        memcpy(data + compact_hdr->heap_begin, cur + prefix_len, len);
+        slots[i] = IxSlot{.key_off = compact_hdr->heap_begin, .key_len = static_cast<uint16_t>(len), .rid = rid[i]};
+    }
+    set_size(n);
+    assert(sizeof(IxPageHdr) + sizeof(IxCompactHdr) + n * sizeof(IxSlot) <= compact_hdr->heap_begin);
+}
+
+/**
+ * @brief 压缩格式：公共前缀缩短为prefix_len之后第key_idx个key的后缀长度
+ */
+int IxNodeHandle::stored_key_len(int key_idx, int prefix_len) const {
+    const char *prefix = page->get_data() + compact_hdr->prefix_off;
+    int len = slots[key_idx].key_len > 0 ? compact_hdr->prefix_len + slots[key_idx].key_len
+                                         : ix_trimmed_len(prefix, compact_hdr->prefix_len);
+    return std::max(0, len - prefix_len);
+}
+
+/**
+ * @brief 压缩格式：插入key之后结点是否放得下
+ * key与公共前缀不同时公共前缀要缩短，所有后缀都会变长
+ */
+bool IxNodeHandle::can_insert(const char *key) const {
+    int n = page_hdr->num_key;
+    int key_len = ix_trimmed_len(key, file_hdr->col_tot_len_);
+    if (n == 0) {
+        return sizeof(IxPageHdr) + sizeof(IxCompactHdr) + sizeof(IxSlot) + key_len <= PAGE_SIZE;
+    }
+    int prefix_len = compact_hdr->prefix_len;
+    int new_prefix_len =
+        ix_common_prefix_len(page->get_data() + compact_hdr->prefix_off, key, prefix_len);
+    int bytes = used_bytes() + sizeof(IxSlot) + std::max(0, key_len - new_prefix_len);
+    if (new_prefix_len < prefix_len) {
+        bytes -= prefix_len - new_prefix_len;
+        for (int i = page_hdr->is_leaf ? 0 : 1; i < n; i++) {
+            bytes += stored_key_len(i, new_prefix_len) - slots[i].key_len;
+        }
+    }
+    return bytes <= PAGE_SIZE;
+}
+
+/**
+ * @brief 压缩格式：在pos位置插入一个键值对，调用者已经用can_insert确认放得下
+ * key以公共前缀开头并且空闲空间连续时直接追加后缀，否则重新编码整个结点
+ */
+void IxNodeHandle::insert_compact(int pos, const char *key, const Rid &rid) {
+    int n = get_size();
+    int prefix_len = compact_hdr->prefix_len;
+    int len = std::max(0, ix_trimmed_len(key, file_hdr->col_tot_len_) - prefix_len);
+    // 内部结点只在空结点的位置0插入第0个key
+    assert(is_leaf_page() || pos > 0 || n == 0);
+    bool same_prefix = ix_common_prefix_len(page->get_data() + compact_hdr->prefix_off, key, prefix_len) == prefix_len;
+    int free_len = compact_hdr->heap_begin - (int)(sizeof(IxPageHdr) + sizeof(IxCompactHdr) + (n + 1) * sizeof(IxSlot));
+    if (n > (is_leaf_page() ? 0 : 1) && same_prefix && free_len >= len) {
+        compact_hdr->heap_begin -= len;
+        memcpy(page->get_data() + compact_hdr->heap_begin, key + prefix_len, len);
+        memmove(slots + pos + 1, slots + pos, (n - pos) * sizeof(IxSlot));
+        slots[pos] = IxSlot{.key_off = compact_hdr->heap_begin, .key_len = static_cast<uint16_t>(len), .rid = rid};
+        set_size(n + 1);
+        return;
+    }
+    std::vector<char> all_keys;
+    std::vector<Rid> all_rids;
+    read_pairs(0, n, &all_keys, &all_rids);
+    all_keys.insert(all_keys.begin() + pos * file_hdr->col_tot_len_, key, key + file_hdr->col_tot_len_);
+    all_rids.insert(all_rids.begin() + pos, rid);
+    assign_pairs(all_keys.data(), all_rids.data(), n + 1);
+}
+
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
@@ -198,42 +483,161 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
 
+    if (is_hash()) {
+        // 哈希表新分配的页面紧接在已有的页面之后
+        disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+        hash_table_ = std::make_unique<IxHashTable>(buffer_pool_manager_, fd, file_hdr_, &file_hdr_latch_);
+        return;
+    }
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
     int now_page_no = disk_manager_->get_fd2pageno(fd);
     disk_manager_->set_fd2pageno(fd, now_page_no + 1);
 }
 
+
+/**
+ * @brief 判断结点在执行operation之后是否"安全"，即这次操作不会修改到它的祖先结点
+ * 安全的结点的祖先结点可以提前释放写锁（latch crabbing）
+ *
+ * @param node 当前结点，调用者已持有其写锁
+ * @param operation 操作类型，只用于INSERT和DELETE
+ * @param key 要插入或删除的key
+ * @param pos 内部结点为接下来要进入的孩子的rid_idx；DELETE时叶子结点为要删除的key的位置（不存在时为-1）
+ * @note 插入：结点插入一个键值对之后不会满（不分裂）
+ * 删除：结点删除一个键值对之后不会少于半满（不合并或重分配），并且结点的第一个key不变（不需要更新父结点的key）；
+ * 根结点没有父结点，叶子根结点删除时总是安全的，内部根结点只剩一个孩子时需要换根
+ * 压缩格式按字节数判断：内部结点不知道孩子分裂后插入的分隔key，按最长的key估计；分隔key插在第一个或最后一个孩子之后时
+ * 可能与结点的公共前缀不同，还要留出所有后缀变长的空间。压缩格式删除时不更新父结点的key，不要求第一个key不变
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, Operation operation, const char *key, int pos) {
+    if (operation == Operation::INSERT) {
+        if (!node->is_compressed()) {
+            return node->get_size() + 1 < node->get_max_size();
+        }
+        if (node->is_leaf_page()) {
+            return node->can_insert(key);
+        }
+        int size = node->get_size();
+        int prefix_len = node->compact_hdr->prefix_len;
+        int need = sizeof(IxSlot) + file_hdr_->col_tot_len_ - prefix_len;
+        if (pos == 0 || pos + 1 == size) {
+            need += size * prefix_len;
+        }
+        return node->used_bytes() + need <= PAGE_SIZE;
+    }
+    if (node->is_root_page()) {
+        return node->is_leaf_page() || node->get_size() > 2;
+    }
+    if (node->is_compressed()) {
+        const int hdr_len = sizeof(IxPageHdr) + sizeof(IxCompactHdr);
+        int left = node->used_bytes() - hdr_len - (int)sizeof(IxSlot) - file_hdr_->col_tot_len_;
+        return left >= (PAGE_SIZE - hdr_len) / 2;
+    }
+    return node->get_size() > node->get_min_size() && pos != 0;
+}
+
+/**
+ * @brief 释放事务在本次索引操作中持有的所有页面写锁，以及根结点锁
+ *
+ * @param transaction 事务，其index_latch_page_set_中记录了按从上到下顺序加写锁的页面
+ * @param root_is_latched 传入传出参数：是否持有root_latch_
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, bool *root_is_latched) {
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+    auto latch_pages = transaction->get_index_latch_page_set();
+    for (Page *page : *latch_pages) {
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page->get_page_id(), true);
+    }
+    latch_pages->clear();
+}
+
+/**
+ * @brief 释放写锁之后，从缓冲池中删除本次操作合并掉的页面
+ */
+void IxIndexHandle::delete_pages(Transaction *transaction) {
+    auto deleted_pages = transaction->get_index_deleted_page_set();
+    for (Page *page : *deleted_pages) {
+        buffer_pool_manager_->delete_page(page->get_page_id());
+    }
+    deleted_pages->clear();
+}
+
 /**
  * @brief 用于查找指定键所在的叶子结点
+ * 查找时自上而下加读锁，拿到孩子的读锁后立即释放父结点的读锁；
+ * 插入和删除时自上而下加写锁，并把加锁的页面依次放入事务的index_latch_page_set_，
+ * 遇到安全的结点时释放它所有祖先结点的写锁（以及root_latch_）
+ *
  * @param key 要查找的目标key值
  * @param operation 查找到目标键值对后要进行的操作类型
- * @param transaction 事务参数，如果不需要则默认传入nullptr
+ * @param transaction 事务参数，INSERT和DELETE时不能为nullptr
+ * @param find_first 为true时总是进入最左边的孩子，找到第一个叶子结点
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
- * @note need to Unlatch and unpin the leaf node outside!
- * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * @note FIND：返回的叶子结点持有读锁并被pin住，需要在外面runlatch并unpin；
+ * INSERT/DELETE：叶子结点已放入index_latch_page_set_，由release_latches统一释放
  */
-std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
-                                                              Transaction *transaction, bool find_first) {
+std::pair<IxNodeHandle, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
+                                                            Transaction *transaction, bool find_first) {
     // 1. 获取根节点
     // 2. 从根节点开始不断向下查找目标key
     // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    bool root_is_latched = false;
+    IxNodeHandle node;
+    if (operation == Operation::FIND) {
+        // 根结点的页面号只在持有root_latch_写锁时修改，拿到根结点的读锁之后就不会再被换掉
+        std::shared_lock lock{root_latch_};
+        node = fetch_node(file_hdr_->root_page_);
+        node.page->rlatch();
+    } else {
+        root_latch_.lock();
+        root_is_latched = true;
+        node = fetch_node(file_hdr_->root_page_);
+        node.page->wlatch();
+    }
+
+    while (true) {
+        int pos = 0;
+        page_id_t child_page_no = IX_NO_PAGE;
+        if (node.is_leaf_page()) {
+            if (operation == Operation::DELETE) {
+                Rid *rid;
+                pos = node.leaf_lookup(key, &rid) ? node.lower_bound(key) : -1;
+            }
+        } else {
+            pos = find_first ? 0 : node.upper_bound(key) - 1;
+            child_page_no = node.value_at(pos);
+        }
+        if (operation != Operation::FIND) {
+            if (is_safe(&node, operation, key, pos)) {
+                release_latches(transaction, &root_is_latched);
+            }
+            transaction->append_index_latch_page_set(node.page);
+        }
+        if (node.is_leaf_page()) {
+            return std::make_pair(node, root_is_latched);
+        }
 
-    IxNodeHandle *node = this->fetch_node(this->file_hdr_->root_page_);  // 获取根节点
-    while (!node->is_leaf_page()) {                                      // 从根节点开始不断向下查找
-        page_id_t page_no = node->internal_lookup(key);                  // 向下找key所在子树
-        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
-        node = this->fetch_node(page_no);  // 迭代查找，每次定位到下一层子树
+        IxNodeHandle child = fetch_node(child_page_no);
+        if (operation == Operation::FIND) {
+            child.page->rlatch();
+            node.page->runlatch();
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        } else {
+            child.page->wlatch();
+        }
+        node = child;
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // 取消固定，且不是脏页（操作中并没有修改）
-    return std::make_pair(node, true);
-    return std::make_pair(nullptr, false);
 }
 
 /**
  * @brief 用于查找指定键在叶子结点中的对应的值result
  *
  * @param key 查找的目标key值
- * @param result 用于存放结果的容器
+ * @param result 用于存放结果的容器，非唯一索引按rid的顺序放入所有匹配的rid
  * @param transaction 事务指针
  * @return bool 返回目标键值对是否存在
  */
@@ -243,25 +647,147 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
     // 3. 把rid存入result参数中
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-    std::scoped_lock lock{root_latch_};
-    auto leaf = find_leaf_page(key, Operation::FIND, transaction);
-    Rid* rid;
-    bool return_val = leaf.first->leaf_lookup(key, &rid);
-    if(return_val) {
+    if (is_hash()) {
+        return hash_table_->get_value(key, result);
+    }
+    if (!file_hdr_->unique_) {
+        // 相同key的键值对按(INCLUDE字段, rid)排列，可能跨越多个叶子结点，与范围查询一样用IxScan读取
+        // INCLUDE字段和rid不参与查找，在编码后的key中把这部分填为最小值和最大值作为扫描的上下界
+        char lower[IX_MAX_COL_LEN];
+        char upper[IX_MAX_COL_LEN];
+        int key_len = file_hdr_->search_key_len();
+        encode_key(key, IX_MIN_RID, lower);
+        encode_key(key, IX_MAX_RID, upper);
+        memset(lower + key_len, 0, file_hdr_->col_tot_len_ - key_len);
+        memset(upper + key_len, 0xff, file_hdr_->col_tot_len_ - key_len);
+        size_t old_size = result->size();
+        for (IxScan scan(this, find_lower_bound(lower), find_upper_bound(upper), buffer_pool_manager_); !scan.is_end();
+             scan.next()) {
+            result->push_back(scan.rid());
+        }
+        return result->size() > old_size;
+    }
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, Rid{}, key_buf);
+    IxNodeHandle leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool return_val = leaf.leaf_lookup(key, &rid);
+    if (return_val) {
         result->push_back(*rid);
     }
-    buffer_pool_manager_->unpin_page(leaf.first->get_page_id(), false);
+    leaf.page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
     return return_val;
 }
 
+/**
+ * @brief 批量查找多个key：把key排序后依次查找，下一个key仍在当前叶子结点或者右边相邻的叶子结点中时直接在叶子上查找，
+ * 不再从根结点走一遍，按顺序经过的叶子结点只读取一次；用于一次要查找很多key的场合
+ *
+ * @param keys 要查找的key，格式与get_value相同，可以无序、重复
+ * @param results 传出参数，大小与keys相同，(*results)[i]是keys[i]对应的rid，与get_value(keys[i])的结果相同
+ * @param transaction 事务指针
+ */
+void IxIndexHandle::get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *results,
+                               Transaction *transaction) {
+    results->assign(keys.size(), {});
+    if (keys.empty()) {
+        return;
+    }
+    if (is_hash()) {
+        // 哈希表的每次查找都只读一个桶，不需要排序
+        for (size_t i = 0; i < keys.size(); i++) {
+            hash_table_->get_value(keys[i], &(*results)[i]);
+        }
+        return;
+    }
+    // 每个key转换为索引中保存的格式的范围[lower, upper]：唯一索引只有一个键值对，上下界相同；
+    // 非唯一索引与get_value一样把INCLUDE字段和rid填为最小值和最大值
+    int key_len = file_hdr_->col_tot_len_;
+    int search_len = file_hdr_->search_key_len();
+    std::vector<char> lowers(keys.size() * key_len);
+    std::vector<char> uppers(file_hdr_->unique_ ? 0 : keys.size() * key_len);
+    for (size_t i = 0; i < keys.size(); i++) {
+        char *lower = lowers.data() + i * key_len;
+        if (file_hdr_->unique_) {
+            const char *key = encode_key(keys[i], Rid{}, lower);
+            if (key != lower) {
+                memcpy(lower, key, key_len);
+            }
+            continue;
+        }
+        char *upper = uppers.data() + i * key_len;
+        encode_key(keys[i], IX_MIN_RID, lower);
+        encode_key(keys[i], IX_MAX_RID, upper);
+        memset(lower + search_len, 0, key_len - search_len);
+        memset(upper + search_len, 0xff, key_len - search_len);
+    }
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return ix_compare(lowers.data() + a * key_len, lowers.data() + b * key_len, file_hdr_) < 0;
+    });
+
+    // key在叶子结点中：不大于结点的最后一个key，或者结点是最后一个叶子。前一个key在这个结点之前或之中，所以不用再看结点的第一个key
+    auto in_leaf = [&](IxNodeHandle *leaf, const char *key) {
+        {
+            std::scoped_lock lock{file_hdr_latch_};
+            if (leaf->get_page_no() == file_hdr_->last_leaf_) {
+                return true;
+            }
+        }
+        return leaf->get_size() > 0 && leaf->compare_key(leaf->get_size() - 1, key) >= 0;
+    };
+    IxNodeHandle leaf;
+    bool has_leaf = false;
+    const char *prev = nullptr;
+    size_t prev_i = 0;
+    for (size_t i : order) {
+        const char *lower = lowers.data() + i * key_len;
+        const char *upper = file_hdr_->unique_ ? lower : uppers.data() + i * key_len;
+        // 重复的key直接复制结果，非唯一索引查找上一个key时叶子结点已经移过了这个key的开头
+        if (prev != nullptr && ix_compare(prev, lower, file_hdr_) == 0) {
+            (*results)[i] = (*results)[prev_i];
+            continue;
+        }
+        prev = lower;
+        prev_i = i;
+        if (has_leaf && !in_leaf(&leaf, lower) && !(move_to_next_leaf(&leaf) && in_leaf(&leaf, lower))) {
+            leaf.page->runlatch();
+            buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+            has_leaf = false;
+        }
+        if (!has_leaf) {
+            leaf = find_leaf_page(lower, Operation::FIND, transaction).first;
+            has_leaf = true;
+        }
+        int pos = leaf.lower_bound(lower);
+        while (true) {
+            for (; pos < leaf.get_size() && leaf.compare_key(pos, upper) <= 0; pos++) {
+                (*results)[i].push_back(*leaf.get_rid(pos));
+            }
+            // 非唯一索引中一个key的键值对可能延续到下一个叶子结点
+            if (file_hdr_->unique_ || pos < leaf.get_size() || !move_to_next_leaf(&leaf)) {
+                break;
+            }
+            pos = 0;
+        }
+    }
+    leaf.page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+}
+
 /**
  * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
  * @param node 需要拆分的结点
  * @return 拆分得到的new_node
  * @note need to unpin the new node outside
  * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * new node在插入父结点之前只能通过持有写锁的node访问到，不需要加锁
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
+IxNodeHandle IxIndexHandle::split(IxNodeHandle *node) {
     // Todo:
     // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
     //    需要初始化新节点的page_hdr内容
@@ -269,36 +795,124 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
     //    为新节点分配键值对，更新旧节点的键值对数记录
     // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
 
-    IxNodeHandle *new_node = this->create_node();
-    new_node->page_hdr->next_free_page_no = IX_NO_PAGE;  // 何时更改？
-    new_node->page_hdr->num_key = 0;
-    new_node->page_hdr->parent = IX_NO_PAGE;  // InsertIntoParent中修改
-    if (node->is_leaf_page()) {
-        new_node->page_hdr->is_leaf = true;
-        IxNodeHandle *next_node = fetch_node(node->get_next_leaf());
-        // 更新prev_leaf和next_leaf指针
-        new_node->set_next_leaf(node->get_next_leaf());
-        next_node->set_prev_leaf(new_node->get_page_no());
-
-        new_node->set_prev_leaf(node->get_page_no());
-        node->set_next_leaf(new_node->get_page_no());
-
-        buffer_pool_manager_->unpin_page(next_node->get_page_id(), true);
-    }
+    IxNodeHandle new_node = create_sibling(node);
     // 平分
     int mid = (node->get_max_size()) / 2;
     int pos = (node->get_max_size() + 1) / 2;  // 奇数情况下，左边多一个
-    new_node->insert_pairs(0, node->get_key(pos), node->get_rid(pos), mid);
+    new_node.insert_pairs(0, node->get_key(pos), node->get_rid(pos), mid);
     node->set_size(pos);
     // 更新孩子结点的父节点信息
     if (!node->is_leaf_page()) {
-        for (int i = 0; i < new_node->get_size(); i++) {
-            maintain_child(new_node, i);
+        for (int i = 0; i < new_node.get_size(); i++) {
+            maintain_child(&new_node, i);
+        }
+    }
+    return new_node;
+}
+
+/**
+ * @brief 在node的右边创建一个空的兄弟结点，叶子结点同时接入叶子链表
+ *
+ * @return 新结点，parent在insert_into_parent中设置
+ * @note new node在插入父结点之前只能通过持有写锁的node访问到，不需要加锁；需要在函数外面unpin
+ */
+IxNodeHandle IxIndexHandle::create_sibling(IxNodeHandle *node) {
+    IxNodeHandle new_node = this->create_node();
+    new_node.page_hdr->next_free_page_no = IX_NO_PAGE;  // 何时更改？
+    new_node.page_hdr->num_key = 0;
+    new_node.page_hdr->parent = IX_NO_PAGE;  // InsertIntoParent中修改
+    new_node.page_hdr->is_leaf = node->is_leaf_page();
+    if (node->is_leaf_page()) {
+        // 右边的叶子可能属于另一个父结点，加锁顺序总是从左到右，不会死锁
+        IxNodeHandle next_node = fetch_node(node->get_next_leaf());
+        next_node.page->wlatch();
+        // 更新prev_leaf和next_leaf指针
+        new_node.set_next_leaf(node->get_next_leaf());
+        next_node.set_prev_leaf(new_node.get_page_no());
+
+        new_node.set_prev_leaf(node->get_page_no());
+        node->set_next_leaf(new_node.get_page_no());
+
+        next_node.page->wunlatch();
+        buffer_pool_manager_->unpin_page(next_node.get_page_id(), true);
+
+        std::scoped_lock lock{file_hdr_latch_};
+        if (file_hdr_->last_leaf_ == node->get_page_no()) {
+            file_hdr_->last_leaf_ = new_node.get_page_no();
         }
     }
     return new_node;
 }
 
+/**
+ * @brief 压缩格式：在node的pos位置插入键值对，放不下时把原有的和新的键值对一起分到node和新的右兄弟结点中，
+ * 再把分隔key插入父结点
+ * 新的key与结点的公共前缀不同时它一定在结点的一端（夹在两个key之间的key一定有它们的公共前缀），
+ * 这时把它单独分到一边，另一边保持原来的编码；否则按字节数平分，两半的公共前缀都不会变短
+ *
+ * @param pos 插入位置，内部结点的pos大于0
+ * @return 键值对最终所在结点的页面号
+ * @note 叶子结点的分隔key是两半之间最短的key（后缀截断），内部结点的分隔key是右半部分的第一个key
+ */
+page_id_t IxIndexHandle::insert_into_compact(IxNodeHandle *node, int pos, const char *key, const Rid &rid,
+                                             Transaction *transaction) {
+    if (node->can_insert(key)) {
+        node->insert_pair(pos, key, rid);
+        return node->get_page_no();
+    }
+    int key_len = file_hdr_->col_tot_len_;
+    int size = node->get_size();
+    int first = node->is_leaf_page() ? 0 : 1;
+    int prefix_len = node->compact_hdr->prefix_len;
+    bool same_prefix =
+        ix_common_prefix_len(node->page->get_data() + node->compact_hdr->prefix_off, key, prefix_len) == prefix_len;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    node->read_pairs(0, size, &keys, &rids);
+    keys.insert(keys.begin() + pos * key_len, key, key + key_len);
+    rids.insert(rids.begin() + pos, rid);
+    size++;
+
+    // 左半部分为[0, mid)，右半部分为[mid, size)
+    int mid;
+    if (!same_prefix && pos == size - 1) {
+        mid = size - 1;
+    } else if (!same_prefix && pos == first) {
+        mid = first + 1;
+    } else {
+        std::vector<int> weight(size);
+        int total = 0;
+        for (int i = 0; i < size; i++) {
+            weight[i] = sizeof(IxSlot) + ix_trimmed_len(keys.data() + i * key_len, key_len);
+            total += weight[i];
+        }
+        int acc = 0;
+        for (mid = 0; mid < size - 1 && acc + weight[mid] / 2 < total / 2; mid++) {
+            acc += weight[mid];
+        }
+        mid = std::clamp(mid, 1, size - 1);
+    }
+    assert(node->compact_bytes(keys.data(), mid) <= PAGE_SIZE);
+
+    IxNodeHandle new_node = create_sibling(node);
+    assert(new_node.compact_bytes(keys.data() + mid * key_len, size - mid) <= PAGE_SIZE);
+    node->assign_pairs(keys.data(), rids.data(), mid);
+    new_node.assign_pairs(keys.data() + mid * key_len, rids.data() + mid, size - mid);
+    if (!new_node.is_leaf_page()) {
+        for (int i = 0; i < new_node.get_size(); i++) {
+            maintain_child(&new_node, i);
+        }
+    }
+    std::vector<char> sep(keys.begin() + mid * key_len, keys.begin() + (mid + 1) * key_len);
+    if (node->is_leaf_page()) {
+        ix_shortest_separator(keys.data() + (mid - 1) * key_len, keys.data() + mid * key_len, key_len, sep.data());
+    }
+    page_id_t page_no = pos < mid ? node->get_page_no() : new_node.get_page_no();
+    insert_into_parent(node, sep.data(), &new_node, transaction);
+    buffer_pool_manager_->unpin_page(new_node.get_page_id(), true);
+    return page_no;
+}
+
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
@@ -311,6 +925,7 @@ IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
  * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
+ * old_node分裂说明它不安全，它的父结点（以及换根时的root_latch_）一定还被当前事务持有写锁
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                        Transaction *transaction) {
@@ -320,42 +935,50 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
     // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
     // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
     // 提示：记得unpin page
-    IxNodeHandle *father;
+    IxNodeHandle father;
     if (old_node->is_root_page()) {
         // 新的父节点
-        IxNodeHandle *new_root = this->create_node();
-        new_root->page_hdr->is_leaf = false;
-        new_root->page_hdr->next_free_page_no = IX_NO_PAGE;
-        new_root->page_hdr->next_leaf = IX_NO_PAGE;
-        new_root->page_hdr->prev_leaf = IX_NO_PAGE;
-        new_root->page_hdr->num_key = 0;
-        new_root->page_hdr->parent = IX_NO_PAGE;
-
-        file_hdr_->root_page_ = new_root->get_page_no();
-        new_root->insert(old_node->get_key(0), Rid{old_node->get_page_no(), -1});
-        old_node->set_parent_page_no(new_root->get_page_no());
+        IxNodeHandle new_root = this->create_node();
+        new_root.page_hdr->is_leaf = false;
+        new_root.page_hdr->next_free_page_no = IX_NO_PAGE;
+        new_root.page_hdr->next_leaf = IX_NO_PAGE;
+        new_root.page_hdr->prev_leaf = IX_NO_PAGE;
+        new_root.page_hdr->num_key = 0;
+        new_root.page_hdr->parent = IX_NO_PAGE;
+
+        update_root_page_no(new_root.get_page_no());
+        std::vector<char> first_key(file_hdr_->col_tot_len_);
+        old_node->read_key(0, first_key.data());
+        new_root.insert_pair(0, first_key.data(), Rid{old_node->get_page_no(), -1});
+        old_node->set_parent_page_no(new_root.get_page_no());
         father = new_root;
     } else {
         father = fetch_node(old_node->get_parent_page_no());
     }
     // 以上处理之后，old_root只有一种情况，即存在father
-    father->insert(key, Rid{new_node->get_page_no(), -1});
-
-    new_node->set_parent_page_no(father->get_page_no());
+    // new_node紧跟在old_node之后；最左边的结点在父结点中的key不参与查找，可能比它的实际内容大，不能按key查找插入位置
+    int pos = father.find_child(old_node) + 1;
+    new_node->set_parent_page_no(father.get_page_no());
+    if (father.is_compressed()) {
+        insert_into_compact(&father, pos, key, Rid{new_node->get_page_no(), -1}, transaction);
+        buffer_pool_manager_->unpin_page(father.get_page_id(), true);
+        return;
+    }
+    father.insert_pair(pos, key, Rid{new_node->get_page_no(), -1});
     // 是否继续分裂
-    if (father->get_size() == father->get_max_size()) {
-        IxNodeHandle *new_new_node = this->split(father);
-        this->insert_into_parent(father, new_new_node->get_key(0), new_new_node, transaction);
-        buffer_pool_manager_->unpin_page(new_new_node->get_page_id(), true);
+    if (father.get_size() == father.get_max_size()) {
+        IxNodeHandle new_new_node = this->split(&father);
+        this->insert_into_parent(&father, new_new_node.get_key(0), &new_new_node, transaction);
+        buffer_pool_manager_->unpin_page(new_new_node.get_page_id(), true);
     }
-    buffer_pool_manager_->unpin_page(father->get_page_id(), true);
+    buffer_pool_manager_->unpin_page(father.get_page_id(), true);
 }
 
 /**
  * @brief 将指定键值对插入到B+树中
  * @param (key, value) 要插入的键值对
- * @param transaction 事务指针
- * @return page_id_t 插入到的叶结点的page_no
+ * @param transaction 事务指针，为nullptr时使用一个临时事务记录加锁的页面
+ * @return page_id_t 插入到的叶结点的page_no，key已存在时返回IX_NO_PAGE
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
     // Todo:
@@ -363,47 +986,75 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     // 2. 在该叶子节点中插入键值对
     // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
     // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
-    std::scoped_lock lock{root_latch_};
-    IxNodeHandle* leaf = find_leaf_page(key, Operation::INSERT, transaction).first;
-    int size = leaf->get_size();
-    bool success = (leaf->insert(key, value) != size);
-    if(leaf->get_size() == leaf->get_max_size()) {
-        auto neo_node = split(leaf);
-        this->insert_into_parent(leaf, neo_node->get_key(0), neo_node, transaction);
-        buffer_pool_manager_->unpin_page(neo_node->get_page_id(), true);
+    if (is_hash()) {
+        return hash_table_->insert_entry(key, value);
     }
-    buffer_pool_manager_->unpin_page(leaf->get_page_id(), success);
-    return success;
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, value, key_buf);
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+    int size = leaf.get_size();
+    page_id_t page_no = IX_NO_PAGE;
+    if (leaf.is_compressed()) {
+        int pos = leaf.lower_bound(key);
+        if (pos == size || leaf.compare_key(pos, key) != 0) {
+            page_no = insert_into_compact(&leaf, pos, key, value, transaction);
+        }
+    } else if (leaf.insert(key, value) != size) {
+        page_no = leaf.get_page_no();
+        if (leaf.get_size() == leaf.get_max_size()) {
+            IxNodeHandle new_node = split(&leaf);
+            if (ix_compare(key, new_node.get_key(0), file_hdr_) >= 0) {
+                page_no = new_node.get_page_no();
+            }
+            insert_into_parent(&leaf, new_node.get_key(0), &new_node, transaction);
+            buffer_pool_manager_->unpin_page(new_node.get_page_id(), true);
+        }
+    }
+    release_latches(transaction, &root_is_latched);
+    return page_no;
 }
 
 /**
  * @brief 用于删除B+树中含有指定key的键值对
  * @param key 要删除的key值
- * @param transaction 事务指针
+ * @param value 要删除的键值对的rid，非唯一索引只删除(key, value)这一个键值对，唯一索引不使用
+ * @param transaction 事务指针，为nullptr时使用一个临时事务记录加锁和删除的页面
+ * @return key是否存在并被删除
  */
-bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+bool IxIndexHandle::delete_entry(const char *key, const Rid &value, Transaction *transaction) {
     // Todo:
     // 1. 获取该键值对所在的叶子结点
     // 2. 在该叶子结点中删除键值对
     // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
-    std::scoped_lock lock{root_latch_};
-
-    IxNodeHandle *node = find_leaf_page(key, Operation::FIND, transaction).first;  // 同样这里也没有管锁的问题
-    int old_size = node->get_size();
-    int new_size = node->remove(key);  // 删除，返回数量
-
-    maintain_parent(node);  // 更新父节点的第一个key
-
-    if (old_size != new_size) {
-        coalesce_or_redistribute(node, transaction);  // 用于处理合并和重分配的逻辑，小于半满
-        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
-        return true;
-    } else {
-        buffer_pool_manager_->unpin_page(node->get_page_id(), true);
-        return false;
+    if (is_hash()) {
+        return hash_table_->delete_entry(key, value);
     }
-    return false;
+    char key_buf[IX_MAX_COL_LEN];
+    key = encode_key(key, value, key_buf);
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    int pos = leaf.lower_bound(key);
+    int old_size = leaf.get_size();
+    bool removed = leaf.remove(key) != old_size;
+    if (removed) {
+        if (pos == 0 && leaf.get_size() > 0 && !leaf.is_compressed()) {
+            maintain_parent(&leaf);  // 更新父节点的第一个key；压缩格式的分隔key只需要不大于孩子的第一个key
+        }
+        coalesce_or_redistribute(&leaf, transaction, &root_is_latched);  // 用于处理合并和重分配的逻辑，小于半满
+    }
+    release_latches(transaction, &root_is_latched);
+    delete_pages(transaction);
+    return removed;
 }
 
 /**
@@ -416,6 +1067,7 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * @note User needs to first find the sibling of input page.
  * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
  * Otherwise, merge(Coalesce).
+ * 需要合并或重分配说明node不安全，node的父结点一定还被当前事务持有写锁，兄弟结点在这里临时加写锁
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
     // Todo:
@@ -428,33 +1080,50 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
     // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
     // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
     if (node->is_root_page()) {
-        return adjust_root(node);
+        bool root_deleted = adjust_root(node);
+        if (root_deleted) {
+            transaction->append_index_deleted_page(node->page);
+        }
+        return root_deleted;
     }
-    if (node->get_size() >= node->get_min_size()) {  // 是否小于允许的最小数量
+    if (!node->is_underflow()) {  // 是否小于允许的最小数量
         return false;
     }
     // 需要合并or重分配处理
-    IxNodeHandle *father = fetch_node(node->get_parent_page_no());
-    IxNodeHandle *brother;
-    int index = father->find_child(node);
-    if (index == 0) {                                               // 无前驱
-        brother = fetch_node(father->get_rid(index + 1)->page_no);  // father->rid_index(相邻兄弟节点+-1)->rid-》page_no
-    } else {
-        brother = fetch_node(father->get_rid(index - 1)->page_no);
-    }
+    IxNodeHandle father = fetch_node(node->get_parent_page_no());
+    int index = father.find_child(node);
+    IxNodeHandle brother = fetch_node(father.value_at(index == 0 ? index + 1 : index - 1));
+    brother.page->wlatch();
 
-    if (node->get_size() + brother->get_size() >= node->get_min_size() * 2) {  // 重分配or合并
-        redistribute(brother, node, father, index);                            // find_child获取node的rid_idx
-        buffer_pool_manager_->unpin_page(father->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(brother->get_page_id(), true);
-        return false;
+    bool node_deleted;
+    if (node->is_compressed()) {
+        // 压缩格式的key长度不同，重分配改变的分隔key可能在父结点中放不下，所以只在两个结点能放进一个结点时合并
+        IxNodeHandle *left = index == 0 ? node : &brother;
+        IxNodeHandle *right = index == 0 ? &brother : node;
+        std::vector<char> keys, right_keys;
+        std::vector<Rid> rids, right_rids;
+        left->read_pairs(0, left->get_size(), &keys, &rids);
+        right->read_pairs(0, right->get_size(), &right_keys, &right_rids);
+        if (!right->is_leaf_page() && right->get_size() > 0) {
+            father.read_key(father.find_child(right), right_keys.data());
+        }
+        keys.insert(keys.end(), right_keys.begin(), right_keys.end());
+        node_deleted = false;
+        if (left->compact_bytes(keys.data(), left->get_size() + right->get_size()) <= PAGE_SIZE) {
+            coalesce(&brother, node, &father, index, transaction, root_is_latched);
+            node_deleted = index != 0;
+        }
+    } else if (node->get_size() + brother.get_size() >= node->get_min_size() * 2) {  // 重分配or合并
+        redistribute(&brother, node, &father, index);                          // find_child获取node的rid_idx
+        node_deleted = false;
     } else {
-        coalesce(&brother, &node, &father, index, transaction, root_is_latched);  // 合并
-        buffer_pool_manager_->unpin_page(father->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(brother->get_page_id(), true);
-        return true;
+        coalesce(&brother, node, &father, index, transaction, root_is_latched);  // 合并
+        node_deleted = index != 0;  // index=0时被合并掉的是右边的兄弟结点
     }
-    return false;
+    brother.page->wunlatch();
+    buffer_pool_manager_->unpin_page(brother.get_page_id(), true);
+    buffer_pool_manager_->unpin_page(father.get_page_id(), true);
+    return node_deleted;
 }
 
 /**
@@ -462,27 +1131,25 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @param old_root_node 原根节点
  * @return bool 根结点是否需要被删除
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
+ * 叶子根结点删空后保留为空的根结点，之后的插入不需要特殊处理
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
     // Todo:
     // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
     // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
     // 3. 除了上述两种情况，不需要进行操作
-    if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {  // 根节点无孩子且是最后一个键值对被删除
-        file_hdr_->root_page_ = INVALID_PAGE_ID;
-        return false;
-    } else if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {  // 根节点还有一个孩子，根节点无用，孩子变为根节点
-        file_hdr_->root_page_ = old_root_node->remove_and_return_only_child();
+    if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {  // 根节点还有一个孩子，根节点无用，孩子变为根节点
+        // 唯一的孩子是刚合并过的结点，此时仍被当前事务持有写锁
+        update_root_page_no(old_root_node->remove_and_return_only_child());
 
-        IxNodeHandle *new_root = this->fetch_node(file_hdr_->root_page_);
-        new_root->page_hdr->parent = IX_NO_PAGE;  // root没有father（test时递归遍历树的时候，如果rootfather不修改为IX_NO_PAGE，会出错）
-        buffer_pool_manager_->unpin_page(new_root->get_page_id(), true);
+        IxNodeHandle new_root = this->fetch_node(file_hdr_->root_page_);
+        new_root.page_hdr->parent = IX_NO_PAGE;  // root没有father（test时递归遍历树的时候，如果rootfather不修改为IX_NO_PAGE，会出错）
+        buffer_pool_manager_->unpin_page(new_root.get_page_id(), true);
 
         release_node_handle(*old_root_node);  // 更新file_hdr_.num_pages
         return true;
     }
     return false;
-    return false;
 }
 
 /**
@@ -509,12 +1176,13 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
         node->insert_pairs(node->get_size(), neighbor_node->get_key(0), (neighbor_node->get_rid(0)), 1);
         neighbor_node->erase_pair(0);
         parent->set_key(parent->find_child(neighbor_node), neighbor_node->get_key(0));  // 最小值被拿走，更新father对应的key
+        maintain_child(node, node->get_size() - 1);
     } else {                                                                            // node在右，向前插入
         node->insert_pairs(0, neighbor_node->get_key(neighbor_node->get_size() - 1), (neighbor_node->get_rid(neighbor_node->get_size() - 1)), 1);
         neighbor_node->erase_pair(neighbor_node->get_size() - 1);
         parent->set_key(index, node->get_key(0));  // 最小值新增，更新father对应的key
+        maintain_child(node, 0);
     }
-    maintain_child(node, node->get_size() - 1);
 }
 
 /**
@@ -530,8 +1198,9 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  * @param index node在parent中的rid_idx
  * @return true means parent node should be deleted, false means no deletion happend
  * @note Assume that *neighbor_node is the left sibling of *node (neighbor -> node)
+ * 被删除的页面放入事务的index_deleted_page_set_，等释放所有写锁之后再从缓冲池中删除
  */
-bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
+bool IxIndexHandle::coalesce(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
     // Todo:
     // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
@@ -543,22 +1212,365 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
     if (index == 0) {
         std::swap(node, neighbor_node);  // 可以将任意两个对象交换
     }
-    if ((*node)->get_page_no() == file_hdr_->last_leaf_) {
-        file_hdr_->last_leaf_ = (*neighbor_node)->get_page_no();
+    int pos = neighbor_node->get_size();
+    int num = node->get_size();
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    node->read_pairs(0, num, &keys, &rids);
+    if (!node->is_leaf_page() && num > 0) {
+        // node的第0个key在合并后参与查找，用父结点中指向node的分隔key
+        parent->read_key(parent->find_child(node), keys.data());
     }
-    int pos = (*neighbor_node)->get_size();
-    int num = (*node)->get_size();
-    (*neighbor_node)->insert_pairs(pos, (*node)->get_key(0), (*node)->get_rid(0), num);  // node的键值对添加到neighbor
+    neighbor_node->insert_pairs(pos, keys.data(), rids.data(), num);  // node的键值对添加到neighbor
     for (int i = pos; i < pos + num; i++) {
-        maintain_child((*neighbor_node), i);  // 更新node结点孩子结点的父节点信息
+        maintain_child(neighbor_node, i);  // 更新node结点孩子结点的父节点信息
+    }
+
+    if (node->is_leaf_page()) {
+        {
+            std::scoped_lock lock{file_hdr_latch_};
+            if (node->get_page_no() == file_hdr_->last_leaf_) {
+                file_hdr_->last_leaf_ = neighbor_node->get_page_no();
+            }
+        }
+        this->erase_leaf(node);  // 更新指针
+    }
+    release_node_handle(*node);  // 更新file_hdr_.num_pages
+    transaction->append_index_deleted_page(node->page);
+    parent->erase_pair(parent->find_child(node));
+    return coalesce_or_redistribute(parent, transaction, root_is_latched);
+}
+
+/**
+ * @brief 自底向上批量建树：按顺序取出排好序的键值对依次填入叶子结点，再用每个结点的第一个key逐层建立内部结点，
+ * 每个键值对只写一次，不需要从根结点查找，也不会分裂
+ * 只能在刚创建的空索引上调用，此时索引还没有被其他线程访问，不需要加锁
+ *
+ * @param sorter 已经finish的排序器，其中的key是上层的格式，编码不改变key的顺序，取出时再编码；
+ * 排序器按(key, rid)排序，与非唯一索引中加上rid之后的key的顺序相同
+ * @param fill_factor 结点的填充率，限制在[0.5, 1]之间，为之后的插入留出空间
+ * @param num_workers 最多使用的线程个数：键值对按key的范围分段，每个线程归并一段并建立这一段的叶子结点，
+ * 再把各段的叶子链表首尾相接；内部结点的每一层也分给多个线程建立
+ * @note 每一段（内部结点的每一层）的结点数为ceil(n / (btree_order * fill_factor))，键值对平均分给各个结点，最后一个结点不会过空；
+ * 压缩格式按字节数填充结点，每个结点放到fill_factor比例的字节数为止，最后一个结点过空时与前一个结点重新平分；
+ * 第一个叶子结点沿用初始的根结点页面，与first_leaf_一致；哈希索引没有顺序可以利用，按顺序逐个插入，不使用fill_factor和num_workers
+ * @throw IndexDuplicateKeyError 唯一索引存在重复的key
+ */
+void IxIndexHandle::bulk_load(IxSorter *sorter, double fill_factor, size_t num_workers) {
+    if (is_hash()) {
+        auto cursors = sorter->partition(1);
+        const char *key;
+        Rid rid;
+        while (cursors[0].next(&key, &rid)) {
+            if (hash_table_->insert_entry(key, rid) == IX_NO_PAGE) {
+                throw IndexDuplicateKeyError();
+            }
+        }
+        return;
+    }
+    assert(file_hdr_->root_page_ == IX_INIT_ROOT_PAGE && file_hdr_->num_pages_ == IX_INIT_NUM_PAGES);
+    size_t n = sorter->size();
+    if (n == 0) {
+        return;
+    }
+    fill_factor = std::clamp(fill_factor, 0.5, 1.0);
+    int fill = std::max(2, static_cast<int>(file_hdr_->btree_order_ * fill_factor));
+    int key_len = file_hdr_->col_tot_len_;
+
+    // 1. 叶子层：每段至少有IX_BUILD_MIN_LEAVES_PER_WORKER个叶子结点时才分给多个线程
+    size_t max_parts = std::max<size_t>(1, n / ((size_t)fill * IX_BUILD_MIN_LEAVES_PER_WORKER));
+    size_t num_parts = std::clamp<size_t>(num_workers, 1, max_parts);
+    auto cursors = sorter->partition(num_parts);
+    size_t first_part = 0;
+    while (cursors[first_part].size() == 0) {
+        first_part++;
+    }
+    if (file_hdr_->compressed_) {
+        const int hdr_len = sizeof(IxPageHdr) + sizeof(IxCompactHdr);
+        fill = hdr_len + static_cast<int>((PAGE_SIZE - hdr_len) * fill_factor);
+    }
+    std::vector<BulkLeaves> parts(num_parts);
+    parallel_for(num_parts, [&](size_t i) {
+        if (cursors[i].size() == 0) {
+            return;
+        }
+        if (file_hdr_->compressed_) {
+            bulk_load_compact_leaves(&cursors[i], i == first_part, fill, &parts[i]);
+        } else {
+            bulk_load_leaves(&cursors[i], i == first_part, fill, &parts[i]);
+        }
+    });
+
+    // 2. 把各段的叶子链表首尾相接，叶子链表的头尾都是leaf header
+    std::vector<char> keys;
+    std::vector<Rid> children;
+    BulkLeaves *prev = nullptr;
+    for (auto &part : parts) {
+        if (part.first_leaf == IX_NO_PAGE) {
+            continue;
+        }
+        if (prev != nullptr) {
+            if (ix_compare(prev->last_key.data(), part.keys.data(), file_hdr_) == 0) {
+                throw IndexDuplicateKeyError();
+            }
+            if (file_hdr_->compressed_) {
+                ix_shortest_separator(prev->last_key.data(), part.keys.data(), key_len, part.keys.data());
+            }
+            IxNodeHandle prev_leaf = fetch_node(prev->last_leaf);
+            prev_leaf.set_next_leaf(part.first_leaf);
+            buffer_pool_manager_->unpin_page(prev_leaf.get_page_id(), true);
+            IxNodeHandle first_leaf = fetch_node(part.first_leaf);
+            first_leaf.set_prev_leaf(prev->last_leaf);
+            buffer_pool_manager_->unpin_page(first_leaf.get_page_id(), true);
+        }
+        keys.insert(keys.end(), part.keys.begin(), part.keys.end());
+        children.insert(children.end(), part.children.begin(), part.children.end());
+        prev = &part;
+    }
+    IxNodeHandle last_leaf = fetch_node(prev->last_leaf);
+    last_leaf.set_next_leaf(IX_LEAF_HEADER_PAGE);
+    buffer_pool_manager_->unpin_page(last_leaf.get_page_id(), true);
+    file_hdr_->last_leaf_ = prev->last_leaf;
+
+    IxNodeHandle leaf_header = fetch_node(IX_LEAF_HEADER_PAGE);
+    leaf_header.set_next_leaf(IX_INIT_ROOT_PAGE);
+    leaf_header.set_prev_leaf(file_hdr_->last_leaf_);
+    buffer_pool_manager_->unpin_page(leaf_header.get_page_id(), true);
+    assert(static_cast<int>(keys.size()) == static_cast<int>(children.size()) * key_len);
+
+    // 3. 逐层向上建立内部结点，直到只剩一个结点作为根结点
+    while (children.size() > 1) {
+        bulk_load_level(&keys, &children, fill, num_parts);
+    }
+    update_root_page_no(children[0].page_no);
+}
+
+void IxIndexHandle::init_bulk_node(IxNodeHandle *node, bool is_leaf) {
+    node->page_hdr->next_free_page_no = IX_NO_PAGE;
+    node->page_hdr->parent = IX_NO_PAGE;
+    node->page_hdr->num_key = 0;
+    node->page_hdr->is_leaf = is_leaf;
+    node->page_hdr->prev_leaf = IX_NO_PAGE;
+    node->page_hdr->next_leaf = IX_NO_PAGE;
+    if (node->is_compressed()) {
+        node->init_compact();
+    }
+}
+
+/**
+ * @brief 用一段有序的键值对建立一串叶子结点，段内的叶子结点互相连接，段的首尾由调用者连接
+ *
+ * @param cursor 这一段键值对，不能为空
+ * @param use_init_root 是否为第一段，第一段的第一个叶子结点使用初始的根结点页面，prev_leaf指向leaf header
+ * @param fill 每个结点最多放入的键值对个数
+ * @param leaves 传出参数，这一段叶子结点的信息
+ */
+void IxIndexHandle::bulk_load_leaves(IxSorter::Cursor *cursor, bool use_init_root, int fill, BulkLeaves *leaves) {
+    int key_len = file_hdr_->col_tot_len_;
+    size_t n = cursor->size();
+    size_t num_nodes = (n + fill - 1) / fill;
+    leaves->keys.resize(num_nodes * key_len);
+    leaves->last_key.resize(key_len);
+    std::optional<IxNodeHandle> prev;  // 上一个还没有unpin的叶子结点
+    for (size_t i = 0; i < num_nodes; i++) {
+        IxNodeHandle leaf = i == 0 && use_init_root ? fetch_node(IX_INIT_ROOT_PAGE) : create_node();
+        init_bulk_node(&leaf, true);
+        if (!prev) {
+            leaf.set_prev_leaf(use_init_root ? IX_LEAF_HEADER_PAGE : IX_NO_PAGE);
+            leaves->first_leaf = leaf.get_page_no();
+        } else {
+            leaf.set_prev_leaf(prev->get_page_no());
+            prev->set_next_leaf(leaf.get_page_no());
+            buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+        }
+        int size = n / num_nodes + (i < n % num_nodes);
+        for (int j = 0; j < size; j++) {
+            const char *key;
+            Rid rid;
+            char key_buf[IX_MAX_COL_LEN];
+            cursor->next(&key, &rid);
+            key = encode_key(key, rid, key_buf);
+            if ((i > 0 || j > 0) &&
+                ix_compare(key, leaves->last_key.data(), file_hdr_) == 0) {
+                buffer_pool_manager_->unpin_page(leaf.get_page_id(), true);
+                throw IndexDuplicateKeyError();
+            }
+            memcpy(leaves->last_key.data(), key, key_len);
+            leaf.set_key(j, key);
+            leaf.set_rid(j, rid);
+        }
+        leaf.set_size(size);
+        memcpy(leaves->keys.data() + i * key_len, leaf.get_key(0), key_len);
+        leaves->children.push_back(Rid{leaf.get_page_no(), -1});
+        prev = leaf;
+    }
+    leaves->last_leaf = prev->get_page_no();
+    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+}
+
+/**
+ * @brief 压缩格式：用一段有序的键值对建立一串叶子结点，每个结点放到fill个字节为止
+ * 已经放满的结点先留在内存中，等下一个结点放满时才写入，最后一个结点过空时与前一个结点重新平分
+ *
+ * @param fill 每个结点最多占用的字节数
+ * @note 叶子结点在父结点中的key为它与前一个叶子结点之间最短的分隔key，段的第一个叶子结点的key由调用者在连接时计算
+ */
+void IxIndexHandle::bulk_load_compact_leaves(IxSorter::Cursor *cursor, bool use_init_root, int fill,
+                                             BulkLeaves *leaves) {
+    int key_len = file_hdr_->col_tot_len_;
+    leaves->last_key.resize(key_len);
+    std::optional<IxNodeHandle> prev;  // 上一个还没有unpin的叶子结点
+    std::vector<char> prev_last(key_len);
+    auto write_leaf = [&](const char *key, const Rid *rid, int n) {
+        IxNodeHandle leaf = !prev && use_init_root ? fetch_node(IX_INIT_ROOT_PAGE) : create_node();
+        init_bulk_node(&leaf, true);
+        leaves->keys.insert(leaves->keys.end(), key, key + key_len);
+        if (!prev) {
+            leaf.set_prev_leaf(use_init_root ? IX_LEAF_HEADER_PAGE : IX_NO_PAGE);
+            leaves->first_leaf = leaf.get_page_no();
+        } else {
+            ix_shortest_separator(prev_last.data(), key, key_len, leaves->keys.data() + leaves->keys.size() - key_len);
+            leaf.set_prev_leaf(prev->get_page_no());
+            prev->set_next_leaf(leaf.get_page_no());
+            buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+        }
+        leaf.assign_pairs(key, rid, n);
+        memcpy(prev_last.data(), key + (n - 1) * key_len, key_len);
+        leaves->children.push_back(Rid{leaf.get_page_no(), -1});
+        prev = leaf;
+    };
+
+    // keys中[0, split)为已经放满但还没有写入的结点，[split, size)为正在填充的结点
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    size_t split = 0;
+    IxCompactSizer sizer(key_len, true);
+    const char *key;
+    Rid rid;
+    char key_buf[IX_MAX_COL_LEN];
+    while (cursor->next(&key, &rid)) {
+        key = encode_key(key, rid, key_buf);
+        if (!rids.empty() || prev) {
+            if (ix_compare(key, leaves->last_key.data(), file_hdr_) == 0) {
+                if (prev) {
+                    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+                }
+                throw IndexDuplicateKeyError();
+            }
+        }
+        memcpy(leaves->last_key.data(), key, key_len);
+        sizer.add(key);
+        if (rids.size() > split && sizer.bytes() > fill) {
+            if (split > 0) {
+                write_leaf(keys.data(), rids.data(), split);
+                keys.erase(keys.begin(), keys.begin() + split * key_len);
+                rids.erase(rids.begin(), rids.begin() + split);
+            }
+            split = rids.size();
+            sizer.reset();
+            sizer.add(key);
+        }
+        keys.insert(keys.end(), key, key + key_len);
+        rids.push_back(rid);
+    }
+    if (split > 0) {
+        const int hdr_len = sizeof(IxPageHdr) + sizeof(IxCompactHdr);
+        if (sizer.bytes() - hdr_len < (PAGE_SIZE - hdr_len) / 2) {
+            split = compact_rebalance(keys.data(), split, rids.size(), true);
+        }
+        write_leaf(keys.data(), rids.data(), split);
+    }
+    write_leaf(keys.data() + split * key_len, rids.data() + split, rids.size() - split);
+    leaves->last_leaf = prev->get_page_no();
+    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+}
+
+/**
+ * @brief 压缩格式：把n个key重新分成[0, split)和[split, n)两个结点，使两个结点的字节数接近
+ *
+ * @param split 原来的分界，新的分界放不下时保持不变
+ * @return 新的分界
+ */
+size_t IxIndexHandle::compact_rebalance(const char *keys, size_t split, size_t n, bool is_leaf) {
+    int key_len = file_hdr_->col_tot_len_;
+    int total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += sizeof(IxSlot) + ix_trimmed_len(keys + i * key_len, key_len);
+    }
+    size_t mid = 0;
+    for (int acc = 0; mid + 1 < n && acc < total / 2; mid++) {
+        acc += sizeof(IxSlot) + ix_trimmed_len(keys + mid * key_len, key_len);
     }
+    size_t min_size = is_leaf ? 1 : 2;
+    if (n < 2 * min_size) {
+        return split;
+    }
+    mid = std::clamp(mid, min_size, n - min_size);
+    IxCompactSizer left(key_len, is_leaf), right(key_len, is_leaf);
+    for (size_t i = 0; i < n; i++) {
+        (i < mid ? left : right).add(keys + i * key_len);
+    }
+    return left.bytes() <= PAGE_SIZE && right.bytes() <= PAGE_SIZE ? mid : split;
+}
 
-    if ((*node)->is_leaf_page()) {
-        this->erase_leaf(*node);  // 更新指针
+/**
+ * @brief 用下一层结点的第一个key和页面号建立一层内部结点，结点分给多个线程建立，每个线程负责连续的一些结点
+ *
+ * @param keys 传入传出参数，传入下一层每个结点的第一个key，传出这一层每个结点的第一个key
+ * @param children 传入传出参数，传入下一层每个结点的页面号，传出这一层每个结点的页面号
+ * @param fill 每个结点最多放入的键值对个数，压缩格式为每个结点最多占用的字节数
+ * @param num_workers 最多使用的线程个数
+ */
+void IxIndexHandle::bulk_load_level(std::vector<char> *keys, std::vector<Rid> *children, int fill, size_t num_workers) {
+    int key_len = file_hdr_->col_tot_len_;
+    size_t m = children->size();
+    // bounds[i]为第i个结点的第一个孩子在下一层中的下标
+    std::vector<size_t> bounds;
+    if (file_hdr_->compressed_) {
+        IxCompactSizer sizer(key_len, false);
+        bounds.push_back(0);
+        for (size_t i = 0; i < m; i++) {
+            sizer.add(keys->data() + i * key_len);
+            if (sizer.size() > 2 && sizer.bytes() > fill) {
+                bounds.push_back(i);
+                sizer.reset();
+                sizer.add(keys->data() + i * key_len);
+            }
+        }
+        const int hdr_len = sizeof(IxPageHdr) + sizeof(IxCompactHdr);
+        if (bounds.size() > 1 && sizer.bytes() - hdr_len < (PAGE_SIZE - hdr_len) / 2) {
+            size_t begin = bounds[bounds.size() - 2];
+            bounds.back() = begin + compact_rebalance(keys->data() + begin * key_len, bounds.back() - begin, m - begin, false);
+        }
+        bounds.push_back(m);
+    } else {
+        size_t num_nodes = (m + fill - 1) / fill;
+        for (size_t i = 0; i <= num_nodes; i++) {
+            bounds.push_back(i * (m / num_nodes) + std::min(i, m % num_nodes));
+        }
     }
-    release_node_handle(**node);  // 更新file_hdr_.num_pages
-    (*parent)->erase_pair((*parent)->find_child(*node));
-    return coalesce_or_redistribute(*parent);
+    size_t num_nodes = bounds.size() - 1;
+    std::vector<char> parent_keys(num_nodes * key_len);
+    std::vector<Rid> parents(num_nodes);
+    auto node_begin = [&](size_t i) { return bounds[i]; };
+    num_workers = std::clamp<size_t>(num_nodes / IX_BUILD_MIN_LEAVES_PER_WORKER, 1, num_workers);
+    parallel_for(num_workers, [&](size_t w) {
+        for (size_t i = w * num_nodes / num_workers; i < (w + 1) * num_nodes / num_workers; i++) {
+            size_t begin = node_begin(i);
+            int size = node_begin(i + 1) - begin;
+            IxNodeHandle node = create_node();
+            init_bulk_node(&node, false);
+            node.insert_pairs(0, keys->data() + begin * key_len, &(*children)[begin], size);
+            for (int j = 0; j < size; j++) {
+                maintain_child(&node, j);
+            }
+            memcpy(parent_keys.data() + i * key_len, keys->data() + begin * key_len, key_len);
+            parents[i] = Rid{node.get_page_no(), -1};
+            buffer_pool_manager_->unpin_page(node.get_page_id(), true);
+        }
+    });
+    keys->swap(parent_keys);
+    children->swap(parents);
 }
 
 /**
@@ -571,12 +1583,41 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  * @note iid和rid存的不是一个东西，rid是上层传过来的记录位置，iid是索引内部生成的索引槽位置
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
-    IxNodeHandle *node = fetch_node(iid.page_no);
-    if (iid.slot_no >= node->get_size()) {
+    IxNodeHandle node = fetch_node(iid.page_no);
+    node.page->rlatch();
+    bool valid = iid.slot_no < node.get_size();
+    Rid rid = valid ? *node.get_rid(iid.slot_no) : Rid{};
+    node.page->runlatch();
+    buffer_pool_manager_->unpin_page(node.get_page_id(), false);  // unpin it!
+    if (!valid) {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    return rid;
+}
+
+/**
+ * @brief 读取iid处的键值对，用于不读取记录的index-only扫描
+ *
+ * @param key 传出参数，还原为上层的格式，长度为file_hdr_->user_key_len()，包括INCLUDE字段
+ * @param rid 传出参数
+ */
+void IxIndexHandle::get_entry(const Iid &iid, char *key, Rid *rid) const {
+    char buf[IX_MAX_COL_LEN];
+    IxNodeHandle node = fetch_node(iid.page_no);
+    node.page->rlatch();
+    bool valid = iid.slot_no < node.get_size();
+    if (valid) {
+        node.read_key(iid.slot_no, buf);
+        *rid = *node.get_rid(iid.slot_no);
+    }
+    node.page->runlatch();
+    buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+    if (!valid) {
+        throw IndexEntryNotFoundError();
+    }
+    char raw[IX_MAX_COL_LEN];
+    ix_decode_key(buf, file_hdr_, raw);
+    memcpy(key, raw, file_hdr_->user_key_len());
 }
 
 /**
@@ -588,7 +1629,9 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  * 可用*(int *)key转换回去
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-    return Iid{-1, -1};
+    // 非唯一索引从(key, 最小的rid)开始找，得到key的第一个键值对
+    char key_buf[IX_MAX_COL_LEN];
+    return find_lower_bound(encode_key(key, IX_MIN_RID, key_buf));
 }
 
 /**
@@ -598,7 +1641,71 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    return Iid{-1, -1};
+    // 非唯一索引从(key, 最大的rid)开始找，跳过key的所有键值对
+    char key_buf[IX_MAX_COL_LEN];
+    return find_upper_bound(encode_key(key, IX_MAX_RID, key_buf));
+}
+
+/**
+ * @brief 第一个不小于key的键值对的位置
+ *
+ * @param key 索引中保存的格式，见encode_key
+ */
+Iid IxIndexHandle::find_lower_bound(const char *key) {
+    IxNodeHandle leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    Iid iid = leaf_iid(&leaf, leaf.lower_bound(key));
+    leaf.page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+    return iid;
+}
+
+/**
+ * @brief 第一个大于key的键值对的位置
+ *
+ * @param key 索引中保存的格式，见encode_key
+ */
+Iid IxIndexHandle::find_upper_bound(const char *key) {
+    IxNodeHandle leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    int pos = leaf.lower_bound(key);
+    if (pos < leaf.get_size() && leaf.compare_key(pos, key) == 0) {
+        pos++;
+    }
+    Iid iid = leaf_iid(&leaf, pos);
+    leaf.page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+    return iid;
+}
+
+/**
+ * @brief 叶子结点中位置pos对应的iid；pos越过非最后一个叶子的末尾时指向下一个叶子的开头，与IxScan::next一致
+ */
+Iid IxIndexHandle::leaf_iid(IxNodeHandle *leaf, int pos) {
+    std::scoped_lock lock{file_hdr_latch_};
+    if (pos == leaf->get_size() && leaf->get_page_no() != file_hdr_->last_leaf_) {
+        return Iid{.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    return Iid{.page_no = leaf->get_page_no(), .slot_no = pos};
+}
+
+/**
+ * @brief 释放叶子结点，换成右边相邻的叶子结点并加读锁；与IxScan一样先释放再加锁，不同时持有两个叶子的锁
+ *
+ * @param leaf 已加读锁的叶子结点，移动成功时换成下一个叶子结点
+ * @return 已经是最后一个叶子结点时返回false，leaf不变
+ */
+bool IxIndexHandle::move_to_next_leaf(IxNodeHandle *leaf) {
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        if (leaf->get_page_no() == file_hdr_->last_leaf_) {
+            return false;
+        }
+    }
+    page_id_t next = leaf->get_next_leaf();
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    *leaf = fetch_node(next);
+    leaf->page->rlatch();
+    return true;
 }
 
 /**
@@ -608,9 +1715,16 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    page_id_t last_leaf;
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        last_leaf = file_hdr_->last_leaf_;
+    }
+    IxNodeHandle node = fetch_node(last_leaf);
+    node.page->rlatch();
+    Iid iid = {.page_no = last_leaf, .slot_no = node.get_size()};
+    node.page->runlatch();
+    buffer_pool_manager_->unpin_page(node.get_page_id(), false);  // unpin it!
     return iid;
 }
 
@@ -629,76 +1743,85 @@ Iid IxIndexHandle::leaf_begin() const {
  * @brief 获取一个指定结点
  *
  * @param page_no
- * @return IxNodeHandle*
+ * @return IxNodeHandle
  * @note pin the page, remember to unpin it outside!
+ * 结点句柄只是指向页面各部分的几个指针，按值返回，拷贝和销毁都不影响页面，不需要释放
  */
-IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
+IxNodeHandle IxIndexHandle::fetch_node(int page_no) const {
     Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
-    IxNodeHandle *node = new IxNodeHandle(file_hdr_, page);
-
-    return node;
+    return IxNodeHandle(file_hdr_, page);
 }
 
 /**
  * @brief 创建一个新结点
  *
- * @return IxNodeHandle*
+ * @return IxNodeHandle
  * @note pin the page, remember to unpin it outside!
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
  * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
  * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
-IxNodeHandle *IxIndexHandle::create_node() {
-    IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+IxNodeHandle IxIndexHandle::create_node() {
+    {
+        std::scoped_lock lock{file_hdr_latch_};
+        file_hdr_->num_pages_++;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
-    node = new IxNodeHandle(file_hdr_, page);
+    IxNodeHandle node(file_hdr_, page);
+    if (node.is_compressed()) {
+        node.init_compact();
+    }
     return node;
 }
 
 /**
  * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
+ * 只有结点在父结点中的位置为0时，父结点的第一个key才会跟着变化，因此遇到位置不为0的结点就停止；
+ * 沿途的结点在删除时都被判为不安全，仍被当前事务持有写锁
  *
  * @param node
  */
 void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
-    IxNodeHandle *curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
+    IxNodeHandle curr = *node;
+    while (curr.get_parent_page_no() != IX_NO_PAGE) {
         // Load its parent
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
-        int rank = parent->find_child(curr);
-        char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
-        }
+        IxNodeHandle parent = fetch_node(curr.get_parent_page_no());
+        int rank = parent.find_child(&curr);
+        char *parent_key = parent.get_key(rank);
+        char *child_first_key = curr.get_key(0);
+        bool done = memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0 || rank != 0;
         memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
         curr = parent;
 
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
+        assert(buffer_pool_manager_->unpin_page(parent.get_page_id(), true));
+        if (done) {
+            break;
+        }
     }
 }
 
 /**
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
+ * 前驱结点就是合并时的左兄弟结点，已经持有写锁；后继结点在这里临时加写锁
  *
  * @param leaf 要删除的leaf
  */
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
-    IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
-    prev->set_next_leaf(leaf->get_next_leaf());
-    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    IxNodeHandle prev = fetch_node(leaf->get_prev_leaf());
+    prev.set_next_leaf(leaf->get_next_leaf());
+    buffer_pool_manager_->unpin_page(prev.get_page_id(), true);
 
-    IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
-    next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
-    buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    IxNodeHandle next = fetch_node(leaf->get_next_leaf());
+    next.page->wlatch();
+    next.set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next.page->wunlatch();
+    buffer_pool_manager_->unpin_page(next.get_page_id(), true);
 }
 
 /**
@@ -707,18 +1830,20 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
+    std::scoped_lock lock{file_hdr_latch_};
     file_hdr_->num_pages_--;
 }
 
 /**
  * @brief 将node的第child_idx个孩子结点的父节点置为node
+ * 修改父结点指针不需要加锁：只有持有父结点写锁的事务才会读孩子的父结点指针
  */
 void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
     if (!node->is_leaf_page()) {
         //  Current node is inner node, load its child and set its parent to current node
         int child_page_no = node->value_at(child_idx);
-        IxNodeHandle *child = fetch_node(child_page_no);
-        child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        IxNodeHandle child = fetch_node(child_page_no);
+        child.set_parent_page_no(node->get_page_no());
+        buffer_pool_manager_->unpin_page(child.get_page_id(), true);
     }
-}
\ No newline at end of file
+}
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <shared_mutex>
+
 #include "ix_defs.h"
+#include "ix_hash.h"
+#include "ix_sorter.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0,
@@ -39,6 +43,221 @@ inline int ix_compare(const char *a, const char *b, const std::vector<ColType> &
     return 0;
 }
 
+/* 各种形式的key的比较方式，IxNodeHandle的查找和比较按key的形式实例化，单一类型的比较和key的长度在编译时确定，可以内联
+ * 对应IxFileHdr::key_schema_，IxGenericKey是逐个字段比较的通用形式 */
+struct IxIntKey {
+    static int len(const IxFileHdr *) { return sizeof(int); }
+    static int compare(const char *a, const char *b, const IxFileHdr *) {
+        int ia = *(const int *)a, ib = *(const int *)b;
+        return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+    }
+};
+
+struct IxFloatKey {
+    static int len(const IxFileHdr *) { return sizeof(float); }
+    static int compare(const char *a, const char *b, const IxFileHdr *) {
+        float fa = *(const float *)a, fb = *(const float *)b;
+        return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
+    }
+};
+
+/* 全部字段都是字符串或者key编码过时整个key按字节比较；唯一索引不比较末尾的INCLUDE字段 */
+struct IxBytesKey {
+    static int len(const IxFileHdr *hdr) { return hdr->col_tot_len_; }
+    static int compare(const char *a, const char *b, const IxFileHdr *hdr) { return memcmp(a, b, hdr->cmp_len_); }
+};
+
+struct IxGenericKey {
+    static int len(const IxFileHdr *hdr) { return hdr->col_tot_len_; }
+    static int compare(const char *a, const char *b, const IxFileHdr *hdr) {
+        return ix_compare(a, b, hdr->col_types_, hdr->col_lens_);
+    }
+};
+
+/* 按IxFileHdr::key_schema_比较索引中的两个key */
+inline int ix_compare(const char *a, const char *b, const IxFileHdr *hdr) {
+    switch (hdr->key_schema_) {
+    case IxKeySchema::INT:
+        return IxIntKey::compare(a, b, hdr);
+    case IxKeySchema::FLOAT:
+        return IxFloatKey::compare(a, b, hdr);
+    case IxKeySchema::BYTES:
+        return IxBytesKey::compare(a, b, hdr);
+    default:
+        return IxGenericKey::compare(a, b, hdr);
+    }
+}
+
+/**
+ * @description: 把一个字段编码为按字节比较与按值比较顺序相同的格式，按大端存放：
+ * INT翻转符号位；FLOAT的非负数翻转符号位、负数翻转所有位，-0.0与0.0编码相同；字符串不变
+ * @param {char*} src 字段的值
+ * @param {char*} dest 传出参数，长度与字段相同
+ */
+inline void ix_encode_col(const char *src, ColType type, int len, char *dest) {
+    uint32_t bits;
+    switch (type) {
+    case TYPE_INT:
+        memcpy(&bits, src, sizeof(bits));
+        bits ^= 0x80000000u;
+        break;
+    case TYPE_FLOAT: {
+        float val;
+        memcpy(&val, src, sizeof(val));
+        val = val == 0.0f ? 0.0f : val;
+        memcpy(&bits, &val, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        break;
+    }
+    default:
+        memcpy(dest, src, len);
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        dest[i] = static_cast<char>(bits >> (24 - 8 * i));
+    }
+}
+
+/* ix_encode_col的逆变换 */
+inline void ix_decode_col(const char *src, ColType type, int len, char *dest) {
+    if (type != TYPE_INT && type != TYPE_FLOAT) {
+        memcpy(dest, src, len);
+        return;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits = (bits << 8) | static_cast<uint8_t>(src[i]);
+    }
+    if (type == TYPE_INT) {
+        bits ^= 0x80000000u;
+    } else {
+        bits = (bits & 0x80000000u) ? (bits & ~0x80000000u) : ~bits;
+    }
+    memcpy(dest, &bits, sizeof(bits));
+}
+
+/**
+ * @description: 按索引的字段把key逐个字段编码，编码后的key用一次memcmp比较；索引不需要编码时直接复制
+ * @param {char*} src 上层传入的key，各字段依次存放
+ * @param {char*} dest 传出参数，长度为hdr->col_tot_len_
+ */
+inline void ix_encode_key(const char *src, const IxFileHdr *hdr, char *dest) {
+    if (!hdr->encoded_) {
+        memcpy(dest, src, hdr->col_tot_len_);
+        return;
+    }
+    int offset = 0;
+    for (int i = 0; i < hdr->col_num_; i++) {
+        ix_encode_col(src + offset, hdr->col_types_[i], hdr->col_lens_[i], dest + offset);
+        offset += hdr->col_lens_[i];
+    }
+}
+
+/* ix_encode_key的逆变换，把索引中保存的key还原为上层的格式 */
+inline void ix_decode_key(const char *src, const IxFileHdr *hdr, char *dest) {
+    if (!hdr->encoded_) {
+        memcpy(dest, src, hdr->col_tot_len_);
+        return;
+    }
+    int offset = 0;
+    for (int i = 0; i < hdr->col_num_; i++) {
+        ix_decode_col(src + offset, hdr->col_types_[i], hdr->col_lens_[i], dest + offset);
+        offset += hdr->col_lens_[i];
+    }
+}
+
+/* 非唯一索引在key后面加上的rid字段：page_no和slot_no分别按INT编码，按字节比较与按(page_no, slot_no)比较的顺序相同 */
+inline void ix_encode_rid(const Rid &rid, char *dest) {
+    ix_encode_col(reinterpret_cast<const char *>(&rid.page_no), TYPE_INT, sizeof(int), dest);
+    ix_encode_col(reinterpret_cast<const char *>(&rid.slot_no), TYPE_INT, sizeof(int), dest + sizeof(int));
+}
+
+/* key去掉末尾的'\0'之后的长度 */
+inline int ix_trimmed_len(const char *key, int len) {
+    while (len > 0 && key[len - 1] == '\0') {
+        len--;
+    }
+    return len;
+}
+
+/* 两个key的最长公共前缀的长度，最多比较len个字节 */
+inline int ix_common_prefix_len(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @description: 求满足left < sep <= right的最短的分隔key：取right中比公共前缀多一个字节的部分，末尾补'\0'
+ * 只用于按字节比较的key（全部字段都是字符串）
+ * @param {char*} left 较小的key
+ * @param {char*} right 较大的key
+ * @param {int} len key的长度
+ * @param {char*} sep 传出参数，长度为len
+ */
+inline void ix_shortest_separator(const char *left, const char *right, int len, char *sep) {
+    int prefix_len = ix_common_prefix_len(left, right, len);
+    assert(prefix_len < len);
+    memcpy(sep, right, prefix_len + 1);
+    memset(sep + prefix_len + 1, 0, len - prefix_len - 1);
+}
+
+/* 压缩格式：按key从小到大的顺序逐个加入，增量计算这些key编码到一个结点中需要的字节数，结果与IxNodeHandle::compact_bytes相同
+ * 有序的key的公共前缀就是第一个key和最后一个key的公共前缀，只在公共前缀变短时重新计算所有后缀的长度 */
+class IxCompactSizer {
+   public:
+    IxCompactSizer(int key_len, bool is_leaf) : key_len_(key_len), is_leaf_(is_leaf) {}
+
+    void reset() {
+        num_ = 0;
+        lens_.clear();
+    }
+
+    void add(const char *key) {
+        num_++;
+        if (!is_leaf_ && num_ == 1) {
+            return;  // 内部结点的第0个key不保存
+        }
+        int len = ix_trimmed_len(key, key_len_);
+        lens_.push_back(len);
+        if (lens_.size() == 1) {
+            first_.assign(key, key + key_len_);
+            prefix_len_ = len;
+            suffix_bytes_ = 0;
+            return;
+        }
+        int prefix_len = ix_common_prefix_len(first_.data(), key, lens_.size() == 2 ? key_len_ : prefix_len_);
+        if (prefix_len != prefix_len_) {
+            prefix_len_ = prefix_len;
+            suffix_bytes_ = 0;
+            for (int cur : lens_) {
+                suffix_bytes_ += std::max(0, cur - prefix_len_);
+            }
+        } else {
+            suffix_bytes_ += std::max(0, len - prefix_len_);
+        }
+    }
+
+    /* 已经加入的key的个数 */
+    int size() const { return num_; }
+
+    int bytes() const {
+        int bytes = sizeof(IxPageHdr) + sizeof(IxCompactHdr) + num_ * sizeof(IxSlot);
+        return lens_.empty() ? bytes : bytes + prefix_len_ + suffix_bytes_;
+    }
+
+   private:
+    int key_len_;
+    bool is_leaf_;
+    int num_ = 0;
+    std::vector<char> first_;       // 第一个保存的key
+    std::vector<int> lens_;         // 保存的key去掉末尾'\0'之后的长度
+    int prefix_len_ = 0;
+    int suffix_bytes_ = 0;
+};
+
 /* 管理B+树中的每个节点 */
 class IxNodeHandle {
     friend class IxIndexHandle;
@@ -50,6 +269,9 @@ private:
     IxPageHdr *page_hdr;        // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
     char *keys;                 // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
     Rid *rids;                  // page->data的第三部分，指针指向首地址
+    // 压缩格式（file_hdr->compressed_）的结点不使用keys和rids，布局见IxCompactHdr
+    IxCompactHdr *compact_hdr;  // page->data的第二部分
+    IxSlot *slots;              // page->data的第三部分，每个键值对一个槽
 
 public:
     IxNodeHandle() = default;
@@ -58,8 +280,12 @@ public:
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
         keys = page->get_data() + sizeof(IxPageHdr);
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+        compact_hdr = reinterpret_cast<IxCompactHdr *>(keys);
+        slots = reinterpret_cast<IxSlot *>(keys + sizeof(IxCompactHdr));
     }
 
+    bool is_compressed() const { return file_hdr->compressed_; }
+
     int get_size() { return page_hdr->num_key; }  // 已插入的keys数量，key_idx∈[0,num_key)
 
     void set_size(int size) { page_hdr->num_key = size; }
@@ -93,13 +319,39 @@ public:
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    /* 定长格式中第key_idx个key的地址，压缩格式的key需要用read_key解码 */
+    char *get_key(int key_idx) const {
+        assert(!is_compressed());
+        return keys + key_idx * file_hdr->col_tot_len_;
+    }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    Rid *get_rid(int rid_idx) const { return is_compressed() ? &slots[rid_idx].rid : &rids[rid_idx]; }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }  // 传入数组索引和值的地址
+    void set_key(int key_idx, const char *key) {
+        assert(!is_compressed());
+        memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);  // 传入数组索引和值的地址
+    }
     // 这是通过keys的起始位置算目标位置的长度（第几个*数据长度）//源地址//字节数
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
+
+    int compare_key(int key_idx, const char *target) const;
+
+    void read_key(int key_idx, char *dest) const;
+
+    void read_pairs(int begin, int end, std::vector<char> *keys, std::vector<Rid> *rids) const;
+
+    bool is_underflow() const;
+
+    // 压缩格式
+    void init_compact();
+
+    int used_bytes() const;
+
+    bool can_insert(const char *key) const;
+
+    void assign_pairs(const char *key, const Rid *rid, int n);
+
+    int compact_bytes(const char *key, int n) const;
 
     int lower_bound(const char *target) const;
 
@@ -120,6 +372,22 @@ public:
 
     int remove(const char *key);
 
+private:
+    int compact_prefix_len(const char *key, int n) const;
+
+    int stored_key_len(int key_idx, int prefix_len) const;
+
+    int compare_suffix(int key_idx, const char *target, int target_len) const;
+
+    template <typename Key, bool upper>
+    int search_as(int lo, int hi, const char *target) const;
+
+    template <bool upper>
+    int search_fixed(int lo, int hi, const char *target) const;
+
+    void insert_compact(int pos, const char *key, const Rid &rid);
+
+public:
     /**
      * @brief used in internal node to remove the last key in root node, and return the last child
      *
@@ -150,7 +418,7 @@ public:
     }
 };
 
-/* B+树 */
+/* B+树；INDEX_HASH类型的索引文件中是可扩展哈希表，等值查找、插入、删除和批量建立转发给hash_table_ */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
@@ -160,26 +428,38 @@ private:
     BufferPoolManager *buffer_pool_manager_;
     int fd_;               // 存储B+树的文件
     IxFileHdr *file_hdr_;  // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::shared_mutex root_latch_;  // 保护file_hdr_->root_page_：查找时加读锁，插入和删除时加写锁直到根结点安全
+    mutable std::mutex file_hdr_latch_;  // 保护file_hdr_中的num_pages_和last_leaf_
+    std::unique_ptr<IxHashTable> hash_table_;  // 哈希索引的哈希表，B+树索引为空
 
 public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
+    bool is_hash() const { return file_hdr_->index_type_ == INDEX_HASH; }
+
+    /* 哈希索引的目录的全局深度 */
+    int get_global_depth() const { return hash_table_->get_global_depth(); }
+
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
-    std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
-                                                   bool find_first = false);
+    void get_values(const std::vector<const char *> &keys, std::vector<std::vector<Rid>> *results,
+                    Transaction *transaction);
+
+    std::pair<IxNodeHandle, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
+                                                 bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    IxNodeHandle split(IxNodeHandle *node);
+
+    page_id_t insert_into_compact(IxNodeHandle *node, int pos, const char *key, const Rid &rid, Transaction *transaction);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
     // for delete
-    bool delete_entry(const char *key, Transaction *transaction);
+    bool delete_entry(const char *key, const Rid &value, Transaction *transaction);
 
     bool coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction = nullptr,
                                   bool *root_is_latched = nullptr);
@@ -187,7 +467,7 @@ public:
 
     void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
 
-    bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
+    bool coalesce(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
     Iid lower_bound(const char *key);
@@ -198,16 +478,76 @@ public:
 
     Iid leaf_begin() const;
 
+    void get_entry(const Iid &iid, char *key, Rid *rid) const;
+
+    // for bulk load
+    void bulk_load(IxSorter *sorter, double fill_factor = IX_FILL_FACTOR, size_t num_workers = 1);
+
 private:
+    // for latch crabbing
+    bool is_safe(IxNodeHandle *node, Operation operation, const char *key, int pos);
+
+    void release_latches(Transaction *transaction, bool *root_is_latched);
+
+    void delete_pages(Transaction *transaction);
+
+    Iid leaf_iid(IxNodeHandle *leaf, int pos);
+
+    Iid find_lower_bound(const char *key);
+
+    Iid find_upper_bound(const char *key);
+
+    bool move_to_next_leaf(IxNodeHandle *leaf);
+
+    // for bulk load
+    /* 批量建树时由一个线程建立的一段连续的叶子结点 */
+    struct BulkLeaves {
+        page_id_t first_leaf = IX_NO_PAGE;
+        page_id_t last_leaf = IX_NO_PAGE;
+        std::vector<char> keys;         // 每个叶子结点在父结点中的key
+        std::vector<Rid> children;      // 每个叶子结点的页面号
+        std::vector<char> last_key;     // 最后一个叶子结点的最后一个key，用于检查段与段之间的重复
+    };
+
+    void init_bulk_node(IxNodeHandle *node, bool is_leaf);
+
+    void bulk_load_leaves(IxSorter::Cursor *cursor, bool use_init_root, int fill, BulkLeaves *leaves);
+
+    void bulk_load_compact_leaves(IxSorter::Cursor *cursor, bool use_init_root, int fill, BulkLeaves *leaves);
+
+    size_t compact_rebalance(const char *keys, size_t split, size_t n, bool is_leaf);
+
+    void bulk_load_level(std::vector<char> *keys, std::vector<Rid> *children, int fill, size_t num_workers);
+
     // 辅助函数
     void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
 
+    /* 上层传入的key（包括INCLUDE字段）转换为索引中保存的格式，结果在buf中：非唯一索引在key后面加上编码后的rid，再按字段编码；
+     * 唯一索引不使用rid，不需要编码时直接返回key */
+    const char *encode_key(const char *key, const Rid &rid, char *buf) const {
+        if (file_hdr_->unique_) {
+            if (!file_hdr_->encoded_) {
+                return key;
+            }
+            ix_encode_key(key, file_hdr_, buf);
+            return buf;
+        }
+        char raw[IX_MAX_COL_LEN];
+        int len = file_hdr_->user_key_len();
+        memcpy(raw, key, len);
+        ix_encode_rid(rid, raw + len);
+        ix_encode_key(raw, file_hdr_, buf);
+        return buf;
+    }
+
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
     // for get/create node
-    IxNodeHandle *fetch_node(int page_no) const;
+    IxNodeHandle fetch_node(int page_no) const;
+
+    IxNodeHandle create_node();
 
-    IxNodeHandle *create_node();
+    IxNodeHandle create_sibling(IxNodeHandle *node);
 
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
@@ -44,7 +44,16 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    /**
+     * @description: 创建索引文件
+     * @param {vector<ColMeta>&} index_cols 索引包含的字段
+     * @param {bool} unique 是否为唯一索引；非唯一索引在字段后面加一个sizeof(Rid)字节的字段存放编码后的rid，
+     * 索引中的键值对按(key, rid)排序，key相同的键值对可以共存
+     * @param {int} include_num index_cols末尾的INCLUDE字段的个数，INCLUDE字段的值随key存放在叶子中，唯一性只由前面的字段决定
+     * @param {IndexType} index_type INDEX_HASH时文件中是可扩展哈希表（见ix_hash.h），不写入B+树的叶子链表头和根结点
+     */
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool unique = true,
+                      int include_num = 0, IndexType index_type = INDEX_BTREE) {
         std::string ix_name = get_index_name(filename, index_cols);
 
         // Create index file
@@ -61,6 +70,10 @@ class IxManager {
         for(auto& col: index_cols) {
             col_tot_len += col.len;
         }
+        if (!unique) {
+            col_num++;
+            col_tot_len += sizeof(Rid);
+        }
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
@@ -73,9 +86,30 @@ class IxManager {
         IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
                                 col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
                                 IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
-        for(int i = 0; i < col_num; ++i) {
-            fhdr->col_types_.push_back(index_cols[i].type);
-            fhdr->col_lens_.push_back(index_cols[i].len);
+        for(auto& col: index_cols) {
+            fhdr->col_types_.push_back(col.type);
+            fhdr->col_lens_.push_back(col.len);
+        }
+        fhdr->unique_ = unique;
+        fhdr->include_len_ = 0;
+        for (size_t i = index_cols.size() - include_num; i < index_cols.size(); i++) {
+            fhdr->include_len_ += index_cols[i].len;
+        }
+        if (!unique) {
+            // rid字段由ix_encode_rid编码，按字节比较
+            fhdr->col_types_.push_back(TYPE_STRING);
+            fhdr->col_lens_.push_back(sizeof(Rid));
+        }
+        // 包含数值字段的多字段key编码为按字节比较的格式，整个key只需要一次memcmp
+        fhdr->encoded_ = col_num > 1 && !fhdr->is_all_string();
+        // 按字节比较的key较长时使用压缩格式的结点，可以提取公共前缀、截断分隔key
+        // 唯一索引比较时跳过INCLUDE字段，而压缩格式的结点按整个key比较，这时不压缩
+        fhdr->compressed_ = col_tot_len >= IX_COMPRESS_MIN_KEY_LEN && (fhdr->encoded_ || fhdr->is_all_string()) &&
+                            (!unique || include_num == 0);
+        fhdr->index_type_ = index_type;
+        if (index_type == INDEX_HASH) {
+            fhdr->compressed_ = false;
+            fhdr->num_pages_ = IX_HASH_INIT_NUM_PAGES;
         }
         fhdr->update_tot_len();
         
@@ -84,6 +118,12 @@ class IxManager {
 
         disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
 
+        if (index_type == INDEX_HASH) {
+            IxHashTable::init_file(disk_manager_, fd);
+            disk_manager_->close_file(fd);
+            return;
+        }
+
         char page_buf[PAGE_SIZE];  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
         memset(page_buf, 0, PAGE_SIZE);
         // 注意leaf header页号为1，也标记为叶子结点，其前一个/后一个叶子均指向root node
@@ -114,6 +154,10 @@ class IxManager {
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
             };
+            if (fhdr->compressed_) {
+                auto chdr = reinterpret_cast<IxCompactHdr *>(page_buf + sizeof(IxPageHdr));
+                *chdr = {.prefix_off = PAGE_SIZE, .prefix_len = 0, .heap_begin = PAGE_SIZE, .dead_bytes = 0};
+            }
             // Must write PAGE_SIZE here in case of future fetch_node()
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
         }
@@ -2,23 +2,31 @@
 
 /**
  * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @note 读取叶子结点时加读锁，读完之后释放读锁并unpin
  */
 void IxScan::next() { //这个函数的目标是移到索引中的下一个记录
     assert(!is_end());//检查是否到了索引的末尾
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);//从索引处理器中获取当前页。
+    IxNodeHandle node = ih_->fetch_node(iid_.page_no);//从索引处理器中获取当前页。
     //这个操作会调用缓冲池（Buffer Pool）中的相关功能，通常用于减少磁盘访问，提高性能。
-    assert(node->is_leaf_page());//确认所获取的节点是否为叶子节点。
+    node.page->rlatch();
+    assert(node.is_leaf_page());//确认所获取的节点是否为叶子节点。
     //叶子节点通常包含实际的数据或记录标识符。
-    assert(iid_.slot_no < node->get_size());
+    assert(iid_.slot_no < node.get_size());
     // increment slot no
     iid_.slot_no++;
     //准备访问当前页的下一个记录
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
+    page_id_t last_leaf;
+    {
+        std::scoped_lock lock{ih_->file_hdr_latch_};
+        last_leaf = ih_->file_hdr_->last_leaf_;
+    }
+    if (iid_.page_no != last_leaf && iid_.slot_no == node.get_size()) {
         // go to next leaf
         iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+        iid_.page_no = node.get_next_leaf();
     }
+    node.page->runlatch();
+    bpm_->unpin_page(node.get_page_id(), false);
 }
 
 Rid IxScan::rid() const {
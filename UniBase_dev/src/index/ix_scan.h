@@ -24,5 +24,8 @@ class IxScan : public RecScan {
 
     Rid rid() const override;
 
+    /* 当前位置的key和rid，key的格式见IxIndexHandle::get_entry */
+    void get_entry(char *key, Rid *rid) const { ih_->get_entry(iid_, key, rid); }
+
     const Iid &iid() const { return iid_; }
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/config.h"
+
+/* 单个INT或FLOAT字段的索引在结点内查找key：结点的key是连续存放的定长数值数组，
+ * 先二分查找把范围缩小到IX_SIMD_LINEAR_KEYS个key以内，再用SIMD一次比较4个key，数出范围内比target小（或不大于target）的key的个数 */
+
+/**
+ * @description: keys[0, n)中小于target（upper为true时不大于target）的key的个数，keys有序
+ * @param {char*} keys 定长数值数组的首地址，不要求对齐
+ * @param {int} n key的个数
+ * @param {T} target 要查找的key
+ */
+template <typename T, bool upper>
+inline int ix_simd_count(const char *keys, int n, T target) {
+    static_assert(sizeof(T) == 4, "SIMD search only supports 4-byte keys");
+    int i = 0;
+    int cnt = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4) {
+        // 每个lane为全1表示这个key应该计入
+        __m128i mask;
+        if constexpr (std::is_same_v<T, int>) {
+            __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(T)));
+            __m128i t = _mm_set1_epi32(target);
+            // key < target，或者key <= target即!(key > target)
+            mask = upper ? _mm_xor_si128(_mm_cmpgt_epi32(k, t), _mm_set1_epi32(-1)) : _mm_cmplt_epi32(k, t);
+        } else {
+            __m128 k = _mm_loadu_ps(reinterpret_cast<const float *>(keys + i * sizeof(T)));
+            __m128 t = _mm_set1_ps(target);
+            mask = _mm_castps_si128(upper ? _mm_cmple_ps(k, t) : _mm_cmplt_ps(k, t));
+        }
+        cnt += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    }
+#endif
+    for (; i < n; i++) {
+        T key;
+        memcpy(&key, keys + i * sizeof(T), sizeof(T));
+        cnt += upper ? key <= target : key < target;
+    }
+    return cnt;
+}
+
+/**
+ * @description: 在有序的定长数值数组keys的[lo, hi)中查找第一个不小于target（upper为true时大于target）的下标
+ * @param {char*} keys 定长数值数组的首地址
+ * @param {char*} target 要查找的key
+ * @return {int} 下标，范围为[lo, hi]
+ */
+template <typename T, bool upper>
+inline int ix_numeric_bound(const char *keys, int lo, int hi, const char *target) {
+    T t;
+    memcpy(&t, target, sizeof(T));
+    while (hi - lo > IX_SIMD_LINEAR_KEYS) {
+        int mid = (lo + hi) >> 1;
+        T key;
+        memcpy(&key, keys + mid * sizeof(T), sizeof(T));
+        if (upper ? key > t : key >= t) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo + ix_simd_count<T, upper>(keys + lo * sizeof(T), hi - lo, t);
+}
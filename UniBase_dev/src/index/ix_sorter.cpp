@@ -0,0 +1,267 @@
+#include "ix_sorter.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "ix_index_handle.h"
+
+IxSorter::IxSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens, size_t mem_limit)
+    : col_types_(col_types), col_lens_(col_lens), mem_limit_(mem_limit) {
+    key_len_ = 0;
+    for (int len : col_lens_) {
+        key_len_ += len;
+    }
+    entry_len_ = key_len_ + sizeof(Rid);
+    // 内存上限至少能放下一个键值对
+    mem_limit_ = std::max(mem_limit_, (size_t)entry_len_);
+}
+
+void IxSorter::add(const char *key, const Rid &rid) {
+    if (buf_.size() + entry_len_ > mem_limit_) {
+        spill();
+    }
+    buf_.insert(buf_.end(), key, key + key_len_);
+    buf_.insert(buf_.end(), (const char *)&rid, (const char *)&rid + sizeof(Rid));
+    num_entries_++;
+}
+
+/**
+ * @brief 先比较key，key相同时比较rid
+ */
+int IxSorter::compare(const char *a, const char *b) const {
+    int res = ix_compare(a, b, col_types_, col_lens_);
+    if (res != 0) {
+        return res;
+    }
+    Rid ra, rb;
+    memcpy(&ra, a + key_len_, sizeof(Rid));
+    memcpy(&rb, b + key_len_, sizeof(Rid));
+    if (ra.page_no != rb.page_no) {
+        return ra.page_no < rb.page_no ? -1 : 1;
+    }
+    return ra.slot_no < rb.slot_no ? -1 : (ra.slot_no > rb.slot_no ? 1 : 0);
+}
+
+/**
+ * @brief 对buf_中的键值对排序，得到一个内存中的run并清空buf_；排序时只交换偏移，最后按顺序拷贝一次
+ */
+std::unique_ptr<IxSorter::Run> IxSorter::sort_buffer() {
+    std::vector<size_t> order;
+    for (size_t offset = 0; offset < buf_.size(); offset += entry_len_) {
+        order.push_back(offset);
+    }
+    std::sort(order.begin(), order.end(),
+              [this](size_t a, size_t b) { return compare(buf_.data() + a, buf_.data() + b) < 0; });
+    auto run = std::make_unique<Run>();
+    run->num_entries = order.size();
+    run->data.resize(buf_.size());
+    char *dest = run->data.data();
+    for (size_t offset : order) {
+        memcpy(dest, buf_.data() + offset, entry_len_);
+        dest += entry_len_;
+    }
+    buf_.clear();
+    return run;
+}
+
+/**
+ * @brief 把内存中的键值对排好序写入一个临时文件，临时文件关闭时自动删除
+ */
+void IxSorter::spill() {
+    if (buf_.empty()) {
+        return;
+    }
+    auto run = sort_buffer();
+    run->file = std::tmpfile();
+    if (run->file == nullptr) {
+        throw UnixError();
+    }
+    if (std::fwrite(run->data.data(), entry_len_, run->num_entries, run->file) != run->num_entries ||
+        std::fflush(run->file) != 0) {
+        throw UnixError();
+    }
+    run->data.clear();
+    run->data.shrink_to_fit();
+    runs_.push_back(std::move(run));
+}
+
+void IxSorter::absorb(IxSorter &other) {
+    assert(other.buf_.empty() && other.entry_len_ == entry_len_);
+    for (auto &run : other.runs_) {
+        runs_.push_back(std::move(run));
+    }
+    num_entries_ += other.num_entries_;
+    other.runs_.clear();
+    other.num_entries_ = 0;
+}
+
+void IxSorter::finish() {
+    if (!buf_.empty()) {
+        runs_.push_back(sort_buffer());
+    }
+    buf_.shrink_to_fit();
+    cursor_ = nullptr;
+}
+
+bool IxSorter::next(const char **key, Rid *rid) {
+    if (cursor_ == nullptr) {
+        cursor_ = std::make_unique<Cursor>(std::move(partition(1)[0]));
+    }
+    return cursor_->next(key, rid);
+}
+
+/**
+ * @brief 读取run中从pos开始的n个键值对，临时文件用pread读取，多个线程可以同时读同一个run
+ */
+void IxSorter::read_entries(const Run &run, size_t pos, size_t n, char *dest) const {
+    if (run.file == nullptr) {
+        memcpy(dest, run.data.data() + pos * entry_len_, n * entry_len_);
+        return;
+    }
+    size_t len = n * entry_len_;
+    off_t offset = (off_t)(pos * entry_len_);
+    while (len > 0) {
+        ssize_t ret = pread(fileno(run.file), dest, len, offset);
+        if (ret <= 0) {
+            throw UnixError();
+        }
+        dest += ret;
+        len -= ret;
+        offset += ret;
+    }
+}
+
+/**
+ * @brief run中第一个不小于entry的键值对的下标
+ */
+size_t IxSorter::lower_bound(const Run &run, const char *entry) const {
+    std::vector<char> buf(entry_len_);
+    size_t lo = 0, hi = run.num_entries;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        read_entries(run, mid, 1, buf.data());
+        if (compare(buf.data(), entry) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+std::vector<IxSorter::Cursor> IxSorter::partition(size_t num_parts) {
+    num_parts = std::max<size_t>(num_parts, 1);
+    // bounds[i][j]为第j段在第i个run中的起始下标
+    std::vector<std::vector<size_t>> bounds(runs_.size(), std::vector<size_t>(num_parts + 1, 0));
+    for (size_t i = 0; i < runs_.size(); i++) {
+        bounds[i][num_parts] = runs_[i]->num_entries;
+    }
+    if (num_parts > 1) {
+        // 每个run按下标均匀取样本，排序后取num_parts分位点作为分界
+        const size_t samples_per_run = num_parts * 16;
+        std::vector<std::vector<char>> samples;
+        for (auto &run : runs_) {
+            size_t step = std::max<size_t>(1, run->num_entries / samples_per_run);
+            for (size_t pos = step / 2; pos < run->num_entries; pos += step) {
+                samples.emplace_back(entry_len_);
+                read_entries(*run, pos, 1, samples.back().data());
+            }
+        }
+        std::sort(samples.begin(), samples.end(),
+                  [this](const std::vector<char> &a, const std::vector<char> &b) { return compare(a.data(), b.data()) < 0; });
+        for (size_t j = 1; j < num_parts && !samples.empty(); j++) {
+            const char *splitter = samples[j * samples.size() / num_parts].data();
+            for (size_t i = 0; i < runs_.size(); i++) {
+                bounds[i][j] = std::max(bounds[i][j - 1], lower_bound(*runs_[i], splitter));
+            }
+        }
+    }
+
+    // 每个临时文件中的run每次读入一块，所有段的读缓冲区平分内存上限
+    size_t num_sources = std::max<size_t>(1, runs_.size() * num_parts);
+    size_t block_entries = std::max<size_t>(1, mem_limit_ / num_sources / entry_len_);
+    std::vector<Cursor> cursors;
+    for (size_t j = 0; j < num_parts; j++) {
+        std::vector<Cursor::Source> sources;
+        for (size_t i = 0; i < runs_.size(); i++) {
+            if (bounds[i][j] < bounds[i][j + 1]) {
+                sources.push_back(Cursor::Source{.run = runs_[i].get(), .pos = bounds[i][j], .end = bounds[i][j + 1]});
+            }
+        }
+        cursors.push_back(Cursor(this, std::move(sources), block_entries));
+    }
+    return cursors;
+}
+
+IxSorter::Cursor::Cursor(const IxSorter *sorter, std::vector<Source> sources, size_t block_entries)
+    : sorter_(sorter), sources_(std::move(sources)), block_entries_(block_entries) {
+    for (auto &src : sources_) {
+        size_ += src.end - src.pos;
+    }
+}
+
+/**
+ * @brief source前进到下一个键值对，第一次调用时定位到第一个键值对
+ * @return source是否还有键值对
+ */
+bool IxSorter::Cursor::advance(Source &src) {
+    if (src.cur != nullptr) {
+        src.pos++;
+    }
+    if (src.pos >= src.end) {
+        return false;
+    }
+    if (src.run->file == nullptr) {
+        src.cur = src.run->data.data() + src.pos * sorter_->entry_len_;
+        return true;
+    }
+    // 当前块读完时读入下一块
+    if (src.cur == nullptr || src.pos == src.block_end) {
+        size_t n = std::min(block_entries_, src.end - src.pos);
+        src.block.resize(n * sorter_->entry_len_);
+        sorter_->read_entries(*src.run, src.pos, n, src.block.data());
+        src.block_end = src.pos + n;
+        src.cur = src.block.data();
+    } else {
+        src.cur += sorter_->entry_len_;
+    }
+    return true;
+}
+
+/**
+ * @brief 堆的比较函数：source a当前的键值对是否大于source b当前的键值对
+ */
+bool IxSorter::Cursor::greater(size_t a, size_t b) const {
+    return sorter_->compare(sources_[a].cur, sources_[b].cur) > 0;
+}
+
+bool IxSorter::Cursor::next(const char **key, Rid *rid) {
+    auto greater = [this](size_t a, size_t b) { return this->greater(a, b); };
+    if (!started_) {
+        started_ = true;
+        for (size_t i = 0; i < sources_.size(); i++) {
+            if (advance(sources_[i])) {
+                heap_.push_back(i);
+            }
+        }
+        std::make_heap(heap_.begin(), heap_.end(), greater);
+    }
+    // 上一次返回的键值对在这次调用之前一直有效，现在才让它所在的source前进
+    if (last_ != SIZE_MAX) {
+        if (advance(sources_[last_])) {
+            heap_.push_back(last_);
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        }
+        last_ = SIZE_MAX;
+    }
+    if (heap_.empty()) {
+        return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    last_ = heap_.back();
+    heap_.pop_back();
+    *key = sources_[last_].cur;
+    memcpy(rid, sources_[last_].cur + sorter_->key_len_, sizeof(Rid));
+    return true;
+}
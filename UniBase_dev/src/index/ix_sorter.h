@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "ix_defs.h"
+
+/* 建索引时对(key, rid)排序
+ * 键值对先放在内存中，超过内存上限时排好序写入一个临时文件成为一个有序段(run)，finish时剩下的键值对排好序留在内存中；
+ * 之后对所有run做多路归并，数据量不超过内存上限时只有一个内存中的run，不写文件
+ * 多个线程可以各自用一个排序器生成run，再由一个排序器absorb之后统一归并；
+ * partition把归并按key的范围切分成互不相交的几段，每段可以由一个线程独立归并
+ * 相同的key按rid排序，保证结果确定 */
+class IxSorter {
+    /* 一个有序段，在临时文件中或者在内存中，可以按下标随机读取 */
+    struct Run {
+        std::FILE *file = nullptr;      // 为nullptr时数据在data中
+        std::vector<char> data;
+        size_t num_entries = 0;
+
+        ~Run() {
+            if (file != nullptr) {
+                std::fclose(file);
+            }
+        }
+    };
+
+   public:
+    /* 按顺序归并若干个run中的一段键值对 */
+    class Cursor {
+        friend class IxSorter;
+
+       public:
+        /**
+         * @brief 按顺序取出下一个键值对
+         * @param key 传出参数，指向内部的缓冲区，下一次调用next之前有效
+         * @return 是否还有键值对
+         */
+        bool next(const char **key, Rid *rid);
+
+        /* 这一段键值对的总数 */
+        size_t size() const { return size_; }
+
+       private:
+        /* 一个run中的[pos, end)，临时文件中的run每次读入一块 */
+        struct Source {
+            const Run *run;
+            size_t pos;
+            size_t end;
+            const char *cur = nullptr;      // 当前键值对
+            std::vector<char> block;
+            size_t block_end = 0;           // block中最后一个键值对之后的下标
+        };
+
+        Cursor(const IxSorter *sorter, std::vector<Source> sources, size_t block_entries);
+
+        bool advance(Source &src);
+
+        bool greater(size_t a, size_t b) const;
+
+        const IxSorter *sorter_;
+        std::vector<Source> sources_;
+        size_t block_entries_;
+        size_t size_ = 0;
+        std::vector<size_t> heap_;          // 小根堆，元素为source的下标
+        size_t last_ = SIZE_MAX;            // 上一次next返回的键值对所在的source，下一次next时才前进
+        bool started_ = false;
+    };
+
+    IxSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens, size_t mem_limit = IX_SORT_MEMORY);
+
+    IxSorter(const IxSorter &) = delete;
+
+    IxSorter &operator=(const IxSorter &) = delete;
+
+    /* 加入一个键值对，key的长度为各字段长度之和 */
+    void add(const char *key, const Rid &rid);
+
+    /* 把另一个已经finish的排序器中的run移到当前排序器中，在当前排序器finish之前调用 */
+    void absorb(IxSorter &other);
+
+    /* 加入完毕，之后才能调用next和partition */
+    void finish();
+
+    /* 按顺序取出下一个键值对，参见Cursor::next */
+    bool next(const char **key, Rid *rid);
+
+    /**
+     * @brief 按key的范围把全部键值对切分成num_parts段，每段按顺序归并，段与段之间也有序
+     * 分界点从各个run中均匀采样得到，某一段可能为空
+     * @return 各段的Cursor，可以由不同的线程同时使用
+     */
+    std::vector<Cursor> partition(size_t num_parts);
+
+    /* 加入的键值对总数 */
+    size_t size() const { return num_entries_; }
+
+    /* run的个数，用于测试 */
+    size_t num_runs() const { return runs_.size(); }
+
+   private:
+    int compare(const char *a, const char *b) const;
+
+    std::unique_ptr<Run> sort_buffer();
+
+    void spill();
+
+    void read_entries(const Run &run, size_t pos, size_t n, char *dest) const;
+
+    size_t lower_bound(const Run &run, const char *entry) const;
+
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+    int key_len_;
+    int entry_len_;                     // key_len + sizeof(Rid)
+    size_t mem_limit_;
+    size_t num_entries_ = 0;
+
+    std::vector<char> buf_;             // 内存中还没有成为run的键值对
+    std::vector<std::unique_ptr<Run>> runs_;
+    std::unique_ptr<Cursor> cursor_;    // next使用的全局归并，第一次调用next时创建
+};
@@ -18,6 +18,7 @@ typedef enum PlanTag{
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
+    T_VacuumTable,
     T_Insert,
     T_Update,
     T_Delete,
@@ -28,6 +29,8 @@ typedef enum PlanTag{
     T_Transaction_rollback,
     T_SeqScan,
     T_IndexScan,
+    T_IndexOnlyScan,
+    T_HashIndexScan,
     T_NestLoop,
     T_Sort,
     T_Projection
@@ -64,6 +67,9 @@ class ScanPlan : public Plan
         size_t len_;                               
         std::vector<Condition> fed_conds_;
         std::vector<std::string> index_col_names_;
+        // 顺序扫描的并行参数，含义同SeqScanExecutor的构造参数
+        size_t num_workers_ = 0;
+        bool keep_order_ = true;
     
 };
 
@@ -127,7 +133,7 @@ class DMLPlan : public Plan
 {
     public:
         DMLPlan(PlanTag tag, std::shared_ptr<Plan> subplan,std::string tab_name,
-                std::vector<Value> values, std::vector<Condition> conds,
+                std::vector<std::vector<Value>> values, std::vector<Condition> conds,
                 std::vector<SetClause> set_clauses)
         {
             Plan::tag = tag;
@@ -140,7 +146,7 @@ class DMLPlan : public Plan
         ~DMLPlan(){}
         std::shared_ptr<Plan> subplan_;
         std::string tab_name_;
-        std::vector<Value> values_;
+        std::vector<std::vector<Value>> values_;    // insert的各行数据
         std::vector<Condition> conds_;
         std::vector<SetClause> set_clauses_;
 };
@@ -149,17 +155,23 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                RmStorageType storage_type = RM_STORAGE_FIXED)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            storage_type_ = storage_type;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        RmStorageType storage_type_;    // CREATE TABLE指定的页面组织方式
+        bool unique_index_ = true;      // CREATE INDEX建立的是否为唯一索引
+        std::vector<std::string> include_col_names_;    // CREATE INDEX的INCLUDE字段
+        IndexType index_type_ = INDEX_BTREE;            // CREATE INDEX的USING子句指定的索引类型
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -12,16 +12,67 @@
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
+// 索引匹配规则：从索引的第一个字段开始，连续若干字段上有与常量的等值条件，之后可以再有一个字段上有<、<=、>、>=条件；
+// 等值字段记2分、范围字段记1分，选得分最高的索引，不会自动调整where条件的顺序
 bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
     index_col_names.clear();
+    TabMeta& tab = sm_manager_->db_.get_table(tab_name);
+    int best_score = 0;
+    for(auto& index: tab.indexes) {
+        int score = 0;
+        for(size_t i = 0; i < index.key_num(); i++) {
+            auto& col = index.cols[i];
+            bool has_eq = false, has_range = false;
+            for(auto& cond: curr_conds) {
+                // 字典编码字段的范围条件要解码后比较，编码的顺序与字符串的顺序无关，不能用索引
+                if(!cond.is_rhs_val || cond.op == OP_NE || cond.lhs_dict != nullptr ||
+                   cond.lhs_col.tab_name.compare(tab_name) != 0 || cond.lhs_col.col_name.compare(col.name) != 0)
+                    continue;
+                if(cond.op == OP_EQ) has_eq = true;
+                else has_range = true;
+            }
+            if(has_eq) {
+                score += 2;
+                continue;
+            }
+            if(has_range) score += 1;
+            break;
+        }
+        // 哈希索引只能用于全部key字段上的等值查找，这时一次查找只读一个桶，比同样匹配的B+树更好
+        if(index.type == INDEX_HASH) {
+            score = score == 2 * (int)index.key_num() ? score + 1 : 0;
+        }
+        if(score > best_score) {
+            best_score = score;
+            index_col_names.clear();
+            for(size_t i = 0; i < index.key_num(); i++) index_col_names.push_back(index.cols[i].name);
+        }
+    }
+    return best_score > 0;
+}
+
+// get_index_cols选出的索引对应的扫描方式：哈希索引只做等值查找，B+树索引按范围扫描
+PlanTag Planner::get_index_scan_tag(const std::string& tab_name, const std::vector<std::string>& index_col_names) {
+    auto& index = *sm_manager_->db_.get_table(tab_name).get_index_meta(index_col_names);
+    return index.type == INDEX_HASH ? T_HashIndexScan : T_IndexScan;
+}
+
+// 单表查询的投影列、where条件和order by用到的字段都在索引的键字段或INCLUDE字段中时，可以只读索引
+bool Planner::is_covering_index(std::shared_ptr<Query> query, const std::vector<Condition>& curr_conds, const IndexMeta& index) {
+    auto in_index = [&](const std::string& col_name) {
+        return std::any_of(index.cols.begin(), index.cols.end(),
+                           [&](const ColMeta& col) { return col.name.compare(col_name) == 0; });
+    };
+    for(auto& col: query->cols) {
+        if(!in_index(col.col_name)) return false;
+    }
     for(auto& cond: curr_conds) {
-        if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
-            index_col_names.push_back(cond.lhs_col.col_name);
+        if(!in_index(cond.lhs_col.col_name)) return false;
+        if(!cond.is_rhs_val && !in_index(cond.rhs_col.col_name)) return false;
     }
-    TabMeta& tab = sm_manager_->db_.get_table(tab_name);
-    if(tab.is_index(index_col_names)) return true;
-    return false;
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if(x != nullptr && x->has_sort && !in_index(x->order->cols->col_name)) return false;
+    return true;
 }
 
 /**
@@ -145,8 +196,13 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             table_scan_executors[i] = 
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
         } else {  // 存在索引
+            auto& index = *sm_manager_->db_.get_table(tables[i]).get_index_meta(index_col_names);
+            PlanTag tag = get_index_scan_tag(tables[i], index_col_names);
+            if (tag == T_IndexScan && tables.size() == 1 && is_covering_index(query, curr_conds, index)) {
+                tag = T_IndexOnlyScan;
+            }
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(tag, sm_manager_, tables[i], curr_conds, index_col_names);
         }
     }
     // 只有一个表，不需要join。
@@ -234,10 +290,28 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
         }
     }
 
+    set_scan_parallelism(table_join_executors, false);
     return table_join_executors;
 
 }
 
+/**
+ * @brief 嵌套循环连接的右子树对左边的每条记录都要重新扫描一遍，其中的顺序扫描不启动工作线程
+ *
+ * @param plan 要处理的计划
+ * @param inner plan是否位于某个连接的右子树中
+ */
+void Planner::set_scan_parallelism(const std::shared_ptr<Plan> &plan, bool inner) {
+    if (auto x = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        if (inner) {
+            x->num_workers_ = 1;
+        }
+    } else if (auto x = std::dynamic_pointer_cast<JoinPlan>(plan)) {
+        set_scan_parallelism(x->left_, inner);
+        set_scan_parallelism(x->right_, true);
+    }
+}
+
 
 std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan)
 {
@@ -293,19 +367,28 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
             if (auto sv_col_def = std::dynamic_pointer_cast<ast::ColDef>(field)) {
                 ColDef col_def = {.name = sv_col_def->col_name,
                                   .type = interp_sv_type(sv_col_def->type_len->type),
-                                  .len = sv_col_def->type_len->len};
+                                  .len = sv_col_def->type_len->len,
+                                  .dict = sv_col_def->type_len->dict};
                 col_defs.push_back(col_def);
             } else {
                 throw InternalError("Unexpected field type");
             }
         }
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs);
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateTable, x->tab_name, std::vector<std::string>(), col_defs,
+                                                interp_storage_type(x->storage));
     } else if (auto x = std::dynamic_pointer_cast<ast::DropTable>(query->parse)) {
         // drop table;
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::VacuumTable>(query->parse)) {
+        // vacuum table;
+        plannerRoot = std::make_shared<DDLPlan>(T_VacuumTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        auto plan = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        plan->unique_index_ = x->unique;
+        plan->include_col_names_ = x->include_col_names;
+        plan->index_type_ = interp_index_type(x->index_type);
+        plannerRoot = plan;
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
@@ -324,15 +407,17 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
         
         if (index_exist == false) {  // 该表没有索引
             index_col_names.clear();
-            table_scan_executors = 
-                std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            auto seq_scan = std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            // 要删除的记录先全部收集起来，顺序无关紧要
+            seq_scan->keep_order_ = false;
+            table_scan_executors = seq_scan;
         } else {  // 存在索引
-            table_scan_executors =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            table_scan_executors = std::make_shared<ScanPlan>(get_index_scan_tag(x->tab_name, index_col_names), sm_manager_,
+                                                              x->tab_name, query->conds, index_col_names);
         }
 
         plannerRoot = std::make_shared<DMLPlan>(T_Delete, table_scan_executors, x->tab_name,  
-                                                std::vector<Value>(), query->conds, std::vector<SetClause>());
+                                                std::vector<std::vector<Value>>(), query->conds, std::vector<SetClause>());
     } else if (auto x = std::dynamic_pointer_cast<ast::UpdateStmt>(query->parse)) {
         // update;
         // 生成表扫描方式
@@ -344,21 +429,23 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
 
         if (index_exist == false) {  // 该表没有索引
         index_col_names.clear();
-            table_scan_executors = 
-                std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            auto seq_scan = std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            // 要更新的记录先全部收集起来，顺序无关紧要
+            seq_scan->keep_order_ = false;
+            table_scan_executors = seq_scan;
         } else {  // 存在索引
-            table_scan_executors =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, x->tab_name, query->conds, index_col_names);
+            table_scan_executors = std::make_shared<ScanPlan>(get_index_scan_tag(x->tab_name, index_col_names), sm_manager_,
+                                                              x->tab_name, query->conds, index_col_names);
         }
         plannerRoot = std::make_shared<DMLPlan>(T_Update, table_scan_executors, x->tab_name,
-                                                     std::vector<Value>(), query->conds, 
+                                                     std::vector<std::vector<Value>>(), query->conds, 
                                                      query->set_clauses);
     } else if (auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse)) {
 
         std::shared_ptr<plannerInfo> root = std::make_shared<plannerInfo>(x);
         // 生成select语句的查询执行计划
         std::shared_ptr<Plan> projection = generate_select_plan(std::move(query), context);
-        plannerRoot = std::make_shared<DMLPlan>(T_select, projection, std::string(), std::vector<Value>(),
+        plannerRoot = std::make_shared<DMLPlan>(T_select, projection, std::string(), std::vector<std::vector<Value>>(),
                                                     std::vector<Condition>(), std::vector<SetClause>());
     } else {
         throw InternalError("Unexpected AST root");
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -32,6 +33,8 @@ class Planner {
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
+    void set_scan_parallelism(const std::shared_ptr<Plan> &plan, bool inner);
+
     std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
@@ -40,9 +43,37 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
 
+    PlanTag get_index_scan_tag(const std::string& tab_name, const std::vector<std::string>& index_col_names);
+
+    bool is_covering_index(std::shared_ptr<Query> query, const std::vector<Condition>& curr_conds, const IndexMeta& index);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
             {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}};
         return m.at(sv_type);
     }
+
+    RmStorageType interp_storage_type(const std::string &storage) {
+        std::string name = storage;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::map<std::string, RmStorageType> m = {
+            {"", RM_STORAGE_FIXED}, {"fixed", RM_STORAGE_FIXED}, {"slotted", RM_STORAGE_SLOTTED},
+            {"pax", RM_STORAGE_PAX}};
+        auto pos = m.find(name);
+        if (pos == m.end()) {
+            throw InvalidStorageTypeError(storage);
+        }
+        return pos->second;
+    }
+
+    IndexType interp_index_type(const std::string &type) {
+        std::string name = type;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::map<std::string, IndexType> m = {{"", INDEX_BTREE}, {"btree", INDEX_BTREE}, {"hash", INDEX_HASH}};
+        auto pos = m.find(name);
+        if (pos == m.end()) {
+            throw InvalidIndexTypeError(type);
+        }
+        return pos->second;
+    }
 };
@@ -49,8 +49,9 @@ struct TxnRollback : public TreeNode {
 struct TypeLen : public TreeNode {
     SvType type;
     int len;
+    bool dict;  // CHAR字段是否做字典编码
 
-    TypeLen(SvType type_, int len_) : type(type_), len(len_) {}
+    TypeLen(SvType type_, int len_, bool dict_ = false) : type(type_), len(len_), dict(dict_) {}
 };
 
 struct Field : public TreeNode {
@@ -67,9 +68,10 @@ struct ColDef : public Field {
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    std::string storage;    // USING子句指定的页面组织方式，为空表示默认格式
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, std::string storage_ = "") :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), storage(std::move(storage_)) {}
 };
 
 struct DropTable : public TreeNode {
@@ -84,12 +86,23 @@ struct DescTable : public TreeNode {
     DescTable(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
 };
 
+struct VacuumTable : public TreeNode {
+    std::string tab_name;
+
+    VacuumTable(std::string tab_name_) : tab_name(std::move(tab_name_)) {}
+};
+
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    bool unique;  // CREATE NONUNIQUE INDEX建立非唯一索引
+    std::vector<std::string> include_col_names;  // INCLUDE (...)中的字段
+    std::string index_type;     // USING子句指定的索引类型，为空表示B+树
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, bool unique_ = true,
+                std::vector<std::string> include_col_names_ = {}, std::string index_type_ = "") :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), unique(unique_),
+            include_col_names(std::move(include_col_names_)), index_type(std::move(index_type_)) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -159,10 +172,10 @@ struct OrderBy : public TreeNode
 
 struct InsertStmt : public TreeNode {
     std::string tab_name;
-    std::vector<std::shared_ptr<Value>> vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> rows;  // VALUES后的每个括号是一行
 
-    InsertStmt(std::string tab_name_, std::vector<std::shared_ptr<Value>> vals_) :
-            tab_name(std::move(tab_name_)), vals(std::move(vals_)) {}
+    InsertStmt(std::string tab_name_, std::vector<std::vector<std::shared_ptr<Value>>> rows_) :
+            tab_name(std::move(tab_name_)), rows(std::move(rows_)) {}
 };
 
 struct DeleteStmt : public TreeNode {
@@ -237,6 +250,7 @@ struct SemValue {
 
     std::shared_ptr<Value> sv_val;
     std::vector<std::shared_ptr<Value>> sv_vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> sv_val_rows;
 
     std::shared_ptr<Col> sv_col;
     std::vector<std::shared_ptr<Col>> sv_cols;
@@ -74,18 +74,35 @@ private:
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
             print_node_list(x->fields, offset);
+            if (!x->storage.empty()) {
+                print_val(x->storage, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropTable>(node)) {
             std::cout << "DROP_TABLE\n";
             print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<DescTable>(node)) {
             std::cout << "DESC_TABLE\n";
             print_val(x->tab_name, offset);
+        } else if (auto x = std::dynamic_pointer_cast<VacuumTable>(node)) {
+            std::cout << "VACUUM_TABLE\n";
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateIndex>(node)) {
             std::cout << "CREATE_INDEX\n";
             print_val(x->tab_name, offset);
             // print_val(x->col_name, offset);
             for(auto col_name: x->col_names)
                 print_val(col_name, offset);
+            if (!x->unique) {
+                print_val(std::string("NONUNIQUE"), offset);
+            }
+            if (!x->include_col_names.empty()) {
+                print_val(std::string("INCLUDE"), offset);
+                for(auto col_name: x->include_col_names)
+                    print_val(col_name, offset);
+            }
+            if (!x->index_type.empty()) {
+                print_val(x->index_type, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DropIndex>(node)) {
             std::cout << "DROP_INDEX\n";
             print_val(x->tab_name, offset);
@@ -104,6 +121,9 @@ private:
             std::cout << "TYPE_LEN\n";
             print_val(type2str(x->type), offset);
             print_val(x->len, offset);
+            if (x->dict) {
+                print_val(std::string("DICT"), offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<IntLit>(node)) {
             std::cout << "INT_LIT\n";
             print_val(x->val, offset);
@@ -125,7 +145,9 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<InsertStmt>(node)) {
             std::cout << "INSERT\n";
             print_val(x->tab_name, offset);
-            print_node_list(x->vals, offset);
+            for (auto &row : x->rows) {
+                print_node_list(row, offset);
+            }
         } else if (auto x = std::dynamic_pointer_cast<DeleteStmt>(node)) {
             std::cout << "DELETE\n";
             print_val(x->tab_name, offset);
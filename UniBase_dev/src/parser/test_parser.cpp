@@ -9,13 +9,20 @@ int main() {
         "show tables;",
         "desc tb;",
         "create table tb (a int, b float, c char(4));",
+        "create table tb (a int, b char(16) dict) using slotted;",
+        "vacuum tb;",
         "drop table tb;",
         "create index tb(a);",
         "create index tb(a, b, c);",
+        "create nonunique index tb(a);",
+        "create index tb(a, b) include (c, d);",
+        "create nonunique index tb(a) using hash;",
         "drop index tb(a, b, c);",
         "drop index tb(b);",
         "insert into tb values (1, 3.14, 'pi');",
+        "insert into tb values (1, 3.14, 'pi'), (2, 2.72, 'e');",
         "delete from tb where a = 1;",
+        "select * from tb where a between 1 and 10 and b = 2;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
         "select * from tb;",
         "select * from tb where x <> 2 and y >= 3. and z <= '123' and b < tb.a;",
@@ -22,7 +22,7 @@ using namespace ast;
 
 // keywords
 %token SHOW TABLES CREATE TABLE DROP DESC INSERT INTO VALUES DELETE FROM ASC ORDER BY
-WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY
+WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_COMMIT TXN_ABORT TXN_ROLLBACK ORDER_BY USING VACUUM DICT NONUNIQUE BETWEEN INCLUDE
 // non-keywords
 %token LEQ NEQ GEQ T_EOF
 
@@ -40,14 +40,15 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_expr> expr
 %type <sv_val> value
 %type <sv_vals> valueList
-%type <sv_str> tbName colName
-%type <sv_strs> tableList colNameList
+%type <sv_val_rows> valueRows
+%type <sv_str> tbName colName optUsingClause
+%type <sv_strs> tableList colNameList optIncludeClause
 %type <sv_col> col
 %type <sv_cols> colList selector
 %type <sv_set_clause> setClause
 %type <sv_set_clauses> setClauses
 %type <sv_cond> condition
-%type <sv_conds> whereClause optWhereClause
+%type <sv_conds> conditions whereClause optWhereClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
 
@@ -113,6 +114,10 @@ ddl:
     {
         $$ = std::make_shared<CreateTable>($3, $5);
     }
+    |   CREATE TABLE tbName '(' fieldList ')' USING IDENTIFIER
+    {
+        $$ = std::make_shared<CreateTable>($3, $5, $8);
+    }
     |   DROP TABLE tbName
     {
         $$ = std::make_shared<DropTable>($3);
@@ -121,9 +126,17 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   VACUUM tbName
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<VacuumTable>($2);
+    }
+    |   CREATE INDEX tbName '(' colNameList ')' optIncludeClause optUsingClause
+    {
+        $$ = std::make_shared<CreateIndex>($3, $5, true, $7, $8);
+    }
+    |   CREATE NONUNIQUE INDEX tbName '(' colNameList ')' optIncludeClause optUsingClause
+    {
+        $$ = std::make_shared<CreateIndex>($4, $6, false, $8, $9);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
@@ -132,9 +145,9 @@ ddl:
     ;
 
 dml:
-        INSERT INTO tbName VALUES '(' valueList ')'
+        INSERT INTO tbName VALUES valueRows
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        $$ = std::make_shared<InsertStmt>($3, $5);
     }
     |   DELETE FROM tbName optWhereClause
     {
@@ -188,12 +201,27 @@ type:
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3);
     }
+    |   CHAR '(' VALUE_INT ')' DICT
+    {
+        $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3, true);
+    }
     |   FLOAT
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
     ;
 
+valueRows:
+        '(' valueList ')'
+    {
+        $$ = std::vector<std::vector<std::shared_ptr<Value>>>{$2};
+    }
+    |   valueRows ',' '(' valueList ')'
+    {
+        $$.push_back($4);
+    }
+    ;
+
 valueList:
         value
     {
@@ -227,6 +255,22 @@ condition:
     }
     ;
 
+optIncludeClause:
+        /* epsilon */ { /* ignore*/ }
+    |   INCLUDE '(' colNameList ')'
+    {
+        $$ = $3;
+    }
+    ;
+
+optUsingClause:
+        /* epsilon */ { $$ = ""; }
+    |   USING IDENTIFIER
+    {
+        $$ = $2;
+    }
+    ;
+
 optWhereClause:
         /* epsilon */ { /* ignore*/ }
     |   WHERE whereClause
@@ -235,14 +279,26 @@ optWhereClause:
     }
     ;
 
-whereClause:
-        condition 
+conditions:
+        condition
     {
         $$ = std::vector<std::shared_ptr<BinaryExpr>>{$1};
     }
-    |   whereClause AND condition
+    |   col BETWEEN value AND value
     {
-        $$.push_back($3);
+        $$ = std::vector<std::shared_ptr<BinaryExpr>>{std::make_shared<BinaryExpr>($1, SV_OP_GE, $3),
+                                                      std::make_shared<BinaryExpr>($1, SV_OP_LE, $5)};
+    }
+    ;
+
+whereClause:
+        conditions
+    {
+        $$ = $1;
+    }
+    |   whereClause AND conditions
+    {
+        $$.insert($$.end(), $3.begin(), $3.end());
     }
     ;
 
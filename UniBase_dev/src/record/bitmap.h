@@ -3,6 +3,10 @@
 #include <cinttypes>
 #include <cstring>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 static constexpr int BITMAP_WIDTH = 8;
 static constexpr unsigned BITMAP_HIGHEST_BIT = 0x80u;  // 128 (2^7)
 
@@ -27,12 +31,34 @@ class Bitmap {
      * @param max_n 要找的从起始地址开始的偏移为[curr+1,max_n)
      * @param curr 要找的从起始地址开始的偏移为[curr+1,max_n)
      * @return 找到了就返回偏移位置，没找到就返回max_n
+     * @note 每次处理64位：按大端序装入一个uint64_t，使bitmap中的第0位对应字的最高位，再用clz定位；
+     *       支持SSE2时先按16字节跳过全0（找1）或全1（找0）的区域
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        int pos = curr + 1;
+        while (pos < max_n) {
+            int byte_idx = get_bucket(pos);
+#ifdef __SSE2__
+            if (pos % BITMAP_WIDTH == 0) {
+                byte_idx = skip_blocks(bit, bm, byte_idx, num_bytes);
+                if (byte_idx >= num_bytes) {
+                    break;
+                }
+                pos = byte_idx * BITMAP_WIDTH;
+            }
+#endif
+            uint64_t word = load_word(bm, byte_idx, num_bytes);
+            if (!bit) {
+                word = ~word;
+            }
+            // 屏蔽掉pos之前的位（pos在当前字中的偏移一定小于8）
+            word &= ~0ULL >> (pos - byte_idx * BITMAP_WIDTH);
+            if (word != 0) {
+                int found = byte_idx * BITMAP_WIDTH + __builtin_clzll(word);
+                return found < max_n ? found : max_n;
             }
+            pos = (byte_idx + WORD_BYTES) * BITMAP_WIDTH;
         }
         return max_n;
     }
@@ -40,12 +66,80 @@ class Bitmap {
     // 找第一个为0 or 1的位
     static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
 
+    // 统计[0,max_n)中为1的位数
+    static int count(const char *bm, int max_n) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        int cnt = 0;
+        for (int byte_idx = 0; byte_idx < num_bytes; byte_idx += WORD_BYTES) {
+            uint64_t word = load_word(bm, byte_idx, num_bytes);
+            int valid = max_n - byte_idx * BITMAP_WIDTH;
+            if (valid < 64) {
+                word &= ~(~0ULL >> valid);
+            }
+            cnt += __builtin_popcountll(word);
+        }
+        return cnt;
+    }
+
+    /**
+     * @brief 按从小到大的顺序，对[0,max_n)中每个为1的位调用一次func(pos)
+     * @note 每个字只读取一次，用clz取出最高的1后清掉该位，适合一次性取出整个页面的所有记录
+     */
+    template <typename Func>
+    static void for_each_set_bit(const char *bm, int max_n, Func &&func) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        for (int byte_idx = 0; byte_idx < num_bytes; byte_idx += WORD_BYTES) {
+            uint64_t word = load_word(bm, byte_idx, num_bytes);
+            int base = byte_idx * BITMAP_WIDTH;
+            while (word != 0) {
+                int off = __builtin_clzll(word);
+                if (base + off >= max_n) {
+                    return;
+                }
+                func(base + off);
+                word &= ~(HIGHEST_WORD_BIT >> off);
+            }
+        }
+    }
+
     // for example:
     // rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
    private:
+    static constexpr int WORD_BYTES = sizeof(uint64_t);
+    static constexpr uint64_t HIGHEST_WORD_BIT = 1ULL << 63;
+
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
+
+    // 从第byte_idx个字节开始按大端序读取至多8个字节，不足8个字节时低位补0，不会越过num_bytes读取
+    static uint64_t load_word(const char *bm, int byte_idx, int num_bytes) {
+        uint64_t word = 0;
+        int n = num_bytes - byte_idx;
+        if (n >= WORD_BYTES) {
+            memcpy(&word, bm + byte_idx, WORD_BYTES);
+            return __builtin_bswap64(word);
+        }
+        for (int i = 0; i < n; i++) {
+            word |= static_cast<uint64_t>(static_cast<uint8_t>(bm[byte_idx + i])) << (56 - 8 * i);
+        }
+        return word;
+    }
+
+#ifdef __SSE2__
+    // 从byte_idx开始按16字节跳过不可能包含目标位的区域，返回第一个可能包含目标位的字节下标
+    static int skip_blocks(bool bit, const char *bm, int byte_idx, int num_bytes) {
+        const __m128i skip = bit ? _mm_setzero_si128() : _mm_set1_epi8(static_cast<char>(0xff));
+        while (byte_idx + 16 <= num_bytes) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bm + byte_idx));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, skip)) != 0xffff) {
+                break;
+            }
+            byte_idx += 16;
+        }
+        return byte_idx;
+    }
+#endif
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/arena.h"
 #include "defs.h"
 #include "storage/buffer_pool_manager.h"
 #include <iostream>
@@ -8,36 +9,76 @@ constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
 constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_MAX_SLOTTED_RECORD_SIZE = 2048;    // SLOTTED格式下单条记录（解码后）的最大长度
+constexpr int RM_MAX_COLS = 64;                     // 文件头中最多能记录的字段布局个数
+
+/* 表数据文件的页面组织方式，在建表时指定 */
+enum RmStorageType {
+    RM_STORAGE_FIXED,       // 定长槽位 + bitmap，记录按record_size原样存放
+    RM_STORAGE_SLOTTED,     // 槽目录 + 变长元组，CHAR字段去掉尾部填充后存放
+    RM_STORAGE_PAX          // 与FIXED槽位个数相同，页内按字段分成minipage，同一字段的值连续存放
+};
+
+/* 记录中一个字段的布局，SLOTTED格式按字段编码元组 */
+struct RmColHdr {
+    int offset;     // 字段在记录中的偏移
+    int len;        // 字段长度
+    bool trim;      // 是否为CHAR字段，存储时去掉尾部的'\0'填充
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
     int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
     int bitmap_size;            // 每个页面bitmap大小
+    RmStorageType storage_type;     // 页面组织方式
+    int num_cols;                   // cols中有效的字段个数，为0时把整条记录当作一个CHAR字段
+    RmColHdr cols[RM_MAX_COLS];     // 字段布局，SLOTTED格式据此编码元组，PAX格式据此划分minipage
 
     void print(){
         std::cout << "[  RmFileHdr imformation  ]\n";
         std::cout << "record_size: " << record_size << "\n";
         std::cout << "num_pages: " << num_pages << "\n";
         std::cout << "num_records_per_page: " << num_records_per_page << "\n";
-        std::cout << "first_free_page_no: " << first_free_page_no << "\n";
-        std::cout << "bitmap_size: " << bitmap_size << "\n\n";
+        std::cout << "bitmap_size: " << bitmap_size << "\n";
+        std::cout << "storage_type: " << storage_type << "\n";
+        std::cout << "num_cols: " << num_cols << "\n\n";
     }
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
+/* SLOTTED格式的页面中，紧跟在bitmap之后的页头；其后是向后增长的槽目录，元组区从页尾向前增长 */
+struct RmSlottedPageHdr {
+    int num_slots;          // 槽目录中的槽个数（含空槽）
+    int free_end;           // 元组区的起始偏移，[槽目录末尾, free_end)为连续空闲空间
+    int frag_bytes;         // 元组区中因删除、缩短而产生的碎片字节数，整理页面后归零
+};
+
+/* 槽的状态。bitmap中只有NORMAL和FORWARD的槽被置1，MOVED元组只能通过其原位置的FORWARD槽访问 */
+enum RmSlotFlag : uint16_t {
+    RM_SLOT_EMPTY,          // 空槽，可复用
+    RM_SLOT_NORMAL,         // 存放编码后的元组
+    RM_SLOT_FORWARD,        // 元组更新后在本页放不下，槽中存放元组新位置的Rid
+    RM_SLOT_MOVED           // 从其他页面迁移过来的元组
+};
+
+/* 槽目录项 */
+struct RmSlot {
+    uint16_t offset;        // 元组在页面中的偏移
+    uint16_t len;           // 元组长度
+    uint16_t flag;          // RmSlotFlag
+};
+
 /* 表中的记录 */
 struct RmRecord {
-    char* data;  // 记录的数据
-    int size;    // 记录的大小
-    bool allocated_ = false;    // 是否已经为数据分配空间
+    char* data = nullptr;  // 记录的数据
+    int size = 0;          // 记录的大小
+    bool allocated_ = false;  // data是否由RmRecord自己new出来，需要在析构时释放；来自arena的数据不单独释放
 
     RmRecord() = default;
 
@@ -49,10 +90,19 @@ struct RmRecord {
     };
 
     RmRecord &operator=(const RmRecord& other) {
+        if (this == &other) {
+            return *this;
+        }
+        // 长度相同时直接复用原有的缓冲区（包括来自arena的缓冲区）
+        if (data == nullptr || size != other.size) {
+            if (allocated_) {
+                delete[] data;
+            }
+            data = new char[other.size];
+            allocated_ = true;
+        }
         size = other.size;
-        data = new char[size];
         memcpy(data, other.data, size);
-        allocated_ = true;
         return *this;
     };
 
@@ -69,6 +119,15 @@ struct RmRecord {
         allocated_ = true;
     }
 
+    /* 数据缓冲区从语句的arena中分配，随语句结束一次性释放 */
+    RmRecord(int size_, Arena* arena) {
+        size = size_;
+        data = arena->allocate(size_);
+        allocated_ = false;
+    }
+
+    RmRecord(int size_, const char* data_, Arena* arena) : RmRecord(size_, arena) { memcpy(data, data_, size_); }
+
     void SetData(char* data_) {
         memcpy(data, data_, size);
     }
@@ -79,6 +138,7 @@ struct RmRecord {
             delete[] data;
         }
         data = new char[size];
+        allocated_ = true;
         memcpy(data, data_ + sizeof(int), size);
     }
 
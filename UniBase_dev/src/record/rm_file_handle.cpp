@@ -1,5 +1,7 @@
 #include "rm_file_handle.h"
 
+#include <algorithm>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -12,12 +14,23 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     auto lockDataId = LockDataId(fd_, rid, LockDataType::RECORD);
 
     auto pageHandle = fetch_page_handle(rid.page_no);
-    auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    pageHandle.page->rlatch();
     if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+        pageHandle.page->runlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
+        if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
+            context->lock_mgr_->unlock(context->txn_, lockDataId);
+        }
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    memcpy(record->data, pageHandle.get_slot(rid.slot_no), file_hdr_.record_size);
-    record->size = file_hdr_.record_size;
+    auto record = std::make_unique<RmRecord>(file_hdr_.record_size);
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        read_slotted_tuple(pageHandle, rid.slot_no, record->data);
+    } else {
+        pageHandle.read_record(rid.slot_no, record->data);
+    }
+    pageHandle.page->runlatch();
+    buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
 
     // 解S锁
     if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
@@ -26,6 +39,54 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     return record;
 }
 
+/**
+ * @description: 获取当前表中记录号为rid的记录的只读视图，FIXED格式下不拷贝记录
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {Context*} context
+ * @param {RmRecordView*} view 要填充的视图，原先持有的页面会先被释放
+ * @note FIXED格式下返回后页面保持pin住并持有读锁，直到view->release()或view析构
+ */
+void RmFileHandle::get_record_view(const Rid& rid, Context* context, RmRecordView* view) const {
+    view->release();
+
+    // 上S锁
+    context->lock_mgr_->lock_shared_on_record(context->txn_, rid, fd_);
+    auto lockDataId = LockDataId(fd_, rid, LockDataType::RECORD);
+
+    auto pageHandle = fetch_page_handle(rid.page_no);
+    pageHandle.page->rlatch();
+    if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+        pageHandle.page->runlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
+        if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
+            context->lock_mgr_->unlock(context->txn_, lockDataId);
+        }
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    view->size_ = file_hdr_.record_size;
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED || pageHandle.is_pax()) {
+        // 记录在页面中不是连续存放的，拼到视图的缓冲区中
+        view->buf_.resize(file_hdr_.record_size);
+        if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+            read_slotted_tuple(pageHandle, rid.slot_no, view->buf_.data());
+        } else {
+            pageHandle.read_record(rid.slot_no, view->buf_.data());
+        }
+        pageHandle.page->runlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
+        view->data_ = view->buf_.data();
+    } else {
+        view->buffer_pool_manager_ = buffer_pool_manager_;
+        view->page_ = pageHandle.page;
+        view->data_ = pageHandle.get_slot(rid.slot_no);
+    }
+
+    // 解S锁
+    if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
+        context->lock_mgr_->unlock(context->txn_, lockDataId);
+    }
+}
+
 /**
  * @description: 在当前表中插入一条记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
@@ -33,25 +94,206 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
  * @return {Rid} 插入的记录的记录号（位置）
  */
 Rid RmFileHandle::insert_record(char* buf, Context* context) {
-    RmPageHandle pageHandle = create_page_handle();
-    int freeSlot = Bitmap::first_bit(false, pageHandle.bitmap, file_hdr_.num_records_per_page);
-    auto rid = Rid{pageHandle.page->get_page_id().page_no, freeSlot};
+    context->lock_mgr_->lock_IX_on_table(context->txn_, fd_);
+    // 放置记录时先锁住槽位再在bitmap中置位
+    Rid rid;
+    place_record(buf, -1, &rid, context);
+
+    // 解X锁
+    release_write_locks(rid, context);
+    return rid;
+}
 
+/**
+ * @description: 把记录移动到end_page_no之前的页面中，供VACUUM腾空文件尾部的页面
+ * 先在新位置插入再删除原记录，期间持有原记录的X锁；找不到能放下的页面时不做任何修改
+ * @param {Rid&} rid 要移动的记录
+ * @param {int} end_page_no 新位置的页面号必须小于end_page_no
+ * @param {Context*} context
+ * @param {Rid*} new_rid 记录的新位置
+ * @param {unique_ptr<RmRecord>*} record 移动的记录，调用者据此修改索引
+ * @return {bool} 是否移动了记录；记录已被删除或前面的页面放不下时返回false
+ */
+bool RmFileHandle::relocate_record(const Rid& rid, int end_page_no, Context* context, Rid* new_rid,
+                                   std::unique_ptr<RmRecord>* record) {
     // 上X锁
+    context->lock_mgr_->lock_IX_on_table(context->txn_, fd_);
     context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
-    auto lockDataId = LockDataId(fd_, rid, LockDataType::RECORD);
+    bool unlock = context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED;
+
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    page_handle.page->rlatch();
+    bool exist = Bitmap::is_set(page_handle.bitmap, rid.slot_no);
+    if (exist) {
+        *record = std::make_unique<RmRecord>(file_hdr_.record_size);
+        if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+            read_slotted_tuple(page_handle, rid.slot_no, (*record)->data);
+        } else {
+            page_handle.read_record(rid.slot_no, (*record)->data);
+        }
+    }
+    page_handle.page->runlatch();
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
 
-    memcpy(pageHandle.get_slot(freeSlot), buf, file_hdr_.record_size);
-    Bitmap::set(pageHandle.bitmap, freeSlot);
-    if (++pageHandle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        file_hdr_.first_free_page_no = pageHandle.page_hdr->next_free_page_no;
+    // 新位置在放置记录时已加上X锁
+    bool moved = exist && place_record((*record)->data, end_page_no, new_rid, context);
+    if (moved && file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        delete_slotted_record(rid);
+    } else if (moved) {
+        page_handle = fetch_page_handle(rid.page_no);
+        page_handle.page->wlatch();
+        Bitmap::reset(page_handle.bitmap, rid.slot_no);
+        page_handle.page_hdr->num_records--;
+        update_free_space(page_handle);
+        page_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    }
+    if (moved && unlock) {
+        context->lock_mgr_->unlock(context->txn_, LockDataId(fd_, *new_rid, LockDataType::RECORD));
     }
 
     // 解X锁
+    release_write_locks(rid, context);
+    return moved;
+}
+
+/**
+ * @description: VACUUM腾空页面page_no时需要移动的记录：页面上的所有记录，
+ * 以及SLOTTED格式下元组已迁移到该页面上的记录（这些记录的rid在其他页面上，需要扫描全表的FORWARD槽找到）
+ * @param {int} page_no 页面号
+ */
+std::vector<Rid> RmFileHandle::get_relocation_rids(int page_no) const {
+    std::vector<Rid> rids;
+    RmPageHandle page_handle = fetch_page_handle(page_no);
+    page_handle.page->rlatch();
+    Bitmap::for_each_set_bit(page_handle.bitmap, file_hdr_.num_records_per_page,
+                             [&](int slot_no) { rids.push_back(Rid{page_no, slot_no}); });
+    bool has_moved = false;
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        RmSlottedPage slotted_page(page_handle);
+        for (int i = 0; i < slotted_page.hdr()->num_slots; i++) {
+            has_moved |= slotted_page.get_slot(i)->flag == RM_SLOT_MOVED;
+        }
+    }
+    page_handle.page->runlatch();
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    if (!has_moved) {
+        return rids;
+    }
+
+    for (int other = RM_FIRST_RECORD_PAGE; other < file_hdr_.num_pages; other++) {
+        if (other == page_no) {
+            continue;
+        }
+        RmPageHandle other_handle = fetch_page_handle(other);
+        other_handle.page->rlatch();
+        RmSlottedPage slotted_page(other_handle);
+        for (int i = 0; i < slotted_page.hdr()->num_slots; i++) {
+            if (slotted_page.get_slot(i)->flag != RM_SLOT_FORWARD) {
+                continue;
+            }
+            Rid target;
+            memcpy(&target, slotted_page.get_tuple(i), sizeof(Rid));
+            if (target.page_no == page_no) {
+                rids.push_back(Rid{other, i});
+            }
+        }
+        other_handle.page->runlatch();
+        buffer_pool_manager_->unpin_page(other_handle.page->get_page_id(), false);
+    }
+    return rids;
+}
+
+/**
+ * @description: 从文件末尾开始去掉连续的空页面并截断文件，期间持有表级X锁
+ * 写记录（表级IX锁）和顺序扫描（表级IS锁）都与之冲突，判断页面为空之后不会再有记录放进来；
+ * 不经过锁管理器的RmScan（如测试）另外由truncate_latch_的写锁挡住，正在扫描的页面被pin住，截断到它为止
+ * 页面仍被其他线程pin住时停止截断，留到下一次
+ * @param {Context*} context
+ * @return {int} 去掉的页面个数
+ */
+int RmFileHandle::truncate_empty_pages(Context* context) {
+    context->lock_mgr_->lock_exclusive_on_table(context->txn_, fd_);
+
+    std::unique_lock truncate_lock{truncate_latch_};
+    int num_pages = file_hdr_.num_pages;
+    while (num_pages > RM_FIRST_RECORD_PAGE) {
+        RmPageHandle page_handle = fetch_page_handle(num_pages - 1);
+        page_handle.page->rlatch();
+        bool empty = page_handle.page_hdr->num_records == 0;
+        if (empty && file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+            // 还有从其他页面迁移过来的元组
+            empty = RmSlottedPage(page_handle).hdr()->num_slots == 0;
+        }
+        page_handle.page->runlatch();
+        PageId page_id = page_handle.page->get_page_id();
+        buffer_pool_manager_->unpin_page(page_id, false);
+        if (!empty || !buffer_pool_manager_->delete_page(page_id)) {
+            break;
+        }
+        num_pages--;
+    }
+    int num_truncated = file_hdr_.num_pages - num_pages;
+    if (num_truncated > 0) {
+        file_hdr_.num_pages = num_pages;
+        fsm_.truncate(num_pages);
+        disk_manager_->truncate_file(fd_, num_pages);
+    }
+    truncate_lock.unlock();
+
     if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
-        context->lock_mgr_->unlock(context->txn_, lockDataId);
+        context->lock_mgr_->unlock(context->txn_, LockDataId(fd_, LockDataType::TABLE));
     }
-    return rid;
+    return num_truncated;
+}
+
+/**
+ * @description: 批量插入记录，每个页面只pin一次，并尽可能多地填入记录
+ * 整批加一次表级IX锁，同一页面上要用的槽位一次加上行级排他锁，加锁之后记录才在bitmap中置位
+ * @param {char*} bufs 连续存放的num_records条记录
+ * @param {int} num_records 记录条数
+ * @param {Context*} context
+ * @return {vector<Rid>} 各条记录插入的位置，与bufs中的顺序一致
+ */
+std::vector<Rid> RmFileHandle::insert_records(const char* bufs, int num_records, Context* context) {
+    context->lock_mgr_->lock_IX_on_table(context->txn_, fd_);
+
+    std::vector<Rid> rids;
+    rids.reserve(num_records);
+    int num_inserted = 0;
+    bool new_page = false;
+    int begin_page_no = -1;
+    while (num_inserted < num_records) {
+        size_t page_begin = rids.size();
+        const char* buf = bufs + (size_t)num_inserted * file_hdr_.record_size;
+        // 按下一条记录需要的空间找页面，找到的页面放不下时继续找
+        int need = record_need(buf);
+        RmPageHandle pageHandle = new_page ? create_new_page_handle() : create_page_handle(need, begin_page_no);
+        pageHandle.page->wlatch();
+        bool has_space = page_free_space(pageHandle) >= need;
+        if (has_space) {
+            num_inserted += fill_page(pageHandle, buf, num_records - num_inserted, &rids, context);
+            begin_page_no = -1;
+        } else {
+            begin_page_no = RmFreeSpaceMap::retry_from(begin_page_no, pageHandle.page->get_page_id().page_no);
+        }
+        update_free_space(pageHandle);
+        pageHandle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), rids.size() > page_begin);
+        // 页面放得下却一条都没有放入，说明空闲槽位都被其他事务锁住了，换一个新页面
+        new_page = has_space && rids.size() == page_begin;
+
+        // 解X锁
+        if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
+            std::vector<Rid> page_rids(rids.begin() + page_begin, rids.end());
+            context->lock_mgr_->unlock_records(context->txn_, page_rids, fd_);
+        }
+    }
+
+    if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
+        context->lock_mgr_->unlock(context->txn_, LockDataId(fd_, LockDataType::TABLE));
+    }
+    return rids;
 }
 
 /**
@@ -61,25 +303,34 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
  */
 void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // 上X锁
+    context->lock_mgr_->lock_IX_on_table(context->txn_, fd_);
     context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
-    auto lockDataId = LockDataId(fd_, rid, LockDataType::RECORD);
 
-    RmPageHandle pageHandle = fetch_page_handle(rid.page_no);
-    if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
-        throw PageNotExistError("", rid.page_no);
-    }
-    Bitmap::reset(pageHandle.bitmap, rid.slot_no);
-    if (pageHandle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        pageHandle.page_hdr->num_records--;
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        try {
+            delete_slotted_record(rid);
+        } catch (RecordNotFoundError &) {
+            release_write_locks(rid, context);
+            throw;
+        }
     } else {
-        return;
+        RmPageHandle pageHandle = fetch_page_handle(rid.page_no);
+        pageHandle.page->wlatch();
+        if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+            pageHandle.page->wunlatch();
+            buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
+            release_write_locks(rid, context);
+            throw PageNotExistError("", rid.page_no);
+        }
+        Bitmap::reset(pageHandle.bitmap, rid.slot_no);
+        pageHandle.page_hdr->num_records--;
+        update_free_space(pageHandle);
+        pageHandle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), true);
     }
-    release_page_handle(pageHandle);
 
     // 解X锁
-    if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
-        context->lock_mgr_->unlock(context->txn_, lockDataId);
-    }
+    release_write_locks(rid, context);
 }
 
 /**
@@ -90,19 +341,45 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
  */
 void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // 上X锁
+    context->lock_mgr_->lock_IX_on_table(context->txn_, fd_);
     context->lock_mgr_->lock_exclusive_on_record(context->txn_, rid, fd_);
-    auto lockDataId = LockDataId(fd_, rid, LockDataType::RECORD);
 
-    RmPageHandle pageHandle = fetch_page_handle(rid.page_no);
-    // 一定要记得更新bitmap
-    if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
-        throw PageNotExistError("", rid.page_no);
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        try {
+            update_slotted_record(rid, buf);
+        } catch (RecordNotFoundError &) {
+            release_write_locks(rid, context);
+            throw;
+        }
+    } else {
+        RmPageHandle pageHandle = fetch_page_handle(rid.page_no);
+        pageHandle.page->wlatch();
+        // 一定要记得更新bitmap
+        if (!Bitmap::is_set(pageHandle.bitmap, rid.slot_no)) {
+            pageHandle.page->wunlatch();
+            buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), false);
+            release_write_locks(rid, context);
+            throw PageNotExistError("", rid.page_no);
+        }
+        pageHandle.write_record(rid.slot_no, buf);
+        pageHandle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), true);
     }
-    memcpy(pageHandle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
 
     // 解X锁
+    release_write_locks(rid, context);
+}
+
+/**
+ * @description: 单条记录的写操作结束，隔离级别低于读已提交时释放记录的X锁和表级IX锁
+ * 写操作都先加表级IX锁，建索引（表级S锁）和VACUUM截断文件（表级X锁）期间不会有记录被修改
+ * @param {Rid&} rid 写的记录
+ * @param {Context*} context
+ */
+void RmFileHandle::release_write_locks(const Rid& rid, Context* context) {
     if (context->txn_->get_isolation_level() < IsolationLevel::READ_COMMITTED) {
-        context->lock_mgr_->unlock(context->txn_, lockDataId);
+        context->lock_mgr_->unlock(context->txn_, LockDataId(fd_, rid, LockDataType::RECORD));
+        context->lock_mgr_->unlock(context->txn_, LockDataId(fd_, LockDataType::TABLE));
     }
 }
 
@@ -134,11 +411,13 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
     Page* newPage = buffer_pool_manager_->new_page(&pageId);
     auto pageHangle = RmPageHandle(&file_hdr_, newPage);
     if (newPage != nullptr) {
-        RmPageHandle page_handle(&file_hdr_, newPage);
         pageHangle.page_hdr->num_records = 0;
-        pageHangle.page_hdr->next_free_page_no = RM_NO_PAGE;
         file_hdr_.num_pages++;
-        file_hdr_.first_free_page_no = pageId.page_no;
+        if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+            RmSlottedPage slotted_page(pageHangle);
+            slotted_page.init();
+        }
+        update_free_space(pageHangle);
     }
     return pageHangle;
 }
@@ -146,23 +425,379 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
 /**
  * @brief 创建或获取一个空闲的page handle
  *
+ * @param need 需要的空闲空间，FIXED格式为槽位个数，SLOTTED格式为元组占用的字节数
  * @return RmPageHandle 返回生成的空闲page handle
  * @note pin the page, remember to unpin it outside!
+ * 空闲空间映射只是提示，调用者加写锁后仍需检查页面能否放下
  */
-RmPageHandle RmFileHandle::create_page_handle() {
-    // Todo:
-    // 1. 判断file_hdr_中是否还有空闲页
-    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
-    if (this->file_hdr_.first_free_page_no == RM_NO_PAGE) {
+RmPageHandle RmFileHandle::create_page_handle(int need, int begin_page_no) {
+    int page_no = fsm_.find(need, -1, begin_page_no);
+    if (page_no == RM_NO_PAGE) {
         return create_new_page_handle();
     }
-    return fetch_page_handle(this->file_hdr_.first_free_page_no);
+    return fetch_page_handle(page_no);
+}
+
+/**
+ * @description: 页面当前的空闲空间，单位与create_page_handle的need一致
+ */
+int RmFileHandle::page_free_space(const RmPageHandle& page_handle) const {
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        return RmSlottedPage(page_handle).insert_space();
+    }
+    return file_hdr_.num_records_per_page - page_handle.page_hdr->num_records;
+}
+
+/**
+ * @description: 页面上插入、删除或更新记录之后，把页面的空闲空间写回空闲空间映射，调用者需持有页面的写锁
+ */
+void RmFileHandle::update_free_space(const RmPageHandle& page_handle) {
+    fsm_.update(page_handle.page->get_page_id().page_no, page_free_space(page_handle));
+}
+
+/**
+ * @description: 逐页读取页头重建空闲空间映射，在映射文件缺失或过期时由RmManager调用
+ */
+void RmFileHandle::rebuild_free_space_map() {
+    fsm_.clear(file_hdr_.num_pages);
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        RmPageHandle page_handle = fetch_page_handle(page_no);
+        page_handle.page->rlatch();
+        update_free_space(page_handle);
+        page_handle.page->runlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    }
+}
+
+/**
+ * @description: 解码SLOTTED格式页面中槽slot_no上的记录，FORWARD槽需要到元组的新位置读取
+ * @param {RmPageHandle&} page_handle 记录所在的页面，调用者已持有读锁
+ * @param {int} slot_no 槽号
+ * @param {char*} record 解码后的定长记录
+ */
+void RmFileHandle::read_slotted_tuple(const RmPageHandle& page_handle, int slot_no, char* record) const {
+    RmSlottedPage slotted_page(page_handle);
+    if (slotted_page.get_slot(slot_no)->flag != RM_SLOT_FORWARD) {
+        RmSlottedPage::decode(file_hdr_, slotted_page.get_tuple(slot_no), record);
+        return;
+    }
+    Rid target;
+    memcpy(&target, slotted_page.get_tuple(slot_no), sizeof(Rid));
+    RmPageHandle target_handle = fetch_page_handle(target.page_no);
+    target_handle.page->rlatch();
+    RmSlottedPage::decode(file_hdr_, RmSlottedPage(target_handle).get_tuple(target.slot_no), record);
+    target_handle.page->runlatch();
+    buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), false);
+}
+
+/**
+ * @description: 删除SLOTTED格式文件中记录号为rid的记录，元组已迁移时一并删除新位置上的元组
+ * @param {Rid&} rid 记录号
+ * @note 写操作任何时候只持有一个页面的写锁，避免两个页面之间的加锁顺序问题；rid上的X锁保证中间状态不被读到
+ */
+void RmFileHandle::delete_slotted_record(const Rid& rid) {
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    page_handle.page->wlatch();
+    if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        page_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    RmSlottedPage slotted_page(page_handle);
+    bool forwarded = slotted_page.get_slot(rid.slot_no)->flag == RM_SLOT_FORWARD;
+    Rid target;
+    if (forwarded) {
+        memcpy(&target, slotted_page.get_tuple(rid.slot_no), sizeof(Rid));
+    }
+    slotted_page.erase(rid.slot_no);
+    Bitmap::reset(page_handle.bitmap, rid.slot_no);
+    page_handle.page_hdr->num_records--;
+    update_free_space(page_handle);
+    page_handle.page->wunlatch();
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+
+    if (forwarded) {
+        RmPageHandle target_handle = fetch_page_handle(target.page_no);
+        target_handle.page->wlatch();
+        RmSlottedPage target_page(target_handle);
+        target_page.erase(target.slot_no);
+        update_free_space(target_handle);
+        target_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), true);
+    }
+}
+
+/**
+ * @description: 更新SLOTTED格式文件中记录号为rid的记录
+ * 新元组在原页面放得下时原地更新（必要时整理页面），否则迁移到其他页面，原槽改为指向新位置的FORWARD槽，
+ * 保证rid不变，索引无需修改
+ * @param {Rid&} rid 记录号
+ * @param {char*} buf 新记录的数据
+ */
+void RmFileHandle::update_slotted_record(const Rid& rid, char* buf) {
+    char tuple[RM_MAX_TUPLE_SIZE];
+    int len = RmSlottedPage::encode(file_hdr_, buf, tuple);
+
+    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    page_handle.page->wlatch();
+    if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        page_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        throw RecordNotFoundError(rid.page_no, rid.slot_no);
+    }
+    RmSlottedPage slotted_page(page_handle);
+    bool forwarded = slotted_page.get_slot(rid.slot_no)->flag == RM_SLOT_FORWARD;
+    Rid old_target;
+    if (forwarded) {
+        memcpy(&old_target, slotted_page.get_tuple(rid.slot_no), sizeof(Rid));
+        page_handle.page->wunlatch();
+
+        RmPageHandle target_handle = fetch_page_handle(old_target.page_no);
+        target_handle.page->wlatch();
+        RmSlottedPage target_page(target_handle);
+        bool updated = target_page.can_update(old_target.slot_no, len);
+        if (updated) {
+            target_page.update(old_target.slot_no, tuple, len, RM_SLOT_MOVED);
+            update_free_space(target_handle);
+        }
+        target_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), updated);
+        if (updated) {
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            return;
+        }
+        // 新位置也放不下了，按原页面中的FORWARD槽重新放置
+        page_handle.page->wlatch();
+    }
+    if (slotted_page.can_update(rid.slot_no, len)) {
+        slotted_page.update(rid.slot_no, tuple, len, RM_SLOT_NORMAL);
+    } else {
+        // 迁移到其他页面；原槽至少占sizeof(Rid)字节，之后一定能原地改写为FORWARD槽
+        page_handle.page->wunlatch();
+        Rid target = insert_tuple(tuple, len);
+        page_handle.page->wlatch();
+        slotted_page.update(rid.slot_no, reinterpret_cast<char*>(&target), sizeof(Rid), RM_SLOT_FORWARD);
+    }
+    update_free_space(page_handle);
+    page_handle.page->wunlatch();
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+
+    // 原槽已不再指向旧的迁移位置，这时才删除旧元组；扫描只持有页面的读锁跟着FORWARD槽读取，不会读到已删除的元组
+    if (forwarded) {
+        RmPageHandle target_handle = fetch_page_handle(old_target.page_no);
+        target_handle.page->wlatch();
+        RmSlottedPage(target_handle).erase(old_target.slot_no);
+        update_free_space(target_handle);
+        target_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(target_handle.page->get_page_id(), true);
+    }
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 通过空闲空间映射找一个页面放入一条记录，槽位在记录于bitmap中置位之前就加上了X锁
+ * @param {char*} buf 记录数据
+ * @param {int} end_page_no 为-1时没有空闲页面就分配新页面，否则只放到end_page_no之前的页面中
+ * @param {Rid*} rid 插入的位置
+ * @param {Context*} context
+ * @return {bool} 是否插入成功，end_page_no为-1时总是成功
  */
-void RmFileHandle::release_page_handle(RmPageHandle& page_handle) {
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
-}
\ No newline at end of file
+bool RmFileHandle::place_record(const char* buf, int end_page_no, Rid* rid, Context* context) {
+    int need = record_need(buf);
+    bool new_page = false;
+    int begin_page_no = -1;
+    while (true) {
+        int page_no = new_page ? RM_NO_PAGE : fsm_.find(need, end_page_no, begin_page_no);
+        if (page_no == RM_NO_PAGE && end_page_no != -1) {
+            return false;
+        }
+        RmPageHandle pageHandle = page_no == RM_NO_PAGE ? create_new_page_handle() : fetch_page_handle(page_no);
+        pageHandle.page->wlatch();
+        // 空闲空间映射中的信息可能已过期（其他线程刚刚填满了这个页面），或者页面差一点放不下，这时更正后继续找
+        bool has_space = page_free_space(pageHandle) >= need;
+        std::vector<Rid> rids;
+        if (has_space) {
+            fill_page(pageHandle, buf, 1, &rids, context);
+        } else {
+            begin_page_no = RmFreeSpaceMap::retry_from(begin_page_no, page_no);
+        }
+        update_free_space(pageHandle);
+        pageHandle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(pageHandle.page->get_page_id(), !rids.empty());
+        if (!rids.empty()) {
+            *rid = rids[0];
+            return true;
+        }
+        if (has_space) {
+            // 能放下的槽位都被其他事务锁住了，换一个新页面
+            if (end_page_no != -1) {
+                return false;
+            }
+            new_page = true;
+        }
+    }
+}
+
+/**
+ * @description: 记录需要的空闲空间，单位与create_page_handle的need一致
+ */
+int RmFileHandle::record_need(const char* buf) const {
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        char tuple[RM_MAX_TUPLE_SIZE];
+        return RmSlottedPage::alloc_len(RmSlottedPage::encode(file_hdr_, buf, tuple));
+    }
+    return 1;
+}
+
+/**
+ * @description: 在页面中找最多n个能放新记录的槽位并加上X锁，调用者持有页面的写锁
+ * 加锁不等待，其他事务还持有锁的空闲槽位（如未提交的删除）不复用；放入记录之后才在bitmap中置位，
+ * 其他事务看到记录时记录已经被锁住
+ * @return {vector<Rid>} 加上锁的槽位，按槽号递增
+ */
+std::vector<Rid> RmFileHandle::lock_free_slots(const RmPageHandle& page_handle, int n, Context* context) {
+    int page_no = page_handle.page->get_page_id().page_no;
+    int max_n = file_hdr_.num_records_per_page;
+    std::vector<Rid> locked;
+    int slot_no = -1;
+    while ((int)locked.size() < n) {
+        std::vector<Rid> candidates;
+        while ((int)(locked.size() + candidates.size()) < n) {
+            if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+                slot_no = RmSlottedPage(page_handle).next_free_slot(slot_no);
+            } else {
+                slot_no = Bitmap::next_bit(false, page_handle.bitmap, max_n, slot_no);
+            }
+            if (slot_no >= max_n) {
+                break;
+            }
+            candidates.push_back(Rid{page_no, slot_no});
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        context->lock_mgr_->try_lock_exclusive_on_records(context->txn_, candidates, fd_, &locked);
+    }
+    return locked;
+}
+
+/**
+ * @description: 把记录依次填入页面，按文件的存储格式分派
+ * @return {int} 填入的记录条数
+ */
+int RmFileHandle::fill_page(RmPageHandle& page_handle, const char* bufs, int num_records, std::vector<Rid>* rids,
+                            Context* context) {
+    if (file_hdr_.storage_type == RM_STORAGE_SLOTTED) {
+        return fill_slotted_page(page_handle, bufs, num_records, rids, context);
+    }
+    return fill_fixed_page(page_handle, bufs, num_records, rids, context);
+}
+
+/**
+ * @description: 在SLOTTED格式文件中放置一个从其他页面迁移过来的元组，通过空闲空间映射找能放下的页面
+ * MOVED元组不在bitmap中置位，也不需要行锁，只能通过其原位置的FORWARD槽访问
+ * @param {char*} tuple 编码后的元组
+ * @param {int} len 元组长度
+ * @return {Rid} 元组所在的位置
+ */
+Rid RmFileHandle::insert_tuple(const char* tuple, int len) {
+    int begin_page_no = -1;
+    while (true) {
+        int page_no = fsm_.find(RmSlottedPage::alloc_len(len), -1, begin_page_no);
+        RmPageHandle page_handle = page_no == RM_NO_PAGE ? create_new_page_handle() : fetch_page_handle(page_no);
+        page_handle.page->wlatch();
+        RmSlottedPage slotted_page(page_handle);
+        if (!slotted_page.can_insert(len)) {
+            // 空闲空间映射中的信息已过期或页面差一点放不下，更正后继续找
+            begin_page_no = RmFreeSpaceMap::retry_from(begin_page_no, page_handle.page->get_page_id().page_no);
+            update_free_space(page_handle);
+            page_handle.page->wunlatch();
+            buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+            continue;
+        }
+        Rid rid = {.page_no = page_handle.page->get_page_id().page_no,
+                   .slot_no = slotted_page.insert(tuple, len, RM_SLOT_MOVED)};
+        update_free_space(page_handle);
+        page_handle.page->wunlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+        return rid;
+    }
+}
+
+/**
+ * @description: 把记录依次填入FIXED格式页面中加上锁的空闲槽位，连续的槽位一次拷贝
+ * @return {int} 填入的记录条数
+ */
+int RmFileHandle::fill_fixed_page(RmPageHandle& page_handle, const char* bufs, int num_records,
+                                  std::vector<Rid>* rids, Context* context) {
+    std::vector<Rid> locked = lock_free_slots(page_handle, num_records, context);
+    size_t i = 0;
+    while (i < locked.size()) {
+        size_t run_end = i + 1;
+        while (run_end < locked.size() && locked[run_end].slot_no == locked[run_end - 1].slot_no + 1) {
+            run_end++;
+        }
+        int slot_no = locked[i].slot_no;
+        int cnt = run_end - i;
+        const char* buf = bufs + i * file_hdr_.record_size;
+        if (page_handle.is_pax()) {
+            for (int j = 0; j < cnt; j++) {
+                page_handle.write_record(slot_no + j, buf + (size_t)j * file_hdr_.record_size);
+            }
+        } else {
+            memcpy(page_handle.get_slot(slot_no), buf, (size_t)cnt * file_hdr_.record_size);
+        }
+        for (int j = slot_no; j < slot_no + cnt; j++) {
+            Bitmap::set(page_handle.bitmap, j);
+        }
+        i = run_end;
+    }
+    rids->insert(rids->end(), locked.begin(), locked.end());
+    page_handle.page_hdr->num_records += locked.size();
+    return locked.size();
+}
+
+/**
+ * @description: 把记录编码后依次填入SLOTTED格式页面中加上锁的槽位，直到放不下下一条记录
+ * 按每条记录都新增一个槽目录项估计页面还能放下几条，只锁这么多个槽位，放完后再估计下一轮
+ * @return {int} 填入的记录条数
+ */
+int RmFileHandle::fill_slotted_page(RmPageHandle& page_handle, const char* bufs, int num_records,
+                                    std::vector<Rid>* rids, Context* context) {
+    RmSlottedPage slotted_page(page_handle);
+    char tuple[RM_MAX_TUPLE_SIZE];
+    int num_filled = 0;
+    while (num_filled < num_records) {
+        int space = slotted_page.insert_space();
+        int n = 0;
+        while (num_filled + n < num_records) {
+            int len = RmSlottedPage::encode(file_hdr_, bufs + (size_t)(num_filled + n) * file_hdr_.record_size, tuple);
+            space -= RmSlottedPage::alloc_len(len) + (n == 0 ? 0 : (int)sizeof(RmSlot));
+            if (space < 0) {
+                break;
+            }
+            n++;
+        }
+        if (n == 0) {
+            break;
+        }
+        // 槽号跳过了没有锁上的新槽时放不进去，多锁上的槽位上没有记录，随事务结束释放
+        std::vector<Rid> locked = lock_free_slots(page_handle, n, context);
+        int round_filled = 0;
+        for (auto& rid : locked) {
+            int len = RmSlottedPage::encode(file_hdr_, bufs + (size_t)num_filled * file_hdr_.record_size, tuple);
+            if (!slotted_page.can_insert_at(rid.slot_no, len)) {
+                break;
+            }
+            slotted_page.insert_at(rid.slot_no, tuple, len, RM_SLOT_NORMAL);
+            Bitmap::set(page_handle.bitmap, rid.slot_no);
+            rids->push_back(rid);
+            num_filled++;
+            round_filled++;
+        }
+        page_handle.page_hdr->num_records += round_filled;
+        if (round_filled < n) {
+            break;
+        }
+    }
+    return num_filled;
+}
@@ -3,10 +3,15 @@
 #include <assert.h>
 
 #include <memory>
+#include <shared_mutex>
+#include <vector>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_free_space_map.h"
+#include "rm_record_view.h"
+#include "rm_slotted_page.h"
 
 class RmManager;
 
@@ -28,6 +33,38 @@ struct RmPageHandle {
     char* get_slot(int slot_no) const {
         return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
     }
+
+    // 记录是否按PAX格式分字段存放
+    bool is_pax() const { return file_hdr->storage_type == RM_STORAGE_PAX && file_hdr->num_cols > 0; }
+
+    // PAX格式下字段col_no的minipage首地址；字段按偏移依次铺满记录，因此minipage的起点为槽位个数 * 字段偏移
+    char* get_minipage(int col_no) const {
+        return slots + file_hdr->num_records_per_page * file_hdr->cols[col_no].offset;
+    }
+
+    // 把槽位slot_no上的记录拷贝到record中，PAX格式需要从各个minipage中拼出整条记录
+    void read_record(int slot_no, char* record) const {
+        if (!is_pax()) {
+            memcpy(record, get_slot(slot_no), file_hdr->record_size);
+            return;
+        }
+        for (int i = 0; i < file_hdr->num_cols; i++) {
+            const RmColHdr &col = file_hdr->cols[i];
+            memcpy(record + col.offset, get_minipage(i) + slot_no * col.len, col.len);
+        }
+    }
+
+    // 把record写入槽位slot_no
+    void write_record(int slot_no, const char* record) const {
+        if (!is_pax()) {
+            memcpy(get_slot(slot_no), record, file_hdr->record_size);
+            return;
+        }
+        for (int i = 0; i < file_hdr->num_cols; i++) {
+            const RmColHdr &col = file_hdr->cols[i];
+            memcpy(get_minipage(i) + slot_no * col.len, record + col.offset, col.len);
+        }
+    }
 };
 
 /* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
@@ -40,6 +77,9 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    RmFreeSpaceMap fsm_;    // 各页面的空闲空间，由RmManager在打开/关闭文件时读写
+    // 截断文件时持有写锁；扫描进入页面时持有读锁，检查页面号和pin住页面之间页面不会被截断
+    mutable std::shared_mutex truncate_latch_;
 
    public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -50,6 +90,9 @@ class RmFileHandle {
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        // FIXED格式以槽位个数计空闲空间，SLOTTED格式以字节数计
+        fsm_.set_capacity(file_hdr_.storage_type == RM_STORAGE_SLOTTED ? RmSlottedPage::empty_insert_space(file_hdr_)
+                                                                       : file_hdr_.num_records_per_page);
     }
 
     RmFileHdr get_file_hdr() { return file_hdr_; }
@@ -58,25 +101,70 @@ class RmFileHandle {
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
     bool is_record(const Rid &rid) const {
         RmPageHandle page_handle = fetch_page_handle(rid.page_no);
-        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        page_handle.page->rlatch();
+        bool exist = Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+        page_handle.page->runlatch();
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+        return exist;
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    void get_record_view(const Rid &rid, Context *context, RmRecordView *view) const;
+
     Rid insert_record(char *buf, Context *context);
 
     void insert_record(const Rid &rid, char *buf);
 
+    std::vector<Rid> insert_records(const char *bufs, int num_records, Context *context);
+
     void delete_record(const Rid &rid, Context *context);
 
     void update_record(const Rid &rid, char *buf, Context *context);
 
+    bool relocate_record(const Rid &rid, int end_page_no, Context *context, Rid *new_rid,
+                         std::unique_ptr<RmRecord> *record);
+
+    std::vector<Rid> get_relocation_rids(int page_no) const;
+
+    int truncate_empty_pages(Context *context);
+
     RmPageHandle create_new_page_handle();
 
     RmPageHandle fetch_page_handle(int page_no) const;
 
    private:
-    RmPageHandle create_page_handle();
+    RmPageHandle create_page_handle(int need, int begin_page_no = -1);
+
+    int page_free_space(const RmPageHandle &page_handle) const;
+
+    void update_free_space(const RmPageHandle &page_handle);
+
+    void rebuild_free_space_map();
+
+    bool place_record(const char *buf, int end_page_no, Rid *rid, Context *context);
+
+    int record_need(const char *buf) const;
+
+    std::vector<Rid> lock_free_slots(const RmPageHandle &page_handle, int n, Context *context);
+
+    void release_write_locks(const Rid &rid, Context *context);
+
+    int fill_page(RmPageHandle &page_handle, const char *bufs, int num_records, std::vector<Rid> *rids,
+                  Context *context);
+
+    int fill_fixed_page(RmPageHandle &page_handle, const char *bufs, int num_records, std::vector<Rid> *rids,
+                        Context *context);
+
+    int fill_slotted_page(RmPageHandle &page_handle, const char *bufs, int num_records, std::vector<Rid> *rids,
+                          Context *context);
+
+    // 以下为SLOTTED格式的实现
+    void read_slotted_tuple(const RmPageHandle &page_handle, int slot_no, char *record) const;
+
+    void delete_slotted_record(const Rid &rid);
+
+    void update_slotted_record(const Rid &rid, char *buf);
 
-    void release_page_handle(RmPageHandle &page_handle);
+    Rid insert_tuple(const char *tuple, int len);
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "rm_free_space_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include "rm_defs.h"
+
+int RmFreeSpaceMap::get_level(int page_no) {
+    std::scoped_lock lock{latch_};
+    return page_no < num_pages_ ? level_at(page_no) : 0;
+}
+
+void RmFreeSpaceMap::update(int page_no, int free_space) {
+    std::scoped_lock lock{latch_};
+    if (page_no >= num_pages_) {
+        resize(page_no + 1);
+    }
+    int level = to_level(free_space);
+    uint8_t &byte = levels_[page_no >> 1];
+    if (page_no & 1) {
+        byte = (byte & RM_FSM_MAX_LEVEL) | (level << RM_FSM_BITS_PER_PAGE);
+    } else {
+        byte = (byte & ~RM_FSM_MAX_LEVEL) | level;
+    }
+    if (level > 0 && page_no < cursor_) {
+        cursor_ = page_no;
+    }
+}
+
+/**
+ * @description: begin_page_no为-1时从cursor_开始收集至多RM_FSM_NUM_CANDIDATES个等级足够的页面，按线程选择其中一个，
+ * 并发插入的线程因此分散到不同的页面上；单线程插入时总是选中同一个页面，页面利用率不受影响
+ * 调用者发现页面放不下之后指定begin_page_no，这时按页面号顺序返回第一个等级足够的页面，逐个往后试不会漏掉页面
+ */
+int RmFreeSpaceMap::find(int need, int end_page_no, int begin_page_no) {
+    std::scoped_lock lock{latch_};
+    // 空闲空间不少于need的页面等级不低于need对应的等级（向下取整），按这个等级找不会漏掉能放下的页面；
+    // 与need同等级的页面可能差一点放不下，由调用者检查后跳过
+    int min_level = std::max(1, need * RM_FSM_MAX_LEVEL / capacity_);
+    if (min_level > RM_FSM_MAX_LEVEL) {
+        return RM_NO_PAGE;
+    }
+
+    int end = end_page_no == -1 ? num_pages_ : std::min(end_page_no, num_pages_);
+    int max_candidates = begin_page_no == -1 ? RM_FSM_NUM_CANDIDATES : 1;
+    int candidates[RM_FSM_NUM_CANDIDATES];
+    int num_candidates = 0;
+    // 从cursor_之后的begin_page_no开始找时，之前的页面不一定已满，不能移动cursor_
+    bool skipping = begin_page_no <= cursor_;
+    for (int page_no = std::max(cursor_, begin_page_no); page_no < end && num_candidates < max_candidates; page_no++) {
+        // 两个页面都已满的字节整个跳过
+        if (!(page_no & 1) && levels_[page_no >> 1] == 0) {
+            page_no++;
+            continue;
+        }
+        int level = level_at(page_no);
+        if (level > 0 && skipping) {
+            cursor_ = page_no;
+            skipping = false;
+        }
+        if (level >= min_level) {
+            candidates[num_candidates++] = page_no;
+        }
+    }
+    if (skipping) {
+        cursor_ = std::max(cursor_, end);
+    }
+    if (num_candidates == 0) {
+        return RM_NO_PAGE;
+    }
+    size_t hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return candidates[hash % num_candidates];
+}
+
+void RmFreeSpaceMap::clear(int num_pages) {
+    std::scoped_lock lock{latch_};
+    levels_.clear();
+    num_pages_ = 0;
+    resize(num_pages);
+    cursor_ = 0;
+}
+
+void RmFreeSpaceMap::truncate(int num_pages) {
+    std::scoped_lock lock{latch_};
+    if (num_pages >= num_pages_) {
+        return;
+    }
+    resize(num_pages);
+    if (num_pages & 1) {
+        levels_.back() &= RM_FSM_MAX_LEVEL;
+    }
+    cursor_ = std::min(cursor_, num_pages);
+}
+
+int RmFreeSpaceMap::serialized_size() const {
+    std::scoped_lock lock{latch_};
+    return sizeof(int) + levels_.size();
+}
+
+void RmFreeSpaceMap::serialize(char *dest) const {
+    std::scoped_lock lock{latch_};
+    memcpy(dest, &num_pages_, sizeof(int));
+    memcpy(dest + sizeof(int), levels_.data(), levels_.size());
+}
+
+bool RmFreeSpaceMap::deserialize(const char *src, int size, int num_pages) {
+    std::scoped_lock lock{latch_};
+    int stored_pages;
+    if (size < (int)sizeof(int)) {
+        return false;
+    }
+    memcpy(&stored_pages, src, sizeof(int));
+    // 映射文件原地覆盖写，页面数变少时文件末尾会留下上次的数据，忽略即可
+    int levels_size = (stored_pages + 1) / 2;
+    if (stored_pages < 0 || stored_pages > num_pages || size < (int)sizeof(int) + levels_size) {
+        return false;
+    }
+    num_pages_ = stored_pages;
+    levels_.assign(src + sizeof(int), src + sizeof(int) + levels_size);
+    // 映射写入之后文件又增加的页面（上次没有正常关闭文件）暂时不在映射中，这些页面上再删除记录时会被加入
+    cursor_ = 0;
+    return true;
+}
+
+int RmFreeSpaceMap::to_level(int free_space) const {
+    if (free_space <= 0) {
+        return 0;
+    }
+    int level = free_space * RM_FSM_MAX_LEVEL / capacity_;
+    return level < 1 ? 1 : (level > RM_FSM_MAX_LEVEL ? RM_FSM_MAX_LEVEL : level);
+}
+
+void RmFreeSpaceMap::resize(int num_pages) {
+    num_pages_ = num_pages;
+    levels_.resize((num_pages + 1) / 2, 0);
+}
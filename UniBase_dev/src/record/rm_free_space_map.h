@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/* 每个页面的空闲空间等级占用的位数 */
+constexpr int RM_FSM_BITS_PER_PAGE = 4;
+/* 空闲空间的最高等级，等级0表示页面已满 */
+constexpr int RM_FSM_MAX_LEVEL = (1 << RM_FSM_BITS_PER_PAGE) - 1;
+/* 插入时从多少个候选页面中挑选，不同线程落在不同的页面上，减少对同一页面的争用 */
+constexpr int RM_FSM_NUM_CANDIDATES = 4;
+
+/**
+ * @description: 表数据文件的空闲空间映射（free space map）
+ * 每个页面用4位记录空闲空间等级：等级 = 空闲空间 * 15 / capacity（向下取整），只要还有空闲空间等级就至少为1
+ * 等级只是提示，插入前仍需在页面上检查能否放下，放不下时用页面的实际情况更新等级并从下一个页面继续找
+ * 所有操作内部加锁，可以被多个线程同时调用
+ */
+class RmFreeSpaceMap {
+   public:
+    /* capacity为一个空页面的空闲空间，单位由调用者决定（FIXED格式为槽位个数，SLOTTED格式为字节数） */
+    explicit RmFreeSpaceMap(int capacity = 1) : capacity_(capacity) {}
+
+    void set_capacity(int capacity) { capacity_ = capacity; }
+
+    int num_pages() const { return num_pages_; }
+
+    /* 页面的空闲空间等级，超出映射范围的页面视为已满 */
+    int get_level(int page_no);
+
+    /* 更新页面的空闲空间，映射会随页面号自动扩展 */
+    void update(int page_no, int free_space);
+
+    /* 找一个空闲空间可能不少于need的页面，end_page_no不为-1时只在它之前的页面中找；没有时返回RM_NO_PAGE
+     * 找到的页面可能差一点放不下，调用者检查后把begin_page_no设为0再找一次，之后每次从放不下的页面的下一个页面继续找 */
+    int find(int need, int end_page_no = -1, int begin_page_no = -1);
+
+    /* find找到的页面missed_page_no放不下时，下一次find的begin_page_no */
+    static int retry_from(int begin_page_no, int missed_page_no) {
+        return begin_page_no == -1 ? 0 : missed_page_no + 1;
+    }
+
+    /* 清空映射，之后由调用者逐页update重建 */
+    void clear(int num_pages);
+
+    /* 文件截断后去掉num_pages及之后的页面 */
+    void truncate(int num_pages);
+
+    /* 序列化后的长度 */
+    int serialized_size() const;
+
+    void serialize(char *dest) const;
+
+    /* 从序列化的数据中恢复，映射中的页面数不能超过文件的页面数num_pages；数据不完整时返回false */
+    bool deserialize(const char *src, int size, int num_pages);
+
+   private:
+    mutable std::mutex latch_;
+    int capacity_;
+    int num_pages_ = 0;
+    std::vector<uint8_t> levels_;   // 每个字节存两个页面的等级，偶数页在低4位
+    int cursor_ = 0;                // 第一个可能还有空闲空间的页面，之前的页面都已满
+
+    int to_level(int free_space) const;
+
+    int level_at(int page_no) const {
+        return page_no & 1 ? levels_[page_no >> 1] >> RM_FSM_BITS_PER_PAGE : levels_[page_no >> 1] & RM_FSM_MAX_LEVEL;
+    }
+
+    void resize(int num_pages);
+};
@@ -2,6 +2,9 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "bitmap.h"
 #include "rm_defs.h"
 #include "rm_file_handle.h"
@@ -20,9 +23,14 @@ class RmManager {
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
      * @param {int} record_size 表中记录的大小
+     * @param {RmStorageType} storage_type 页面组织方式
+     * @param {vector<RmColHdr>&} cols 记录中各字段的布局，SLOTTED格式据此编码元组，PAX格式据此划分minipage；
+     *                                 为空时把整条记录当作一个字段
      */ 
-    void create_file(const std::string& filename, int record_size) {
-        if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
+    void create_file(const std::string& filename, int record_size, RmStorageType storage_type = RM_STORAGE_FIXED,
+                     const std::vector<RmColHdr>& cols = {}) {
+        int max_record_size = storage_type == RM_STORAGE_SLOTTED ? RM_MAX_SLOTTED_RECORD_SIZE : RM_MAX_RECORD_SIZE;
+        if (record_size < 1 || record_size > max_record_size) {
             throw InvalidRecordSizeError(record_size);
         }
         disk_manager_->create_file(filename);
@@ -32,23 +40,64 @@ class RmManager {
         RmFileHdr file_hdr{};
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
-        file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
-        file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.storage_type = storage_type;
+        // 字段过多时放弃按字段编码，退化为整条记录去掉尾部填充
+        if (cols.size() <= RM_MAX_COLS) {
+            file_hdr.num_cols = cols.size();
+            std::copy(cols.begin(), cols.end(), file_hdr.cols);
+        }
+        // PAX格式要求字段按偏移依次铺满整条记录，否则不划分minipage，页面布局与FIXED相同
+        if (storage_type == RM_STORAGE_PAX) {
+            int offset = 0;
+            for (int i = 0; i < file_hdr.num_cols; i++) {
+                if (file_hdr.cols[i].offset != offset) {
+                    offset = -1;
+                    break;
+                }
+                offset += file_hdr.cols[i].len;
+            }
+            if (offset != record_size) {
+                file_hdr.num_cols = 0;
+            }
+        }
+        int page_space = PAGE_SIZE - Page::OFFSET_PAGE_HDR - (int)sizeof(RmPageHdr);
+        if (storage_type == RM_STORAGE_SLOTTED) {
+            // num_records_per_page为槽个数的上限，按最短的元组估计；bitmap按4字节对齐，使之后的页头对齐
+            int slot_size = sizeof(RmSlot) + RmSlottedPage::alloc_len(RmSlottedPage::min_tuple_len(file_hdr));
+            int n = (page_space - (int)sizeof(RmSlottedPageHdr)) / slot_size;
+            while (((n + 31) / 32) * 4 + n * slot_size > page_space - (int)sizeof(RmSlottedPageHdr)) {
+                n--;
+            }
+            file_hdr.num_records_per_page = n;
+            file_hdr.bitmap_size = ((n + 31) / 32) * 4;
+        } else {
+            // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (page_space - 1) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        }
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
         disk_manager_->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
         disk_manager_->close_file(fd);
+
+        // 新文件只有文件头页面，空闲空间映射中没有可用页面
+        RmFreeSpaceMap fsm;
+        fsm.clear(file_hdr.num_pages);
+        write_free_space_map(filename, fsm);
     }
 
     /**
      * @description: 删除表的数据文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        if (disk_manager_->is_file(get_fsm_name(filename))) {
+            disk_manager_->destroy_file(get_fsm_name(filename));
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
@@ -58,7 +107,12 @@ class RmManager {
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        // 映射文件缺失或损坏时，扫描所有页面重建
+        if (!read_free_space_map(filename, &file_handle->fsm_, file_handle->file_hdr_.num_pages)) {
+            file_handle->rebuild_free_space_map();
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
@@ -69,6 +123,37 @@ class RmManager {
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
+        write_free_space_map(disk_manager_->get_file_name(file_handle->fd_), file_handle->fsm_);
         disk_manager_->close_file(file_handle->fd_);
     }
+
+   private:
+    /* 空闲空间映射单独存放在表数据文件旁的<filename>.fsm文件中 */
+    static std::string get_fsm_name(const std::string& filename) { return filename + ".fsm"; }
+
+    /* 原地覆盖写映射文件，不先删除再创建；写到一半崩溃时读出的等级可能有误，但等级只是提示，不影响正确性 */
+    void write_free_space_map(const std::string& filename, const RmFreeSpaceMap& fsm) {
+        std::string fsm_name = get_fsm_name(filename);
+        std::vector<char> buf(fsm.serialized_size());
+        fsm.serialize(buf.data());
+        if (!disk_manager_->is_file(fsm_name)) {
+            disk_manager_->create_file(fsm_name);
+        }
+        int fd = disk_manager_->open_file(fsm_name);
+        disk_manager_->write_page(fd, 0, buf.data(), buf.size());
+        disk_manager_->close_file(fd);
+    }
+
+    bool read_free_space_map(const std::string& filename, RmFreeSpaceMap* fsm, int num_pages) {
+        std::string fsm_name = get_fsm_name(filename);
+        int size = disk_manager_->get_file_size(fsm_name);
+        if (size <= 0) {
+            return false;
+        }
+        std::vector<char> buf(size);
+        int fd = disk_manager_->open_file(fsm_name);
+        disk_manager_->read_page(fd, 0, buf.data(), size);
+        disk_manager_->close_file(fd);
+        return fsm->deserialize(buf.data(), size, num_pages);
+    }
 };
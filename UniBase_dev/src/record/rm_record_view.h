@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "rm_defs.h"
+
+class RmFileHandle;
+
+/**
+ * @description: 记录的只读视图，由RmFileHandle::get_record_view填充
+ * FIXED格式下直接指向缓冲池页面中的槽位，视图存活期间页面保持pin住并持有读锁，不拷贝数据；
+ * SLOTTED格式的元组需要解码、PAX格式的记录需要从各个minipage中拼出，结果放在视图自带的缓冲区中并立即释放页面，
+ * 缓冲区在视图复用时不会重新分配
+ * @note 持有视图期间不能修改同一页面（写锁会等待读锁释放），用完后尽早release
+ */
+class RmRecordView {
+    friend class RmFileHandle;
+
+   public:
+    RmRecordView() = default;
+
+    RmRecordView(const RmRecordView &) = delete;
+
+    RmRecordView &operator=(const RmRecordView &) = delete;
+
+    ~RmRecordView() { release(); }
+
+    const char *data() const { return data_; }
+
+    int size() const { return size_; }
+
+    bool is_valid() const { return data_ != nullptr; }
+
+    /* 把视图中的记录拷贝出来，只在记录需要离开当前算子时调用 */
+    std::unique_ptr<RmRecord> to_record() const {
+        return std::make_unique<RmRecord>(size_, const_cast<char *>(data_));
+    }
+
+    /* 释放页面上的读锁和pin */
+    void release() {
+        if (page_ != nullptr) {
+            page_->runlatch();
+            buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+            page_ = nullptr;
+        }
+        data_ = nullptr;
+    }
+
+   private:
+    BufferPoolManager *buffer_pool_manager_ = nullptr;
+    Page *page_ = nullptr;      // 视图直接指向的页面，为nullptr时数据在buf_中
+    const char *data_ = nullptr;
+    int size_ = 0;
+    std::vector<char> buf_;     // SLOTTED/PAX格式的记录缓冲区
+};
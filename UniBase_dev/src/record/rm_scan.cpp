@@ -5,44 +5,35 @@
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param start_page_no 扫描的第一个页面
+ * @param end_page_no 扫描范围的右边界（不含），-1表示扫描到文件末尾
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
-    // Todo:
+RmScan::RmScan(const RmFileHandle *file_handle, int start_page_no, int end_page_no)
+    : file_handle_(file_handle), end_page_no_(end_page_no) {
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
-    // 初始化file_handle_
-    rid_ = {.page_no = RM_FIRST_RECORD_PAGE, .slot_no = -1};
-    next();
+    enter_page(start_page_no < RM_FIRST_RECORD_PAGE ? RM_FIRST_RECORD_PAGE : start_page_no);
 }
 
+RmScan::~RmScan() { release_page(); }
+
 /**
  * @brief 找到文件中下一个存放了记录的位置
  */
 void RmScan::next() {
-    // Todo:
-    // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-    while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
-        RmPageHandle pageHandle = file_handle_->fetch_page_handle(rid_.page_no);
-        rid_.slot_no = Bitmap::next_bit(
-            true, pageHandle.bitmap,
-            file_handle_->file_hdr_.num_records_per_page,
-            rid_.slot_no);
-        if (rid_.slot_no < this->file_handle_->file_hdr_.num_records_per_page) {
-            return;
-        } else {
-            rid_ = Rid{rid_.page_no + 1, -1};
-            if (rid_.page_no >= file_handle_->file_hdr_.num_pages) {
-                rid_ = Rid{RM_NO_PAGE, -1};
-                break;
-            }
-        }
+    if (is_end()) {
+        return;
     }
+    if (!page_returned_ && ++idx_ < slots_.size()) {
+        rid_.slot_no = slots_[idx_];
+        return;
+    }
+    enter_page(rid_.page_no + 1);
 }
 
 /**
  * @brief ​ 判断是否到达文件末尾
  */
 bool RmScan::is_end() const {
-    // Todo: 修改返回值
     return rid_.page_no == RM_NO_PAGE;
 }
 
@@ -51,4 +42,168 @@ bool RmScan::is_end() const {
  */
 Rid RmScan::rid() const {
     return rid_;
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 按页扫描，一次返回一个页面中从当前位置起的所有记录
+ * @return {bool} 是否还有记录，为false时rids和records为空
+ * @param {vector<Rid>*} rids 记录号
+ * @param {vector<const char*>*} records 可选，与rids一一对应的记录数据；FIXED格式下直接指向缓冲池页面，
+ *                                       SLOTTED/PAX格式下指向扫描内部的缓冲区
+ * @note records在下一次调用next_page/next或扫描析构之前有效，期间扫描持有当前页面的读锁，不能修改该页面
+ */
+bool RmScan::next_page(std::vector<Rid> *rids, std::vector<const char *> *records) {
+    if (records != nullptr) {
+        records->clear();
+    }
+    if (!begin_page(rids, records != nullptr)) {
+        return false;
+    }
+    if (records == nullptr) {
+        return true;
+    }
+
+    const RmFileHdr &file_hdr = file_handle_->file_hdr_;
+    RmPageHandle page_handle(&file_hdr, page_);
+    bool copy = file_hdr.storage_type == RM_STORAGE_SLOTTED || page_handle.is_pax();
+    if (copy) {
+        buf_.resize(rids->size() * file_hdr.record_size);
+    }
+    for (size_t i = 0; i < rids->size(); i++) {
+        int slot_no = (*rids)[i].slot_no;
+        if (!copy) {
+            records->push_back(page_handle.get_slot(slot_no));
+            continue;
+        }
+        char *record = buf_.data() + i * file_hdr.record_size;
+        if (file_hdr.storage_type == RM_STORAGE_SLOTTED) {
+            file_handle_->read_slotted_tuple(page_handle, slot_no, record);
+        } else {
+            page_handle.read_record(slot_no, record);
+        }
+        records->push_back(record);
+    }
+    return true;
+}
+
+/**
+ * @description: 按页扫描，返回一个页面中从当前位置起的所有记录号，以及按字段访问记录的方式
+ * 上层只读取需要的字段：PAX格式下每个字段的值在minipage中连续存放，FIXED格式下按记录长度跨步访问，
+ * SLOTTED格式先把元组解码到扫描内部的缓冲区中
+ * @return {bool} 是否还有记录
+ * @param {vector<Rid>*} rids 记录号
+ * @param {vector<RmColumnView>*} columns 文件头中每个字段一项；文件头中没有字段信息时只有一项，表示整条记录
+ * @note 与next_page的records相同，columns在扫描离开当前页面或调用unlatch之前有效
+ */
+bool RmScan::next_page_columns(std::vector<Rid> *rids, std::vector<RmColumnView> *columns) {
+    columns->clear();
+    if (!begin_page(rids, true)) {
+        return false;
+    }
+
+    const RmFileHdr &file_hdr = file_handle_->file_hdr_;
+    RmPageHandle page_handle(&file_hdr, page_);
+    const char *rows = page_handle.slots;
+    if (file_hdr.storage_type == RM_STORAGE_SLOTTED) {
+        // 解码到按槽号排列的缓冲区中，使得各种格式都可以用槽号定位字段的值
+        buf_.resize((size_t)file_hdr.num_records_per_page * file_hdr.record_size);
+        for (auto &rid : *rids) {
+            file_handle_->read_slotted_tuple(page_handle, rid.slot_no,
+                                             buf_.data() + (size_t)rid.slot_no * file_hdr.record_size);
+        }
+        rows = buf_.data();
+    }
+    if (file_hdr.num_cols == 0) {
+        columns->push_back(RmColumnView{rows, file_hdr.record_size});
+        return true;
+    }
+    for (int i = 0; i < file_hdr.num_cols; i++) {
+        if (page_handle.is_pax()) {
+            columns->push_back(RmColumnView{page_handle.get_minipage(i), file_hdr.cols[i].len});
+        } else {
+            columns->push_back(RmColumnView{rows + file_hdr.cols[i].offset, file_hdr.record_size});
+        }
+    }
+    return true;
+}
+
+/**
+ * @description: 提前释放next_page/next_page_columns持有的读锁，页面仍保持pin住，之后不能再访问返回的记录数据
+ */
+void RmScan::unlatch() {
+    if (latched_) {
+        page_->runlatch();
+        latched_ = false;
+    }
+}
+
+/**
+ * @description: next_page和next_page_columns的公共部分：离开已经整页返回的页面，取出当前页面剩余的记录号
+ * @param {bool} latch 是否为上层访问记录数据持有页面的读锁
+ */
+bool RmScan::begin_page(std::vector<Rid> *rids, bool latch) {
+    if (page_returned_) {
+        enter_page(rid_.page_no + 1);
+    }
+    rids->clear();
+    if (is_end()) {
+        return false;
+    }
+    page_returned_ = true;
+    if (latch) {
+        page_->rlatch();
+        latched_ = true;
+    }
+    for (size_t i = idx_; i < slots_.size(); i++) {
+        rids->push_back(Rid{rid_.page_no, slots_[i]});
+    }
+    return true;
+}
+
+/**
+ * @description: 扫描范围的右边界，未指定时取文件当前的页面数，扫描期间插入的新页面也能扫描到
+ */
+int RmScan::end_page_no() const {
+    int num_pages = file_handle_->file_hdr_.num_pages;
+    return end_page_no_ < 0 || end_page_no_ > num_pages ? num_pages : end_page_no_;
+}
+
+/**
+ * @description: 释放当前页面，从page_no开始找到第一个存放了记录的页面，pin住它并取出所有记录的槽号
+ * VACUUM可能同时截断文件，持有truncate_latch_的读锁，按当前的页面数判断是否到达末尾，pin住之后页面不会被截断
+ */
+void RmScan::enter_page(int page_no) {
+    release_page();
+    page_returned_ = false;
+    const RmFileHdr &file_hdr = file_handle_->file_hdr_;
+    std::shared_lock truncate_lock{file_handle_->truncate_latch_};
+    for (; page_no < end_page_no(); page_no++) {
+        RmPageHandle page_handle = file_handle_->fetch_page_handle(page_no);
+        page_handle.page->rlatch();
+        slots_.clear();
+        Bitmap::for_each_set_bit(page_handle.bitmap, file_hdr.num_records_per_page,
+                                 [this](int slot_no) { slots_.push_back(slot_no); });
+        page_handle.page->runlatch();
+        if (!slots_.empty()) {
+            page_ = page_handle.page;
+            idx_ = 0;
+            rid_ = Rid{page_no, slots_[0]};
+            return;
+        }
+        file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
+    }
+    slots_.clear();
+    rid_ = Rid{RM_NO_PAGE, -1};
+}
+
+/**
+ * @description: 释放next_page持有的读锁，unpin当前页面
+ */
+void RmScan::release_page() {
+    if (page_ == nullptr) {
+        return;
+    }
+    unlatch();
+    file_handle_->buffer_pool_manager_->unpin_page(page_->get_page_id(), false);
+    page_ = nullptr;
+}
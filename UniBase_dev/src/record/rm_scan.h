@@ -1,18 +1,61 @@
 #pragma once
 
+#include <vector>
+
 #include "rm_defs.h"
 
 class RmFileHandle;
 
+/* 一个页面中某个字段的值：槽位slot_no上的值位于base + slot_no * stride */
+struct RmColumnView {
+    const char *base;
+    int stride;
+};
+
+/**
+ * @description: 表数据文件的顺序扫描
+ * 扫描以页面为单位推进：进入一个页面时pin住它并一次取出其中所有记录的槽号，
+ * 此后在页内移动不再访问缓冲池，离开页面时unpin
+ * 可以指定页面范围[start_page_no, end_page_no)，用于把一张表切分给多个扫描
+ */
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    int end_page_no_;               // 扫描范围的右边界（不含），-1表示扫描到文件末尾
+    Page *page_ = nullptr;          // 当前pin住的页面
+    bool latched_ = false;          // 是否为返回给上层的记录视图持有当前页面的读锁
+    bool page_returned_ = false;    // 当前页面是否已经由next_page整页返回
+    std::vector<int> slots_;        // 当前页面中存放了记录的槽号
+    size_t idx_ = 0;                // rid_.slot_no在slots_中的下标
+    std::vector<char> buf_;         // SLOTTED/PAX格式下next_page拼出记录的缓冲区
+
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, int start_page_no = RM_FIRST_RECORD_PAGE, int end_page_no = -1);
+
+    ~RmScan();
+
+    RmScan(const RmScan &) = delete;
+
+    RmScan &operator=(const RmScan &) = delete;
 
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    bool next_page(std::vector<Rid> *rids, std::vector<const char *> *records = nullptr);
+
+    bool next_page_columns(std::vector<Rid> *rids, std::vector<RmColumnView> *columns);
+
+    void unlatch();
+
+private:
+    int end_page_no() const;
+
+    void enter_page(int page_no);
+
+    void release_page();
+
+    bool begin_page(std::vector<Rid> *rids, bool latch);
 };
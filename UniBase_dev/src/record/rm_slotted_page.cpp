@@ -0,0 +1,223 @@
+#include "rm_slotted_page.h"
+
+#include <algorithm>
+
+#include "rm_file_handle.h"
+
+RmSlottedPage::RmSlottedPage(const RmPageHandle &page_handle)
+    : file_hdr_(page_handle.file_hdr), data_(page_handle.page->get_data()), bitmap_(page_handle.bitmap) {
+    hdr_ = reinterpret_cast<RmSlottedPageHdr *>(page_handle.slots);
+    slots_ = reinterpret_cast<RmSlot *>(page_handle.slots + sizeof(RmSlottedPageHdr));
+}
+
+void RmSlottedPage::init() {
+    Bitmap::init(bitmap_, file_hdr_->bitmap_size);
+    hdr_->num_slots = 0;
+    hdr_->free_end = PAGE_SIZE;
+    hdr_->frag_bytes = 0;
+}
+
+bool RmSlottedPage::can_insert(int len) const { return alloc_len(len) <= insert_space(); }
+
+int RmSlottedPage::insert_space() const {
+    if (find_empty_slot() != -1) {
+        return free_space();
+    }
+    if (hdr_->num_slots >= file_hdr_->num_records_per_page) {
+        return 0;
+    }
+    return std::max(free_space() - (int)sizeof(RmSlot), 0);
+}
+
+bool RmSlottedPage::can_update(int slot_no, int len) const {
+    return alloc_len(len) <= free_space() + alloc_len(slots_[slot_no].len);
+}
+
+int RmSlottedPage::insert(const char *tuple, int len, RmSlotFlag flag) {
+    int slot_no = find_empty_slot();
+    if (slot_no == -1) {
+        slot_no = hdr_->num_slots;
+    }
+    insert_at(slot_no, tuple, len, flag);
+    return slot_no;
+}
+
+int RmSlottedPage::next_free_slot(int curr) const {
+    for (int i = curr + 1; i < hdr_->num_slots; i++) {
+        if (slots_[i].flag == RM_SLOT_EMPTY) {
+            return i;
+        }
+    }
+    return std::min(std::max(curr + 1, hdr_->num_slots), file_hdr_->num_records_per_page);
+}
+
+bool RmSlottedPage::can_insert_at(int slot_no, int len) const {
+    if (slot_no < hdr_->num_slots) {
+        return slots_[slot_no].flag == RM_SLOT_EMPTY && alloc_len(len) <= free_space();
+    }
+    return slot_no == hdr_->num_slots && slot_no < file_hdr_->num_records_per_page &&
+           alloc_len(len) + (int)sizeof(RmSlot) <= free_space();
+}
+
+void RmSlottedPage::insert_at(int slot_no, const char *tuple, int len, RmSlotFlag flag) {
+    int offset = allocate(alloc_len(len), slot_no == hdr_->num_slots ? sizeof(RmSlot) : 0);
+    if (slot_no == hdr_->num_slots) {
+        hdr_->num_slots++;
+    }
+    RmSlot &slot = slots_[slot_no];
+    slot.offset = offset;
+    slot.len = len;
+    slot.flag = flag;
+    memcpy(data_ + offset, tuple, len);
+}
+
+void RmSlottedPage::update(int slot_no, const char *tuple, int len, RmSlotFlag flag) {
+    RmSlot &slot = slots_[slot_no];
+    int old_alloc = alloc_len(slot.len);
+    int new_alloc = alloc_len(len);
+    if (new_alloc <= old_alloc) {
+        // 原地改写，多出来的空间记为碎片
+        hdr_->frag_bytes += old_alloc - new_alloc;
+    } else {
+        // 先释放旧元组，再重新分配；置为空槽使整理页面时跳过旧元组
+        hdr_->frag_bytes += old_alloc;
+        slot.flag = RM_SLOT_EMPTY;
+        slot.offset = allocate(new_alloc, 0);
+    }
+    slot.len = len;
+    slot.flag = flag;
+    memcpy(data_ + slot.offset, tuple, len);
+}
+
+void RmSlottedPage::erase(int slot_no) {
+    RmSlot &slot = slots_[slot_no];
+    hdr_->frag_bytes += alloc_len(slot.len);
+    slot.offset = 0;
+    slot.len = 0;
+    slot.flag = RM_SLOT_EMPTY;
+    // 槽目录末尾的空槽直接回收
+    while (hdr_->num_slots > 0 && slots_[hdr_->num_slots - 1].flag == RM_SLOT_EMPTY) {
+        hdr_->num_slots--;
+    }
+}
+
+void RmSlottedPage::compact() {
+    char buf[PAGE_SIZE];
+    int end = PAGE_SIZE;
+    for (int i = 0; i < hdr_->num_slots; i++) {
+        RmSlot &slot = slots_[i];
+        if (slot.flag == RM_SLOT_EMPTY) {
+            continue;
+        }
+        int len = alloc_len(slot.len);
+        end -= len;
+        memcpy(buf + end, data_ + slot.offset, len);
+        slot.offset = end;
+    }
+    memcpy(data_ + end, buf + end, PAGE_SIZE - end);
+    hdr_->free_end = end;
+    hdr_->frag_bytes = 0;
+}
+
+int RmSlottedPage::empty_insert_space(const RmFileHdr &file_hdr) {
+    int dir_begin = Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr) + file_hdr.bitmap_size + sizeof(RmSlottedPageHdr);
+    return PAGE_SIZE - dir_begin - (int)sizeof(RmSlot);
+}
+
+int RmSlottedPage::find_empty_slot() const {
+    for (int i = 0; i < hdr_->num_slots; i++) {
+        if (slots_[i].flag == RM_SLOT_EMPTY) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int RmSlottedPage::allocate(int len, int extra) {
+    if (hdr_->free_end - dir_end() < len + extra) {
+        compact();
+    }
+    assert(hdr_->free_end - dir_end() >= len + extra);
+    hdr_->free_end -= len;
+    return hdr_->free_end;
+}
+
+/**
+ * @description: 取出文件头中的字段布局，没有字段信息时把整条记录当作一个CHAR字段
+ */
+static int get_cols(const RmFileHdr &file_hdr, const RmColHdr **cols, RmColHdr *whole) {
+    if (file_hdr.num_cols > 0) {
+        *cols = file_hdr.cols;
+        return file_hdr.num_cols;
+    }
+    *whole = {.offset = 0, .len = file_hdr.record_size, .trim = true};
+    *cols = whole;
+    return 1;
+}
+
+int RmSlottedPage::encode(const RmFileHdr &file_hdr, const char *record, char *tuple) {
+    RmColHdr whole;
+    const RmColHdr *cols;
+    int num_cols = get_cols(file_hdr, &cols, &whole);
+    char *dst = tuple;
+    for (int i = 0; i < num_cols; i++) {
+        const char *src = record + cols[i].offset;
+        if (!cols[i].trim) {
+            memcpy(dst, src, cols[i].len);
+            dst += cols[i].len;
+            continue;
+        }
+        uint16_t len = cols[i].len;
+        while (len > 0 && src[len - 1] == '\0') {
+            len--;
+        }
+        memcpy(dst, &len, sizeof(len));
+        dst += sizeof(len);
+        memcpy(dst, src, len);
+        dst += len;
+    }
+    return dst - tuple;
+}
+
+void RmSlottedPage::decode(const RmFileHdr &file_hdr, const char *tuple, char *record) {
+    RmColHdr whole;
+    const RmColHdr *cols;
+    int num_cols = get_cols(file_hdr, &cols, &whole);
+    memset(record, 0, file_hdr.record_size);
+    const char *src = tuple;
+    for (int i = 0; i < num_cols; i++) {
+        char *dst = record + cols[i].offset;
+        if (!cols[i].trim) {
+            memcpy(dst, src, cols[i].len);
+            src += cols[i].len;
+            continue;
+        }
+        uint16_t len;
+        memcpy(&len, src, sizeof(len));
+        src += sizeof(len);
+        memcpy(dst, src, len);
+        src += len;
+    }
+}
+
+int RmSlottedPage::max_tuple_len(const RmFileHdr &file_hdr) {
+    RmColHdr whole;
+    const RmColHdr *cols;
+    int num_cols = get_cols(file_hdr, &cols, &whole);
+    int len = 0;
+    for (int i = 0; i < num_cols; i++) {
+        len += cols[i].len + (cols[i].trim ? sizeof(uint16_t) : 0);
+    }
+    return len;
+}
+
+int RmSlottedPage::min_tuple_len(const RmFileHdr &file_hdr) {
+    RmColHdr whole;
+    const RmColHdr *cols;
+    int num_cols = get_cols(file_hdr, &cols, &whole);
+    int len = 0;
+    for (int i = 0; i < num_cols; i++) {
+        len += cols[i].trim ? sizeof(uint16_t) : cols[i].len;
+    }
+    return len;
+}
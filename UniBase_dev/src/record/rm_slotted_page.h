@@ -0,0 +1,94 @@
+#pragma once
+
+#include "rm_defs.h"
+
+struct RmPageHandle;
+
+/* 编码后元组的长度上限，用于在栈上分配编码缓冲区 */
+constexpr int RM_MAX_TUPLE_SIZE = RM_MAX_SLOTTED_RECORD_SIZE + RM_MAX_COLS * sizeof(uint16_t);
+
+/**
+ * @description: SLOTTED格式页面的操作封装
+ * 页面布局：| lsn | RmPageHdr | bitmap | RmSlottedPageHdr | RmSlot[num_slots] ... 空闲空间 ... | 元组区 |
+ * 槽号即Rid.slot_no，删除记录只把槽置空，槽号不会因页面整理而改变
+ */
+class RmSlottedPage {
+   public:
+    explicit RmSlottedPage(const RmPageHandle &page_handle);
+
+    /* 初始化一个新分配的页面 */
+    void init();
+
+    RmSlottedPageHdr *hdr() const { return hdr_; }
+
+    RmSlot *get_slot(int slot_no) const { return slots_ + slot_no; }
+
+    char *get_tuple(int slot_no) const { return data_ + slots_[slot_no].offset; }
+
+    /* 页面中能否再放下一个长度为len的元组 */
+    bool can_insert(int len) const;
+
+    /* 新插入一个元组时元组区最多可用的空间（已扣除需要新增的槽目录项） */
+    int insert_space() const;
+
+    /* 空页面的insert_space */
+    static int empty_insert_space(const RmFileHdr &file_hdr);
+
+    /* 把槽slot_no中的元组替换为长度为len的元组后，页面能否放得下 */
+    bool can_update(int slot_no, int len) const;
+
+    /* 插入元组，返回所用的槽号；调用前需要用can_insert检查 */
+    int insert(const char *tuple, int len, RmSlotFlag flag);
+
+    /* curr之后第一个能放新元组的槽号：空槽或槽目录之后的新槽，没有时返回num_records_per_page */
+    int next_free_slot(int curr) const;
+
+    /* 能否把长度为len的元组放到槽slot_no中，slot_no只能是空槽或槽目录末尾的下一个槽 */
+    bool can_insert_at(int slot_no, int len) const;
+
+    /* 把元组插入到指定的槽中，用于插入前已锁住槽号的记录；调用前需要用can_insert_at检查 */
+    void insert_at(int slot_no, const char *tuple, int len, RmSlotFlag flag);
+
+    /* 替换槽slot_no中的元组；调用前需要用can_update检查 */
+    void update(int slot_no, const char *tuple, int len, RmSlotFlag flag);
+
+    /* 删除槽slot_no中的元组，槽变为空槽 */
+    void erase(int slot_no);
+
+    /* 整理元组区，把碎片合并到连续空闲空间中 */
+    void compact();
+
+    /**
+     * @description: 元组编码：非CHAR字段原样拷贝，CHAR字段去掉尾部的'\0'后以2字节长度作为前缀存放
+     * @return {int} 编码后的长度
+     */
+    static int encode(const RmFileHdr &file_hdr, const char *record, char *tuple);
+
+    /* 元组解码，record需要有file_hdr.record_size字节 */
+    static void decode(const RmFileHdr &file_hdr, const char *tuple, char *record);
+
+    /* 编码后元组的最大长度 */
+    static int max_tuple_len(const RmFileHdr &file_hdr);
+
+    /* 编码后元组的最小长度 */
+    static int min_tuple_len(const RmFileHdr &file_hdr);
+
+    /* 元组在元组区中实际占用的空间，至少能容纳一个Rid，保证任何元组都能原地改写为FORWARD槽 */
+    static int alloc_len(int len) { return len < (int)sizeof(Rid) ? (int)sizeof(Rid) : len; }
+
+   private:
+    const RmFileHdr *file_hdr_;
+    char *data_;                // 页面数据首地址
+    char *bitmap_;
+    RmSlottedPageHdr *hdr_;
+    RmSlot *slots_;             // 槽目录首地址
+
+    int dir_end() const { return (reinterpret_cast<char *>(slots_ + hdr_->num_slots)) - data_; }
+
+    int free_space() const { return hdr_->free_end - dir_end() + hdr_->frag_bytes; }
+
+    int find_empty_slot() const;
+
+    /* 在元组区中分配len字节（不含槽目录项），必要时整理页面，返回偏移 */
+    int allocate(int len, int extra);
+};
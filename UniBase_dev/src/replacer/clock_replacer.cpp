@@ -0,0 +1,67 @@
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : in_replacer_(num_pages, false), ref_bits_(num_pages, false), hand_(0), size_(0), max_size_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+
+    if (size_ == 0) {
+        return false;
+    }
+    // 最多扫描两圈：第一圈清零访问位，第二圈一定能找到访问位为0的frame
+    while (true) {
+        if (in_replacer_[hand_]) {
+            if (ref_bits_[hand_]) {
+                ref_bits_[hand_] = false;
+            } else {
+                *frame_id = static_cast<frame_id_t>(hand_);
+                in_replacer_[hand_] = false;
+                size_--;
+                hand_ = (hand_ + 1) % max_size_;
+                return true;
+            }
+        }
+        hand_ = (hand_ + 1) % max_size_;
+    }
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = false;
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时置访问位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (!in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = true;
+        size_++;
+    }
+    ref_bits_[frame_id] = true;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
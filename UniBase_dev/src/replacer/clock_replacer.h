@@ -0,0 +1,37 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK(second chance)替换策略
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    std::mutex latch_;                  // 互斥锁
+    std::vector<bool> in_replacer_;     // frame是否处于可被淘汰的状态
+    std::vector<bool> ref_bits_;        // frame的访问位，指针扫过时若为1则清零并跳过
+    size_t hand_;                       // 时钟指针
+    size_t size_;                       // 当前可被淘汰的frame数量
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
@@ -76,6 +76,8 @@ Page *BufferPoolManager::fetch_page(PageId page_id) {
     } else {
         this->pages_[id].pin_count_ = 1;
     }
+    // 页面已被pin住才记录，没有可用帧而失败的请求不算一次访问
+    trace(BpmTraceOp::FETCH, page_id);
 
     return &this->pages_[id];
 }
@@ -88,6 +90,7 @@ Page *BufferPoolManager::fetch_page(PageId page_id) {
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     std::scoped_lock lock{latch_};
+    trace(BpmTraceOp::UNPIN, page_id);
     if (this->page_table_.find(page_id) == this->page_table_.end()) {
         return false;
     }
@@ -140,6 +143,7 @@ Page *BufferPoolManager::new_page(PageId *page_id) {
         this->update_page(&this->pages_[id], *page_id, id);  //更新page
         this->replacer_->pin(id);
         this->pages_[id].pin_count_ = 1;
+        trace(BpmTraceOp::NEW, *page_id);
     } else {
         return nullptr;
     }
@@ -153,6 +157,7 @@ Page *BufferPoolManager::new_page(PageId *page_id) {
  */
 bool BufferPoolManager::delete_page(PageId page_id) {
     std::scoped_lock lock{latch_};
+    trace(BpmTraceOp::DELETE, page_id);
 
     if (this->page_table_.find(page_id) == this->page_table_.end()) {
         return true;
@@ -182,4 +187,22 @@ void BufferPoolManager::flush_all_pages(int fd) {
             page->is_dirty_ = false;
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 开启访问轨迹记录，之后的fetch/unpin/new/delete操作都会以二进制格式写入path，
+ *              可用replacer_trace_bench离线回放
+ * @param {string&} path 轨迹文件路径，已存在则覆盖
+ */
+void BufferPoolManager::start_trace(const std::string &path) {
+    std::scoped_lock lock{latch_};
+    tracer_ = std::make_unique<BpmTraceWriter>(path);
+}
+
+/**
+ * @description: 停止访问轨迹记录，并将缓冲的记录写入文件
+ */
+void BufferPoolManager::stop_trace() {
+    std::scoped_lock lock{latch_};
+    tracer_.reset();
+}
@@ -4,12 +4,15 @@
 
 #include <cassert>
 #include <list>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "disk_manager.h"
+#include "buffer_pool_trace.h"
 #include "errors.h"
 #include "page.h"
+#include "replacer/clock_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
 
@@ -22,6 +25,7 @@ class BufferPoolManager {
     DiskManager *disk_manager_;
     Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
     std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::unique_ptr<BpmTraceWriter> tracer_;    // 访问轨迹记录器，为空表示未开启轨迹记录
 
    public:
     BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
@@ -29,10 +33,10 @@ class BufferPoolManager {
         // 为buffer pool分配一块连续的内存空间
         pages_ = new Page[pool_size_];
         // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
+        if (REPLACER_TYPE == "LRU")
             replacer_ = new LRUReplacer(pool_size_);
+        else if (REPLACER_TYPE == "CLOCK")
+            replacer_ = new ClockReplacer(pool_size_);
         else {
             replacer_ = new LRUReplacer(pool_size_);
         }
@@ -66,7 +70,18 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void start_trace(const std::string& path);
+
+    void stop_trace();
+
    private:
+    /**
+     * @description: 开启轨迹记录时追加一条访问记录，调用者需持有latch_
+     */
+    void trace(BpmTraceOp op, const PageId& page_id) {
+        if (tracer_ != nullptr) tracer_->append(op, page_id);
+    }
+
     bool find_victim_page(frame_id_t* frame_id);
 
     void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
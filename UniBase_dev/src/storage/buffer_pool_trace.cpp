@@ -0,0 +1,70 @@
+#include "buffer_pool_trace.h"
+
+#include <cstring>
+
+#include "errors.h"
+
+BpmTraceWriter::BpmTraceWriter(const std::string &path) : ofs_(path, std::ios::out | std::ios::binary | std::ios::trunc) {
+    if (!ofs_.is_open()) {
+        throw UnixError();
+    }
+    ofs_.write(BPM_TRACE_MAGIC, sizeof(BPM_TRACE_MAGIC));
+    buf_.reserve(FLUSH_THRESHOLD + BPM_TRACE_RECORD_SIZE);
+}
+
+BpmTraceWriter::~BpmTraceWriter() { flush(); }
+
+/**
+ * @description: 追加一条访问记录，缓冲区满时写入文件
+ * @param {BpmTraceOp} op 操作类型
+ * @param {PageId&} page_id 被访问的页面
+ */
+void BpmTraceWriter::append(BpmTraceOp op, const PageId &page_id) {
+    char rec[BPM_TRACE_RECORD_SIZE];
+    rec[0] = static_cast<char>(op);
+    int32_t fd = page_id.fd;
+    memcpy(rec + sizeof(uint8_t), &fd, sizeof(int32_t));
+    memcpy(rec + sizeof(uint8_t) + sizeof(int32_t), &page_id.page_no, sizeof(page_id_t));
+    buf_.insert(buf_.end(), rec, rec + BPM_TRACE_RECORD_SIZE);
+    if (buf_.size() >= FLUSH_THRESHOLD) {
+        flush();
+    }
+}
+
+void BpmTraceWriter::flush() {
+    if (!buf_.empty()) {
+        ofs_.write(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+    ofs_.flush();
+}
+
+BpmTraceReader::BpmTraceReader(const std::string &path) : ifs_(path, std::ios::in | std::ios::binary) {
+    if (!ifs_.is_open()) {
+        throw FileNotFoundError(path);
+    }
+    char magic[sizeof(BPM_TRACE_MAGIC)];
+    ifs_.read(magic, sizeof(magic));
+    if (ifs_.gcount() != sizeof(magic) || memcmp(magic, BPM_TRACE_MAGIC, sizeof(magic)) != 0) {
+        throw InternalError("BpmTraceReader: " + path + " is not a buffer pool trace file");
+    }
+}
+
+/**
+ * @description: 读取下一条访问记录
+ * @return {bool} 读到记录返回true，到达文件末尾返回false
+ * @param {BpmTraceRecord*} record 读取到的记录
+ */
+bool BpmTraceReader::next(BpmTraceRecord *record) {
+    char rec[BPM_TRACE_RECORD_SIZE];
+    ifs_.read(rec, BPM_TRACE_RECORD_SIZE);
+    if (ifs_.gcount() != BPM_TRACE_RECORD_SIZE) {
+        return false;
+    }
+    int32_t fd;
+    record->op = static_cast<BpmTraceOp>(rec[0]);
+    memcpy(&fd, rec + sizeof(uint8_t), sizeof(int32_t));
+    memcpy(&record->page_id.page_no, rec + sizeof(uint8_t) + sizeof(int32_t), sizeof(page_id_t));
+    record->page_id.fd = fd;
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "page.h"
+
+/* 缓冲池访问轨迹中记录的操作类型 */
+enum class BpmTraceOp : uint8_t { FETCH = 0, UNPIN, NEW, DELETE };
+
+/* 访问轨迹中的一条记录，磁盘上按 | op(1B) | fd(4B) | page_no(4B) | 紧凑存放 */
+struct BpmTraceRecord {
+    BpmTraceOp op;
+    PageId page_id;
+};
+
+/* 轨迹文件头部的魔数和记录大小 */
+static constexpr char BPM_TRACE_MAGIC[4] = {'U', 'B', 'T', 'R'};
+static constexpr int BPM_TRACE_RECORD_SIZE = sizeof(uint8_t) + sizeof(int32_t) + sizeof(page_id_t);
+
+/**
+ * @description: 将缓冲池的访问轨迹以二进制格式写入文件，内部带缓冲，非线程安全，由BufferPoolManager的latch_保护
+ */
+class BpmTraceWriter {
+   public:
+    explicit BpmTraceWriter(const std::string &path);
+
+    ~BpmTraceWriter();
+
+    void append(BpmTraceOp op, const PageId &page_id);
+
+    void flush();
+
+   private:
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    std::ofstream ofs_;
+    std::vector<char> buf_;
+};
+
+/**
+ * @description: 顺序读取BpmTraceWriter写出的轨迹文件
+ */
+class BpmTraceReader {
+   public:
+    explicit BpmTraceReader(const std::string &path);
+
+    bool next(BpmTraceRecord *record);
+
+   private:
+    std::ifstream ifs_;
+};
@@ -62,6 +62,18 @@ page_id_t DiskManager::allocate_page(int fd) {
 
 void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
 
+/**
+ * @description: 把文件截断为前num_pages个页面，之后从num_pages开始分配页面编号
+ * @param {int} fd 文件句柄
+ * @param {int} num_pages 保留的页面个数
+ */
+void DiskManager::truncate_file(int fd, int num_pages) {
+    if (ftruncate(fd, (off_t)num_pages * PAGE_SIZE) < 0) {
+        throw UnixError();
+    }
+    fd2pageno_[fd] = num_pages;
+}
+
 bool DiskManager::is_dir(const std::string &path) {
     struct stat st;
     return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
@@ -30,6 +30,8 @@ class DiskManager {
 
     void deallocate_page(page_id_t page_id);
 
+    void truncate_file(int fd, int num_pages);
+
     /*目录操作*/
     bool is_dir(const std::string &path);
 
@@ -3,3 +3,4 @@
 #include "sm_manager.h"
 #include "sm_meta.h"
 #include "sm_defs.h"
+#include "sm_dict.h"
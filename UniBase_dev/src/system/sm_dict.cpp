@@ -0,0 +1,113 @@
+#include "sm_dict.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+int ColDict::lookup(const std::string &val) const {
+    std::shared_lock lock{latch_};
+    auto pos = codes_.find(val);
+    return pos == codes_.end() ? NO_CODE : pos->second;
+}
+
+/**
+ * @description: 大部分插入的值已经在字典中，先只加读锁查找；不存在时加写锁再查一次，避免并发插入同一个值时分配两个编码
+ * @param {string&} val 字段的值，不含末尾补齐的'\0'
+ * @return {int} 值对应的编码
+ */
+int ColDict::encode(const std::string &val) {
+    int code = lookup(val);
+    if (code != NO_CODE) {
+        return code;
+    }
+    std::unique_lock lock{latch_};
+    auto pos = codes_.find(val);
+    if (pos != codes_.end()) {
+        return pos->second;
+    }
+    // 先写文件再放入字典，写文件失败时字典中不会出现没有持久化的编码
+    owner_->append(col_no_, val);
+    return add(val);
+}
+
+const std::string &ColDict::decode(int code) const {
+    std::shared_lock lock{latch_};
+    if (code < 0 || code >= (int)values_.size()) {
+        throw InternalError("ColDict::decode: Invalid dictionary code");
+    }
+    return values_[code];
+}
+
+int ColDict::size() const {
+    std::shared_lock lock{latch_};
+    return values_.size();
+}
+
+int ColDict::add(const std::string &val) {
+    int code = values_.size();
+    values_.push_back(val);
+    codes_.emplace(val, code);
+    return code;
+}
+
+/**
+ * @description: 打开表的字典文件并重放其中的编码，文件末尾不完整的一项（写到一半时崩溃）被忽略
+ * @param {string&} tab_name 表名称
+ * @param {vector<ColMeta>&} cols 表的字段
+ */
+SmDict::SmDict(const std::string &tab_name, const std::vector<ColMeta> &cols) {
+    std::vector<ColDict *> dicts(cols.size(), nullptr);
+    for (size_t i = 0; i < cols.size(); i++) {
+        if (cols[i].is_dict()) {
+            auto dict = std::unique_ptr<ColDict>(new ColDict(this, i));
+            dicts[i] = dict.get();
+            col_dicts_.emplace(cols[i].name, std::move(dict));
+        }
+    }
+
+    std::string file_name = get_file_name(tab_name);
+    std::ifstream ifs(file_name, std::ios::binary);
+    std::streamoff valid_len = 0;
+    int entry[2];   // col_no, len
+    while (ifs.read(reinterpret_cast<char *>(entry), sizeof(entry))) {
+        if (entry[0] < 0 || entry[0] >= (int)dicts.size() || dicts[entry[0]] == nullptr || entry[1] < 0) {
+            break;
+        }
+        std::string val(entry[1], '\0');
+        if (!ifs.read(val.data(), entry[1])) {
+            break;
+        }
+        dicts[entry[0]]->add(val);
+        valid_len = ifs.tellg();
+    }
+    bool exists = ifs.is_open();
+    ifs.close();
+
+    if (exists && truncate(file_name.c_str(), valid_len) < 0) {
+        throw UnixError();
+    }
+    file_.open(file_name, std::ios::binary | std::ios::app);
+    if (!file_.is_open()) {
+        throw UnixError();
+    }
+}
+
+bool SmDict::has_dict_col(const std::vector<ColMeta> &cols) {
+    return std::any_of(cols.begin(), cols.end(), [](const ColMeta &col) { return col.is_dict(); });
+}
+
+ColDict *SmDict::get_col_dict(const std::string &col_name) const {
+    auto pos = col_dicts_.find(col_name);
+    return pos == col_dicts_.end() ? nullptr : pos->second.get();
+}
+
+void SmDict::append(int col_no, const std::string &val) {
+    std::scoped_lock lock{file_latch_};
+    int entry[2] = {col_no, (int)val.size()};
+    file_.write(reinterpret_cast<const char *>(entry), sizeof(entry));
+    file_.write(val.data(), val.size());
+    file_.flush();
+    if (!file_) {
+        throw UnixError();
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sm_meta.h"
+
+class SmDict;
+
+/**
+ * @description: 一个字典编码字段的字典
+ * 编码从0开始按值第一次出现的顺序分配，只增不减，因此编码的大小关系与字符串的大小关系无关，
+ * 只有等值比较可以直接比较编码
+ */
+class ColDict {
+    friend class SmDict;
+
+   public:
+    static constexpr int NO_CODE = -1;  // 不在字典中的值，不等于任何记录中的编码
+
+    /* 查找值对应的编码，不存在时返回NO_CODE */
+    int lookup(const std::string &val) const;
+
+    /* 取出值对应的编码，不存在时分配一个新编码并写入字典文件 */
+    int encode(const std::string &val);
+
+    /* 编码对应的值；返回的引用在字典的生命周期内一直有效 */
+    const std::string &decode(int code) const;
+
+    /* 字典中值的个数 */
+    int size() const;
+
+   private:
+    ColDict(SmDict *owner, int col_no) : owner_(owner), col_no_(col_no) {}
+
+    /* 不加锁、不写文件地追加一个值，由打开字典文件时重放 */
+    int add(const std::string &val);
+
+    SmDict *owner_;
+    int col_no_;                                    // 字段在表中的序号，写入字典文件用
+    mutable std::shared_mutex latch_;
+    std::deque<std::string> values_;                // code -> value，deque追加时不会使已有元素的引用失效
+    std::unordered_map<std::string, int> codes_;    // value -> code
+};
+
+/**
+ * @description: 一张表上所有字典编码字段的字典，与表的元数据一起放在数据库目录下
+ * 字典文件只追加：每分配一个新编码就写入一项 | col_no | len | value |，打开时按顺序重放即可恢复编码
+ */
+class SmDict {
+    friend class ColDict;
+
+   public:
+    /**
+     * @description: 打开表的字典文件，不存在时创建
+     * @param {string&} tab_name 表名称
+     * @param {vector<ColMeta>&} cols 表的字段，只为其中的字典编码字段建立字典
+     */
+    SmDict(const std::string &tab_name, const std::vector<ColMeta> &cols);
+
+    static std::string get_file_name(const std::string &tab_name) { return tab_name + ".dict"; }
+
+    /* 表中是否有字典编码字段 */
+    static bool has_dict_col(const std::vector<ColMeta> &cols);
+
+    /* 字段col的字典，col不是字典编码字段时返回nullptr */
+    ColDict *get_col_dict(const std::string &col_name) const;
+
+   private:
+    /* 把新分配的编码追加到字典文件中 */
+    void append(int col_no, const std::string &val);
+
+    std::unordered_map<std::string, std::unique_ptr<ColDict>> col_dicts_;  // col name -> 字段的字典
+    std::mutex file_latch_;
+    std::ofstream file_;
+};
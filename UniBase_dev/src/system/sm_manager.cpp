@@ -3,9 +3,12 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 
+#include "common/parallel.h"
 #include "index/ix.h"
+#include "index/ix_sorter.h"
 #include "record/rm.h"
 #include "record_printer.h"
 
@@ -86,14 +89,13 @@ void SmManager::open_db(const std::string &db_name) {
     for (auto &entry : db_.tabs_) {
         auto &tab = entry.second;
         fhs_.emplace(tab.name, rm_manager_->open_file(tab.name));
-        for (size_t i = 0; i < tab.cols.size(); i++) {
-            auto &col = tab.cols[i];
-            if (col.index) {
-                std::vector<ColMeta> index_cols = {col};
-                auto index_name = ix_manager_->get_index_name(tab.name, index_cols);
-                assert(ihs_.count(index_name) == 0);
-                ihs_.emplace(index_name, ix_manager_->open_index(tab.name, index_cols));
-            }
+        if (SmDict::has_dict_col(tab.cols)) {
+            dicts_.emplace(tab.name, std::make_unique<SmDict>(tab.name, tab.cols));
+        }
+        for (auto &index : tab.indexes) {
+            auto index_name = ix_manager_->get_index_name(tab.name, index.cols);
+            assert(ihs_.count(index_name) == 0);
+            ihs_.emplace(index_name, ix_manager_->open_index(tab.name, index.cols));
         }
     }
 }
@@ -134,6 +136,8 @@ void SmManager::close_db() {
 
         ihs_.clear();
 
+        dicts_.clear();
+
         db_ = DbMeta();
         std::cout << "Database closed successfully." << std::endl;
     } catch (const std::exception &e) {
@@ -179,7 +183,8 @@ void SmManager::desc_table(const std::string &tab_name, Context *context) {
     printer.print_separator(context);
     // Print fields
     for (auto &col : tab.cols) {
-        std::vector<std::string> field_info = {col.name, coltype2str(col.type), col.index ? "YES" : "NO"};
+        std::string type = col.is_dict() ? coltype2str(col.type) + " DICT" : coltype2str(col.type);
+        std::vector<std::string> field_info = {col.name, type, col.index ? "YES" : "NO"};
         printer.print_record(field_info, context);
     }
     // Print footer
@@ -191,8 +196,10 @@ void SmManager::desc_table(const std::string &tab_name, Context *context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context
+ * @param {RmStorageType} storage_type 表数据文件的页面组织方式
  */
-void SmManager::create_table(const std::string &tab_name, const std::vector<ColDef> &col_defs, Context *context) {
+void SmManager::create_table(const std::string &tab_name, const std::vector<ColDef> &col_defs, Context *context,
+                             RmStorageType storage_type) {
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -201,13 +208,16 @@ void SmManager::create_table(const std::string &tab_name, const std::vector<ColD
     TabMeta tab;
     tab.name = tab_name;
     for (auto &col_def : col_defs) {
+        // 字典编码字段在记录中只存放编码
+        bool dict = col_def.dict && col_def.type == TYPE_STRING;
         ColMeta col = {.tab_name = tab_name,
                        .name = col_def.name,
                        .type = col_def.type,
-                       .len = col_def.len,
+                       .len = dict ? (int)sizeof(int) : col_def.len,
                        .offset = curr_offset,
-                       .index = false};
-        curr_offset += col_def.len;
+                       .index = false,
+                       .dict_len = dict ? col_def.len : 0};
+        curr_offset += col.len;
         tab.cols.push_back(col);
     }
     // Create & open record file
@@ -219,10 +229,22 @@ void SmManager::create_table(const std::string &tab_name, const std::vector<ColD
             throw UnixError();
         }
     }
-    rm_manager_->create_file(tab_name, record_size);
+    std::vector<RmColHdr> col_hdrs;
+    for (auto &col : tab.cols) {
+        col_hdrs.push_back({.offset = col.offset, .len = col.len, .trim = col.type == TYPE_STRING && !col.is_dict()});
+    }
+    rm_manager_->create_file(tab_name, record_size, storage_type, col_hdrs);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
+    if (SmDict::has_dict_col(tab.cols)) {
+        // 同名表被删除后残留的字典文件不能沿用
+        std::string dict_file = SmDict::get_file_name(tab_name);
+        if (disk_manager_->is_file(dict_file)) {
+            disk_manager_->destroy_file(dict_file);
+        }
+        dicts_.emplace(tab_name, std::make_unique<SmDict>(tab_name, tab.cols));
+    }
 
     flush_meta();
 }
@@ -240,10 +262,12 @@ void SmManager::drop_table(const std::string &tab_name, Context *context) {
 
     TabMeta &tab = db_.get_table(tab_name);
 
-    for (auto &index_meta : tab.indexes) {
+    // drop_index会从tab.indexes中删除索引，遍历副本
+    auto indexes = tab.indexes;
+    for (auto &index_meta : indexes) {
         std::vector<std::string> col_names;
-        for (auto &col : index_meta.cols) {
-            col_names.push_back(col.name);
+        for (size_t i = 0; i < index_meta.key_num(); i++) {
+            col_names.push_back(index_meta.cols[i].name);
         }
         drop_index(tab_name, col_names, context);
     }
@@ -253,7 +277,12 @@ void SmManager::drop_table(const std::string &tab_name, Context *context) {
         rm_manager_->close_file(fhs_[data_file_name].get());
         fhs_.erase(data_file_name);
     }
-    disk_manager_->destroy_file(data_file_name);
+    rm_manager_->destroy_file(data_file_name);
+
+    if (dicts_.count(tab_name)) {
+        dicts_.erase(tab_name);
+        disk_manager_->destroy_file(SmDict::get_file_name(tab_name));
+    }
 
     db_.tabs_.erase(tab_name);
 
@@ -261,59 +290,225 @@ void SmManager::drop_table(const std::string &tab_name, Context *context) {
 }
 
 /**
- * @description: 创建索引
+ * @description: 创建索引，表中已有记录时扫描全表，把(key, rid)排序后自底向上批量建树
+ * 大表由多个线程分别扫描一段页面并生成有序的run，归并和建立叶子结点也按key的范围分给多个线程
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {bool} unique 是否为唯一索引，唯一索引的字段上有重复的值时建立失败
+ * @param {vector<string>&} include_col_names INCLUDE字段，值随key存放在叶子中，使只涉及这些字段的查询不需要读取记录
+ * @param {IndexType} type 索引的类型，哈希索引的键值对逐个插入哈希表
  */
-void SmManager::create_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context) {
+void SmManager::create_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context,
+                             bool unique, const std::vector<std::string> &include_col_names, IndexType type) {
     TabMeta &tab = db_.get_table(tab_name);
 
-    for (const auto &col_name : col_names) {
-        auto col = tab.get_col(col_name);
-        if (col->index) {
-            throw IndexExistsError(tab_name, col_names);
-        }
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
     }
 
-    std::vector<ColMeta> index_cols;
-    for (const auto &col_name : col_names) {
+    std::vector<std::string> all_col_names = col_names;
+    all_col_names.insert(all_col_names.end(), include_col_names.begin(), include_col_names.end());
+    // 索引文件按全部字段命名，(a) INCLUDE (b)与(a, b)不能同时存在
+    if (ix_manager_->exists(tab_name, all_col_names)) {
+        throw IndexExistsError(tab_name, all_col_names);
+    }
+
+    IndexMeta index_meta = {.tab_name = tab_name,
+                            .col_tot_len = 0,
+                            .col_num = (int)all_col_names.size(),
+                            .cols = {},
+                            .unique = unique,
+                            .include_num = (int)include_col_names.size(),
+                            .type = type};
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    for (const auto &col_name : all_col_names) {
         auto col = tab.get_col(col_name);
-        index_cols.push_back(*col);
+        index_meta.cols.push_back(*col);
+        // 字典编码字段的键是编码，按int比较；编码的顺序与字符串无关，这类索引只适合等值查找
+        if (col->is_dict()) {
+            index_meta.cols.back().type = TYPE_INT;
+        }
+        index_meta.col_tot_len += col->len;
+        col_types.push_back(index_meta.cols.back().type);
+        col_lens.push_back(col->len);
     }
-    ix_manager_->create_index(tab_name, index_cols);
+    ix_manager_->create_index(tab_name, index_meta.cols, unique, index_meta.include_num, type);
+    std::unique_ptr<IxIndexHandle> ih;
+    try {
+        ih = ix_manager_->open_index(tab_name, index_meta.cols);
+        build_index(tab_name, index_meta, col_types, col_lens, ih.get(), context);
+    } catch (...) {
+        // 中途失败（已有记录中key重复、加锁失败、磁盘错误等）时删掉建了一半的索引文件
+        if (ih != nullptr) {
+            ix_manager_->close_index(ih.get());
+        }
+        ix_manager_->destroy_index(tab_name, index_meta.cols);
+        throw;
+    }
+
+    ihs_.emplace(ix_manager_->get_index_name(tab_name, index_meta.cols), std::move(ih));
+    tab.indexes.push_back(index_meta);
     for (const auto &col_name : col_names) {
-        auto col = tab.get_col(col_name);
-        col->index = true;
+        tab.get_col(col_name)->index = true;
     }
 
     flush_meta();
 }
 
+/**
+ * @description: 扫描表中已有的记录，排序后批量装入新建的空索引
+ * @param {string&} tab_name 表名称
+ * @param {IndexMeta&} index_meta 索引元数据
+ * @param {vector<ColType>&} col_types 索引各字段的类型
+ * @param {vector<int>&} col_lens 索引各字段的长度
+ * @param {IxIndexHandle*} ih 新建的索引
+ * @param {Context*} context
+ */
+void SmManager::build_index(const std::string &tab_name, const IndexMeta &index_meta,
+                            const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                            IxIndexHandle *ih, Context *context) {
+    // 建索引期间不允许修改表，否则扫描之后插入的记录不在索引中
+    RmFileHandle *fh = fhs_.at(tab_name).get();
+    if (context != nullptr && context->lock_mgr_ != nullptr) {
+        context->lock_mgr_->lock_shared_on_table(context->txn_, fh->GetFd());
+    }
+    // 按页面范围把表分给多个线程，每个线程取出自己范围内记录的key并生成有序的run
+    int num_pages = fh->get_file_hdr().num_pages - RM_FIRST_RECORD_PAGE;
+    size_t num_workers = num_pages >= IX_BUILD_PARALLEL_MIN_PAGES ? default_num_workers() : 1;
+    std::vector<std::unique_ptr<IxSorter>> sorters(num_workers);
+    parallel_for(num_workers, [&](size_t w) {
+        int start = RM_FIRST_RECORD_PAGE + (int)(w * num_pages / num_workers);
+        int end = w == num_workers - 1 ? -1 : RM_FIRST_RECORD_PAGE + (int)((w + 1) * num_pages / num_workers);
+        sorters[w] = std::make_unique<IxSorter>(col_types, col_lens, IX_SORT_MEMORY / num_workers);
+        std::vector<char> key(index_meta.col_tot_len);
+        std::vector<Rid> rids;
+        std::vector<const char *> records;
+        for (RmScan scan(fh, start, end); scan.next_page(&rids, &records);) {
+            for (size_t i = 0; i < rids.size(); i++) {
+                int offset = 0;
+                for (auto &col : index_meta.cols) {
+                    memcpy(key.data() + offset, records[i] + col.offset, col.len);
+                    offset += col.len;
+                }
+                sorters[w]->add(key.data(), rids[i]);
+            }
+        }
+        sorters[w]->finish();
+    });
+    IxSorter sorter(col_types, col_lens);
+    for (auto &worker_sorter : sorters) {
+        sorter.absorb(*worker_sorter);
+    }
+    sorter.finish();
+    ih->bulk_load(&sorter, IX_FILL_FACTOR, num_workers);
+}
+
 /**
  * @description: 删除索引
  * @param {string&} tab_name 表名称
- * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {vector<string>&} col_names 索引的key字段名称，不包括INCLUDE字段
  * @param {Context*} context
  */
 void SmManager::drop_index(const std::string &tab_name, const std::vector<std::string> &col_names, Context *context) {
-    TabMeta &tab = db_.tabs_.at(tab_name);
+    TabMeta &tab = db_.get_table(tab_name);
+    if (!tab.is_index(col_names)) {
+        throw IndexNotFoundError(tab_name, col_names);
+    }
 
+    auto index_meta = tab.get_index_meta(col_names);
+    auto index_name = ix_manager_->get_index_name(tab_name, index_meta->cols);
+    ix_manager_->close_index(ihs_.at(index_name).get());
+    ix_manager_->destroy_index(tab_name, index_meta->cols);
+    ihs_.erase(index_name);
+    tab.indexes.erase(index_meta);
+    // 字段上不再是任何索引的key字段时才清除标记
     for (const auto &col_name : col_names) {
-        auto col = tab.get_col(col_name);
+        bool indexed = std::any_of(tab.indexes.begin(), tab.indexes.end(), [&](const IndexMeta &index) {
+            return std::any_of(index.cols.begin(), index.cols.begin() + index.key_num(),
+                               [&](const ColMeta &col) { return col.name == col_name; });
+        });
+        tab.get_col(col_name)->index = indexed;
+    }
+    flush_meta();
+}
 
-        if (!col->index) {
-            throw IndexNotFoundError(tab_name, col_names);
-        }
-        int col_idx = std::distance(tab.cols.begin(), col);
-        auto index_name = ix_manager_->get_index_name(tab_name, std::vector<std::string>{col_name});
-        ix_manager_->close_index(ihs_.at(index_name).get());
+/**
+ * @description: 获取字典编码字段的字典
+ * @param {ColMeta&} col 字段元数据
+ * @return {ColDict*} 字段的字典，字段不是字典编码字段时返回nullptr
+ */
+ColDict *SmManager::get_col_dict(const ColMeta &col) const {
+    if (!col.is_dict()) {
+        return nullptr;
+    }
+    return dicts_.at(col.tab_name)->get_col_dict(col.name);
+}
 
-        ix_manager_->destroy_index(tab_name, std::vector<std::string>{col_name});
-        ihs_.erase(index_name);
-        col->index = false;
+/**
+ * @description: 整理表的数据文件：把文件末尾页面上的记录移动到前面有空闲空间的页面中，再截断末尾的空页面
+ * 每腾空一个页面就截断一次，前面的页面放不下时停止
+ * 第一次截断时加上的表级X锁一直持有到语句结束（VACUUM只能自动提交），整理期间其他事务对这张表的DML和扫描都要等待
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ * @return {int} 截断的页面个数
+ */
+int SmManager::vacuum_table(const std::string &tab_name, Context *context) {
+    // 显式事务回滚时会按原来的rid恢复记录，而VACUUM可能已经把其他记录移到了这些位置上
+    if (context->txn_->get_txn_mode()) {
+        throw VacuumInTransactionError();
     }
-    flush_meta();
+    TabMeta &tab = db_.get_table(tab_name);
+    RmFileHandle *fh = fhs_.at(tab_name).get();
+    std::vector<IxIndexHandle *> ihs;
+    for (auto &index : tab.indexes) {
+        ihs.push_back(ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get());
+    }
+
+    std::vector<char> key;
+    int num_truncated = fh->truncate_empty_pages(context);
+    while (true) {
+        int page_no = fh->get_file_hdr().num_pages - 1;
+        if (page_no <= RM_FIRST_RECORD_PAGE) {
+            break;
+        }
+        bool vacated = true;
+        for (auto &rid : fh->get_relocation_rids(page_no)) {
+            Rid new_rid;
+            std::unique_ptr<RmRecord> record;
+            if (!fh->relocate_record(rid, page_no, context, &new_rid, &record)) {
+                // 记录已被其他事务删除时跳过，前面的页面放不下时停止
+                if (record == nullptr) {
+                    continue;
+                }
+                vacated = false;
+                break;
+            }
+            // 索引项改为指向新位置
+            for (size_t i = 0; i < ihs.size(); i++) {
+                auto &index = tab.indexes[i];
+                key.resize(index.col_tot_len);
+                int offset = 0;
+                for (auto &col : index.cols) {
+                    memcpy(key.data() + offset, record->data + col.offset, col.len);
+                    offset += col.len;
+                }
+                ihs[i]->delete_entry(key.data(), rid, context->txn_);
+                ihs[i]->insert_entry(key.data(), new_rid, context->txn_);
+            }
+        }
+        if (!vacated) {
+            break;
+        }
+        // 腾空的页面又被其他事务插入了记录时截断不了，留到下一次VACUUM
+        int num_pages = fh->truncate_empty_pages(context);
+        if (num_pages == 0) {
+            break;
+        }
+        num_truncated += num_pages;
+    }
+    return num_truncated;
 }
 
 void SmManager::rollback_insert(const std::string &tab_name, const Rid &rid, Context *context) {
@@ -321,9 +516,9 @@ void SmManager::rollback_insert(const std::string &tab_name, const Rid &rid, Con
     auto record = fhs_.at(tab_name).get()->get_record(rid, context);
     for (auto index : tab.indexes) {
         IxIndexHandle *indexHandle = ihs_.at(get_ix_manager()->get_index_name(tab_name, index.cols)).get();
-        for (auto column : index.cols) {
-            indexHandle->delete_entry(record->data + column.offset, nullptr);
-        }
+        std::vector<char> key(index.col_tot_len);
+        index.get_key(record->data, key.data());
+        indexHandle->delete_entry(key.data(), rid, nullptr);
     }
     fhs_.at(tab_name).get()->delete_record(rid, context);
 }
@@ -333,9 +528,9 @@ void SmManager::rollback_delete(const std::string &tab_name, const RmRecord &rec
     auto rid = fhs_.at(tab_name).get()->insert_record(record.data, context);
     for (auto index : tab.indexes) {
         IxIndexHandle *indexHandle = ihs_.at(get_ix_manager()->get_index_name(tab_name, index.cols)).get();
-        for (auto column : index.cols) {
-            indexHandle->insert_entry(record.data + column.offset, rid, context->txn_);
-        }
+        std::vector<char> key(index.col_tot_len);
+        index.get_key(record.data, key.data());
+        indexHandle->insert_entry(key.data(), rid, context->txn_);
     }
 }
 
@@ -344,15 +539,16 @@ void SmManager::rollback_update(const std::string &tab_name, const Rid &rid, con
     auto currentRecord = fhs_.at(tab_name).get()->get_record(rid, context);
     for (auto index : tab.indexes) {
         IxIndexHandle *indexHandle = ihs_.at(get_ix_manager()->get_index_name(tab_name, index.cols)).get();
-        for (auto column : index.cols) {
-            indexHandle->delete_entry(currentRecord->data + column.offset, nullptr);
-        }
+        std::vector<char> key(index.col_tot_len);
+        index.get_key(currentRecord->data, key.data());
+        indexHandle->delete_entry(key.data(), rid, nullptr);
     }
     fhs_.at(tab_name).get()->update_record(rid, record.data, context);
 
     for (auto index : tab.indexes) {
         IxIndexHandle *indexHandle = ihs_.at(get_ix_manager()->get_index_name(tab_name, index.cols)).get();
-        for (auto column : index.cols)
-            indexHandle->insert_entry(record.data + column.offset, rid, context->txn_);
+        std::vector<char> key(index.col_tot_len);
+        index.get_key(record.data, key.data());
+        indexHandle->insert_entry(key.data(), rid, context->txn_);
     }
 }
\ No newline at end of file
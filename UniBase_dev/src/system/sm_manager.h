@@ -3,6 +3,7 @@
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
+#include "sm_dict.h"
 #include "sm_meta.h"
 #include "common/context.h"
 
@@ -12,6 +13,7 @@ struct ColDef {
     std::string name;  // Column name
     ColType type;      // Type of column
     int len;           // Length of column
+    bool dict = false; // 是否对CHAR字段做字典编码
 };
 
 /* 系统管理器，负责元数据管理和DDL语句的执行 */
@@ -20,6 +22,7 @@ class SmManager {
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    std::unordered_map<std::string, std::unique_ptr<SmDict>> dicts_;        // table name -> 表上字典编码字段的字典，只包含有这类字段的表
    private:
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
@@ -58,16 +61,23 @@ class SmManager {
 
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                      RmStorageType storage_type = RM_STORAGE_FIXED);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      bool unique = true, const std::vector<std::string>& include_col_names = {},
+                      IndexType type = INDEX_BTREE);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
 
+    ColDict* get_col_dict(const ColMeta& col) const;
+
+    int vacuum_table(const std::string& tab_name, Context* context);
+
     void rollback_insert(const std::string &tab_name, const Rid &rid, Context *context);
 
     void rollback_delete(const std::string &tab_name, const RmRecord &record, Context *context);
@@ -81,4 +91,8 @@ class SmManager {
     // void rollback_create_index(const std::string &tab_name, const std::string &col_name, Context *context);
 
     // void rollback_drop_index(const std::string &tab_name, const std::string &col_name, Context *context);
+
+   private:
+    void build_index(const std::string& tab_name, const IndexMeta& index_meta, const std::vector<ColType>& col_types,
+                     const std::vector<int>& col_lens, IxIndexHandle* ih, Context* context);
 };
\ No newline at end of file
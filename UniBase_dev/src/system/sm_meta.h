@@ -9,6 +9,16 @@
 #include "errors.h"
 #include "sm_defs.h"
 
+/*
+ * 数据库的磁盘格式版本，写在db.meta开头的"#version"行中；db.meta、表文件头或索引文件头的格式改变时加一
+ * 版本1：最初的格式，db.meta开头没有版本行
+ * 版本2：ColMeta增加dict_len，IndexMeta增加unique、include_num、type；表文件头增加存储格式和字段信息，
+ *        索引文件头增加压缩、唯一、INCLUDE和索引类型等字段
+ * 文件头本身没有版本号，只能打开与当前版本一致的数据库，版本不同时拒绝打开而不是按错误的格式读取
+ */
+constexpr int DB_META_VERSION = 2;
+static const std::string DB_META_VERSION_TAG = "#version";   // 表名和字段名都不能以#开头，不会与版本1的库名混淆
+
 /* 字段元数据 */
 struct ColMeta {
     std::string tab_name;   // 字段所属表名称
@@ -17,15 +27,18 @@ struct ColMeta {
     int len;                // 字段长度
     int offset;             // 字段位于记录中的偏移量
     bool index;             /** unused */
+    int dict_len = 0;       // 字典编码的CHAR字段声明的长度，此时记录中只存放int类型的编码，len为sizeof(int)；为0表示不编码
+
+    bool is_dict() const { return dict_len > 0; }
 
     friend std::ostream &operator<<(std::ostream &os, const ColMeta &col) {
         // ColMeta中有各个基本类型的变量，然后调用重载的这些变量的操作符<<（具体实现逻辑在defs.h）
         return os << col.tab_name << ' ' << col.name << ' ' << col.type << ' ' << col.len << ' ' << col.offset << ' '
-                  << col.index;
+                  << col.index << ' ' << col.dict_len;
     }
 
     friend std::istream &operator>>(std::istream &is, ColMeta &col) {
-        return is >> col.tab_name >> col.name >> col.type >> col.len >> col.offset >> col.index;
+        return is >> col.tab_name >> col.name >> col.type >> col.len >> col.offset >> col.index >> col.dict_len;
     }
 };
 
@@ -34,10 +47,26 @@ struct IndexMeta {
     std::string tab_name;           // 索引所属表名称
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
-    std::vector<ColMeta> cols;      // 索引包含的字段
+    std::vector<ColMeta> cols;      // 索引包含的字段，INCLUDE字段放在最后
+    bool unique = true;             // 是否为唯一索引，非唯一索引中key相同的记录按rid排列
+    int include_num = 0;            // cols末尾的INCLUDE字段的个数，只存放在叶子中，不参与查找和唯一性判断
+    IndexType type = INDEX_BTREE;   // 索引的类型，哈希索引只支持全部key字段上的等值查找
+
+    /* 用于查找的key字段的个数 */
+    size_t key_num() const { return col_num - include_num; }
+
+    /* 从记录中取出索引各字段的值依次放到key中，key的长度为col_tot_len */
+    void get_key(const char *record, char *key) const {
+        int offset = 0;
+        for (auto &col : cols) {
+            memcpy(key + offset, record + col.offset, col.len);
+            offset += col.len;
+        }
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num << " " << index.unique << " "
+           << index.include_num << " " << index.type;
         for(auto& col: index.cols) {
             os << "\n" << col;
         }
@@ -45,7 +74,9 @@ struct IndexMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
-        is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        int type;
+        is >> index.tab_name >> index.col_tot_len >> index.col_num >> index.unique >> index.include_num >> type;
+        index.type = static_cast<IndexType>(type);
         for(int i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
@@ -66,6 +97,7 @@ struct TabMeta {
     TabMeta(const TabMeta &other) {
         name = other.name;
         for(auto col : other.cols) cols.push_back(col);
+        for(auto index : other.indexes) indexes.push_back(index);
     }
 
     /* 判断当前表中是否存在名为col_name的字段 */
@@ -74,26 +106,26 @@ struct TabMeta {
         return pos != cols.end();
     }
 
-    /* 判断当前表上是否建有指定索引，索引包含的字段为col_names */
+    /* 判断当前表上是否建有指定索引，索引的key字段为col_names，不包括INCLUDE字段 */
     bool is_index(const std::vector<std::string>& col_names) const {
         for(auto& index: indexes) {
-            if(index.col_num == col_names.size()) {
+            if(index.key_num() == col_names.size()) {
                 size_t i = 0;
-                for(; i < index.col_num; ++i) {
+                for(; i < index.key_num(); ++i) {
                     if(index.cols[i].name.compare(col_names[i]) != 0)
                         break;
                 }
-                if(i == index.col_num) return true;
+                if(i == index.key_num()) return true;
             }
         }
 
         return false;
     }
 
-    /* 根据字段名称集合获取索引元数据 */
+    /* 根据key字段名称集合获取索引元数据 */
     std::vector<IndexMeta>::iterator get_index_meta(const std::vector<std::string>& col_names) {
         for(auto index = indexes.begin(); index != indexes.end(); ++index) {
-            if((*index).col_num != col_names.size()) continue;
+            if((*index).key_num() != col_names.size()) continue;
             auto& index_cols = (*index).cols;
             size_t i = 0;
             for(; i < col_names.size(); ++i) {
@@ -175,6 +207,7 @@ class DbMeta {
 
     // 重载操作符 <<
     friend std::ostream &operator<<(std::ostream &os, const DbMeta &db_meta) {
+        os << DB_META_VERSION_TAG << ' ' << DB_META_VERSION << '\n';
         os << db_meta.name_ << '\n' << db_meta.tabs_.size() << '\n';
         for (auto &entry : db_meta.tabs_) {
             os << entry.second << '\n';
@@ -184,7 +217,16 @@ class DbMeta {
 
     friend std::istream &operator>>(std::istream &is, DbMeta &db_meta) {
         size_t n;
-        is >> db_meta.name_ >> n;
+        int version = 1;
+        is >> db_meta.name_;
+        if (db_meta.name_ == DB_META_VERSION_TAG) {
+            is >> version >> db_meta.name_;
+        }
+        if (version != DB_META_VERSION) {
+            throw InternalError("Unsupported database format version " + std::to_string(version) + ", expected " +
+                                std::to_string(DB_META_VERSION));
+        }
+        is >> n;
         for (size_t i = 0; i < n; i++) {
             TabMeta tab;
             is >> tab;
@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_hash_index_scan.h"
+#include "execution/executor_index_only_scan.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_insert.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "transaction/concurrency/lock_manager.h"
+
+const std::string TEST_DB_NAME = "IndexScanTest_db";
+const std::string TEST_TAB_NAME = "tab";
+
+struct Row {
+    int id;
+    float score;
+    std::string tag;
+};
+
+class IndexScanTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    std::vector<Row> rows_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+
+        sm_manager_->create_table(TEST_TAB_NAME,
+                                  {{.name = "id", .type = TYPE_INT, .len = 4},
+                                   {.name = "score", .type = TYPE_FLOAT, .len = 4},
+                                   {.name = "tag", .type = TYPE_STRING, .len = 8}},
+                                  nullptr);
+        RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+        // 插入时加的行锁一直不释放，用另一个事务插入，避免扫描时等待自己持有的X锁
+        LockManager insert_lock_manager;
+        Transaction insert_txn(1);
+        Context insert_context(&insert_lock_manager, nullptr, &insert_txn);
+        std::vector<std::string> tags = {"a", "bb", "ccc", "dd", "e"};
+        char buf[16];
+        for (int i = 0; i < 5000; i++) {
+            // id打乱插入顺序，score和tag有大量重复
+            Row row = {.id = (i * 7919) % 5000, .score = (float)((i * 37) % 101) / 4, .tag = tags[i % tags.size()]};
+            memset(buf, 0, sizeof(buf));
+            memcpy(buf, &row.id, sizeof(int));
+            memcpy(buf + 4, &row.score, sizeof(float));
+            memcpy(buf + 8, row.tag.c_str(), row.tag.size());
+            fh->insert_record(buf, &insert_context);
+            rows_.push_back(row);
+        }
+        sm_manager_->create_index(TEST_TAB_NAME, {"id"}, nullptr);
+        sm_manager_->create_index(TEST_TAB_NAME, {"score"}, nullptr, false);
+        sm_manager_->create_index(TEST_TAB_NAME, {"tag", "id"}, nullptr);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    Condition make_cond(const std::string &col_name, CompOp op, Value val) {
+        ColMeta col = *sm_manager_->db_.get_table(TEST_TAB_NAME).get_col(col_name);
+        Condition cond;
+        cond.lhs_col = {.tab_name = TEST_TAB_NAME, .col_name = col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val = std::move(val);
+        cond.rhs_val.init_raw(col.len);
+        return cond;
+    }
+
+    Condition int_cond(const std::string &col_name, CompOp op, int v) {
+        Value val;
+        val.set_int(v);
+        return make_cond(col_name, op, val);
+    }
+
+    Condition float_cond(const std::string &col_name, CompOp op, float v) {
+        Value val;
+        val.set_float(v);
+        return make_cond(col_name, op, val);
+    }
+
+    Condition str_cond(const std::string &col_name, CompOp op, const std::string &v) {
+        Value val;
+        val.set_str(v);
+        return make_cond(col_name, op, val);
+    }
+
+    /* 用索引扫描取出满足条件的记录的id，保持扫描的顺序 */
+    std::vector<int> scan(const std::vector<std::string> &index_cols, const std::vector<Condition> &conds) {
+        IndexScanExecutor exec(sm_manager_.get(), TEST_TAB_NAME, conds, index_cols, context_.get());
+        std::vector<int> ids;
+        for (exec.beginTuple(); !exec.is_end();) {
+            auto rec = exec.Next();
+            ids.push_back(*reinterpret_cast<int *>(rec->data));
+        }
+        return ids;
+    }
+
+    std::vector<int> expect_ids(const std::function<bool(const Row &)> &pred) {
+        std::vector<int> ids;
+        for (auto &row : rows_) {
+            if (pred(row)) {
+                ids.push_back(row.id);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    static std::vector<int> sorted(std::vector<int> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+};
+
+/**
+ * @description: 单字段索引上的范围条件，结果按索引顺序输出
+ */
+TEST_F(IndexScanTest, RangeTest) {
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_GE, 100), int_cond("id", OP_LT, 2345)}),
+              expect_ids([](const Row &r) { return r.id >= 100 && r.id < 2345; }));
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_GT, 100), int_cond("id", OP_LE, 2345)}),
+              expect_ids([](const Row &r) { return r.id > 100 && r.id <= 2345; }));
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_GT, 4990)}), expect_ids([](const Row &r) { return r.id > 4990; }));
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_LE, 10)}), expect_ids([](const Row &r) { return r.id <= 10; }));
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_EQ, 4321)}), std::vector<int>({4321}));
+    // 多个下界取最紧的一个，其余条件在记录上判断
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_GE, 10), int_cond("id", OP_GT, 3000), int_cond("id", OP_NE, 3001),
+                            int_cond("id", OP_LT, 3010)}),
+              expect_ids([](const Row &r) { return r.id > 3000 && r.id < 3010 && r.id != 3001; }));
+    // 不在索引中的字段上的条件在记录视图上判断，只拷贝满足条件的记录
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_LT, 1000), float_cond("score", OP_GT, 20.0f)}),
+              expect_ids([](const Row &r) { return r.id < 1000 && r.score > 20.0f; }));
+    // 上下界矛盾时范围为空
+    EXPECT_TRUE(scan({"id"}, {int_cond("id", OP_GT, 10), int_cond("id", OP_LT, 5)}).empty());
+    EXPECT_TRUE(scan({"id"}, {int_cond("id", OP_GT, 10), int_cond("id", OP_LE, 10)}).empty());
+    EXPECT_TRUE(scan({"id"}, {int_cond("id", OP_GT, 5000)}).empty());
+
+    // 非唯一索引上的浮点数范围
+    EXPECT_EQ(sorted(scan({"score"}, {float_cond("score", OP_GE, 3.5f), float_cond("score", OP_LE, 7.25f)})),
+              expect_ids([](const Row &r) { return r.score >= 3.5f && r.score <= 7.25f; }));
+    EXPECT_EQ(sorted(scan({"score"}, {float_cond("score", OP_EQ, 12.5f)})),
+              expect_ids([](const Row &r) { return r.score == 12.5f; }));
+}
+
+/**
+ * @description: 多字段索引上前导字段等值、下一个字段为范围的条件
+ */
+TEST_F(IndexScanTest, PrefixTest) {
+    EXPECT_EQ(scan({"tag", "id"}, {str_cond("tag", OP_EQ, "ccc"), int_cond("id", OP_GE, 1000),
+                                   int_cond("id", OP_LT, 1500)}),
+              expect_ids([](const Row &r) { return r.tag == "ccc" && r.id >= 1000 && r.id < 1500; }));
+    EXPECT_EQ(scan({"tag", "id"}, {str_cond("tag", OP_EQ, "bb"), int_cond("id", OP_GT, 4000)}),
+              expect_ids([](const Row &r) { return r.tag == "bb" && r.id > 4000; }));
+    EXPECT_EQ(scan({"tag", "id"}, {str_cond("tag", OP_EQ, "e")}), expect_ids([](const Row &r) { return r.tag == "e"; }));
+    // 只有第一个字段上的范围条件
+    EXPECT_EQ(sorted(scan({"tag", "id"}, {str_cond("tag", OP_GT, "bb"), str_cond("tag", OP_LE, "dd")})),
+              expect_ids([](const Row &r) { return r.tag > "bb" && r.tag <= "dd"; }));
+    // 第二个字段上的条件不能确定范围，只在记录上判断
+    EXPECT_EQ(sorted(scan({"tag", "id"}, {int_cond("id", OP_LT, 100)})),
+              expect_ids([](const Row &r) { return r.id < 100; }));
+    EXPECT_TRUE(scan({"tag", "id"}, {str_cond("tag", OP_EQ, "zz")}).empty());
+}
+
+/**
+ * @description: INCLUDE字段存放在索引项中，仅索引扫描由索引项拼出记录，不在索引中的字段为0
+ */
+TEST_F(IndexScanTest, IndexOnlyTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, {"tag"}, nullptr, false, {"score"});
+    sm_manager_->create_index(TEST_TAB_NAME, {"id", "tag"}, nullptr, true, {"score"});
+    // INCLUDE字段不参与索引的查找，(tag)上已经有索引时不能再建
+    EXPECT_THROW(sm_manager_->create_index(TEST_TAB_NAME, {"tag"}, nullptr, false, {"id", "score"}), IndexExistsError);
+
+    auto index_only_scan = [&](const std::vector<std::string> &index_cols, const std::vector<Condition> &conds) {
+        IndexOnlyScanExecutor exec(sm_manager_.get(), TEST_TAB_NAME, conds, index_cols, context_.get());
+        std::vector<Row> rows;
+        for (exec.beginTuple(); !exec.is_end();) {
+            auto rec = exec.Next();
+            rows.push_back({.id = *reinterpret_cast<int *>(rec->data),
+                            .score = *reinterpret_cast<float *>(rec->data + 4),
+                            .tag = std::string(rec->data + 8, strnlen(rec->data + 8, 8))});
+        }
+        return rows;
+    };
+
+    // 条件中的INCLUDE字段在索引项上判断
+    auto rows = index_only_scan({"tag"}, {str_cond("tag", OP_EQ, "dd"), float_cond("score", OP_GE, 10)});
+    std::vector<float> scores, expect_scores;
+    for (auto &row : rows) {
+        EXPECT_EQ(row.tag, "dd");
+        EXPECT_EQ(row.id, 0);
+        scores.push_back(row.score);
+    }
+    for (auto &row : rows_) {
+        if (row.tag == "dd" && row.score >= 10) {
+            expect_scores.push_back(row.score);
+        }
+    }
+    std::sort(scores.begin(), scores.end());
+    std::sort(expect_scores.begin(), expect_scores.end());
+    EXPECT_EQ(scores, expect_scores);
+
+    rows = index_only_scan({"id", "tag"}, {int_cond("id", OP_GE, 1234), int_cond("id", OP_LE, 1300)});
+    ASSERT_EQ(rows.size(), 67);
+    for (auto &row : rows) {
+        auto it = std::find_if(rows_.begin(), rows_.end(), [&](const Row &r) { return r.id == row.id; });
+        EXPECT_EQ(row.score, it->score);
+        EXPECT_EQ(row.tag, it->tag);
+    }
+
+    // 唯一索引只比较键字段，键相同、INCLUDE字段不同也是重复
+    auto &index = *sm_manager_->db_.get_table(TEST_TAB_NAME).get_index_meta({"id", "tag"});
+    auto ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, index.cols)).get();
+    const Row &row = rows_[0];
+    char key[16] = {0};
+    memcpy(key, &row.id, sizeof(int));
+    memcpy(key + 4, row.tag.c_str(), row.tag.size());
+    float score = row.score + 1;
+    memcpy(key + 12, &score, sizeof(float));
+    EXPECT_EQ(ih->insert_entry(key, {.page_no = 100, .slot_no = 0}, txn_.get()), IX_NO_PAGE);
+    std::vector<Rid> result;
+    EXPECT_TRUE(ih->get_value(key, &result, txn_.get()));
+    EXPECT_EQ(result.size(), 1);
+
+    // 非唯一索引按键字段查找时不看INCLUDE字段
+    auto &tag_index = *sm_manager_->db_.get_table(TEST_TAB_NAME).get_index_meta({"tag"});
+    auto tag_ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, tag_index.cols)).get();
+    memset(key, 0, sizeof(key));
+    memcpy(key, "dd", 2);
+    memcpy(key + 8, &score, sizeof(float));
+    result.clear();
+    EXPECT_TRUE(tag_ih->get_value(key, &result, txn_.get()));
+    EXPECT_EQ(result.size(), expect_ids([](const Row &r) { return r.tag == "dd"; }).size());
+}
+
+/**
+ * @description: 仅索引扫描的表S锁与本事务已持有的表IX锁合并为SIX，同一事务先写后扫、先扫后写都不会等待自己
+ */
+TEST_F(IndexScanTest, IndexOnlyOwnLockTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, {"tag"}, nullptr, false, {"score"});
+    RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+    char buf[16] = {0};
+    int id = 5000;
+    memcpy(buf, &id, sizeof(int));
+
+    auto count_dd = [&]() {
+        IndexOnlyScanExecutor exec(sm_manager_.get(), TEST_TAB_NAME, {str_cond("tag", OP_EQ, "dd")}, {"tag"},
+                                   context_.get());
+        size_t count = 0;
+        for (exec.beginTuple(); !exec.is_end(); exec.Next()) {
+            count++;
+        }
+        return count;
+    };
+    size_t expect = expect_ids([](const Row &r) { return r.tag == "dd"; }).size();
+
+    fh->insert_records(buf, 1, context_.get());  // 表IX锁
+    EXPECT_EQ(count_dd(), expect);               // 再加表S锁
+    id++;
+    memcpy(buf, &id, sizeof(int));
+    fh->insert_records(buf, 1, context_.get());  // 持有S锁时再加IX锁
+    EXPECT_EQ(count_dd(), expect);
+}
+
+/**
+ * @description: 哈希索引扫描用全部key字段上的等值条件查找一次，其余条件在记录上判断
+ */
+TEST_F(IndexScanTest, HashIndexTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, {"tag"}, nullptr, false, {}, INDEX_HASH);
+    sm_manager_->create_index(TEST_TAB_NAME, {"score", "id"}, nullptr, true, {}, INDEX_HASH);
+
+    auto hash_scan = [&](const std::vector<std::string> &index_cols, const std::vector<Condition> &conds) {
+        HashIndexScanExecutor exec(sm_manager_.get(), TEST_TAB_NAME, conds, index_cols, context_.get());
+        std::vector<int> ids;
+        for (exec.beginTuple(); !exec.is_end();) {
+            auto rec = exec.Next();
+            ids.push_back(*reinterpret_cast<int *>(rec->data));
+        }
+        return sorted(ids);
+    };
+
+    EXPECT_EQ(hash_scan({"tag"}, {str_cond("tag", OP_EQ, "ccc")}),
+              expect_ids([](const Row &r) { return r.tag == "ccc"; }));
+    EXPECT_EQ(hash_scan({"tag"}, {str_cond("tag", OP_EQ, "a"), int_cond("id", OP_LT, 700)}),
+              expect_ids([](const Row &r) { return r.tag == "a" && r.id < 700; }));
+    EXPECT_TRUE(hash_scan({"tag"}, {str_cond("tag", OP_EQ, "zz")}).empty());
+
+    const Row &row = rows_[1234];
+    EXPECT_EQ(hash_scan({"score", "id"}, {int_cond("id", OP_EQ, row.id), float_cond("score", OP_EQ, row.score)}),
+              std::vector<int>({row.id}));
+    EXPECT_TRUE(hash_scan({"score", "id"}, {int_cond("id", OP_EQ, row.id), float_cond("score", OP_EQ, row.score + 1)})
+                    .empty());
+}
+
+/**
+ * @description: 一条INSERT插入多行时批量写入记录文件，每一行都要插入表上的全部索引
+ */
+TEST_F(IndexScanTest, MultiRowInsertTest) {
+    std::vector<std::vector<Value>> values;
+    for (int id = 5000; id < 5300; id++) {
+        Value id_val, score_val, tag_val;
+        id_val.set_int(id);
+        score_val.set_float(100);
+        tag_val.set_str("multi");
+        values.push_back({id_val, score_val, tag_val});
+        rows_.push_back({.id = id, .score = 100, .tag = "multi"});
+    }
+    // 与SetUp中一样用另一个事务插入
+    LockManager insert_lock_manager;
+    Transaction insert_txn(2);
+    Context insert_context(&insert_lock_manager, nullptr, &insert_txn);
+    InsertExecutor exec(sm_manager_.get(), TEST_TAB_NAME, values, &insert_context);
+    exec.Next();
+
+    EXPECT_EQ(scan({"id"}, {int_cond("id", OP_GE, 4990)}), expect_ids([](const Row &r) { return r.id >= 4990; }));
+    EXPECT_EQ(sorted(scan({"score"}, {float_cond("score", OP_EQ, 100)})),
+              expect_ids([](const Row &r) { return r.score == 100; }));
+    EXPECT_EQ(scan({"tag", "id"}, {str_cond("tag", OP_EQ, "multi")}),
+              expect_ids([](const Row &r) { return r.tag == "multi"; }));
+
+    // 任何一行的值个数与表的字段数不符都不插入
+    values[1].pop_back();
+    EXPECT_THROW(InsertExecutor(sm_manager_.get(), TEST_TAB_NAME, values, &insert_context), InvalidValueCountError);
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_seq_scan.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "transaction/concurrency/lock_manager.h"
+
+const std::string TEST_DB_NAME = "SeqScanTest_db";
+const std::string TEST_TAB_NAME = "tab";
+constexpr int TEST_PAD_LEN = 100;
+
+class SeqScanTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    int num_records_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+
+        sm_manager_->create_table(TEST_TAB_NAME,
+                                  {{.name = "id", .type = TYPE_INT, .len = 4},
+                                   {.name = "pad", .type = TYPE_STRING, .len = TEST_PAD_LEN}},
+                                  nullptr);
+        RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+        // 插入时立即释放行锁，扫描时不会等待
+        Transaction insert_txn(1, IsolationLevel::REPEATABLE_READ);
+        Context insert_context(lock_manager_.get(), nullptr, &insert_txn);
+        int record_size = fh->get_file_hdr().record_size;
+        int per_page = fh->get_file_hdr().num_records_per_page;
+        // 页数比并行扫描的下限多出几个morsel，最后一个morsel不满
+        num_records_ = per_page * (SEQ_SCAN_PARALLEL_MIN_PAGES + 3 * SEQ_SCAN_MORSEL_PAGES + 7);
+        std::vector<char> bufs((size_t)num_records_ * record_size, 0);
+        for (int i = 0; i < num_records_; i++) {
+            int id = (i * 7919) % num_records_;
+            memcpy(bufs.data() + (size_t)i * record_size, &id, sizeof(int));
+        }
+        fh->insert_records(bufs.data(), num_records_, &insert_context);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    Condition int_cond(const std::string &col_name, CompOp op, int v) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = TEST_TAB_NAME, .col_name = col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val.set_int(v);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+
+    /* 扫描一遍，返回依次输出的记录的id和rid */
+    static std::vector<std::pair<int, Rid>> scan(SeqScanExecutor *exec) {
+        std::vector<std::pair<int, Rid>> result;
+        for (exec->beginTuple(); !exec->is_end();) {
+            Rid rid = exec->rid();
+            auto rec = exec->Next();
+            result.emplace_back(*reinterpret_cast<int *>(rec->data), rid);
+        }
+        return result;
+    }
+
+    static std::vector<std::pair<int, Rid>> sorted(std::vector<std::pair<int, Rid>> result) {
+        std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        return result;
+    }
+};
+
+/**
+ * @description: 保序的并行扫描与串行扫描输出的记录及顺序完全相同
+ */
+TEST_F(SeqScanTest, KeepOrderTest) {
+    for (auto conds : std::vector<std::vector<Condition>>{{}, {int_cond("id", OP_LT, num_records_ / 3)}}) {
+        SeqScanExecutor serial(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 1);
+        SeqScanExecutor parallel(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 4, true);
+        auto expect = scan(&serial);
+        auto result = scan(&parallel);
+        EXPECT_FALSE(serial.is_parallel());
+        EXPECT_TRUE(parallel.is_parallel());
+        EXPECT_EQ(result, expect);
+        EXPECT_EQ(expect.size(), conds.empty() ? (size_t)num_records_ : (size_t)(num_records_ + 2) / 3);
+    }
+}
+
+/**
+ * @description: 不保序的并行扫描输出的记录集合与串行扫描相同
+ */
+TEST_F(SeqScanTest, UnorderedTest) {
+    for (auto conds : std::vector<std::vector<Condition>>{{}, {int_cond("id", OP_GE, num_records_ / 2)}}) {
+        SeqScanExecutor serial(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 1);
+        SeqScanExecutor parallel(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 4, false);
+        auto expect = scan(&serial);
+        auto result = scan(&parallel);
+        EXPECT_TRUE(parallel.is_parallel());
+        EXPECT_EQ(sorted(result), sorted(expect));
+    }
+}
+
+/**
+ * @description: 重新扫描（如作为嵌套循环连接的内表）在当前线程中串行进行，结果不变；中途重新开始的扫描也一样
+ */
+TEST_F(SeqScanTest, RescanTest) {
+    std::vector<Condition> conds = {int_cond("id", OP_LT, 1000)};
+    SeqScanExecutor serial(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 1);
+    auto expect = scan(&serial);
+
+    SeqScanExecutor exec(sm_manager_.get(), TEST_TAB_NAME, conds, context_.get(), 4, true);
+    exec.beginTuple();
+    EXPECT_TRUE(exec.is_parallel());
+    exec.Next();
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(scan(&exec), expect);
+        EXPECT_FALSE(exec.is_parallel());
+    }
+}
@@ -0,0 +1,528 @@
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "common/parallel.h"
+#include "index/ix_sorter.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "transaction/concurrency/lock_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBulkLoadTest_db";
+const std::string TEST_TAB_NAME = "tab";
+const std::vector<std::string> TEST_COL = {"col1"};
+
+class BPlusTreeBulkLoadTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    char result_[BUFFER_LENGTH];
+    int offset_ = 0;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get(), result_, &offset_);
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        sm_manager_->create_table(TEST_TAB_NAME, {{.name = "col1", .type = TYPE_INT, .len = 4},
+                                                  {.name = "col2", .type = TYPE_INT, .len = 4}},
+                                  nullptr);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    /* 向表中插入(col1, col2)记录，返回col1 -> rid */
+    std::map<int, Rid> insert_rows(const std::vector<int> &keys) {
+        std::map<int, Rid> rids;
+        RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+        for (int key : keys) {
+            int row[2] = {key, -key};
+            rids[key] = fh->insert_record((char *)row, context_.get());
+        }
+        return rids;
+    }
+
+    IxIndexHandle *get_index() {
+        return sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, TEST_COL)).get();
+    }
+
+    /* 按叶子链表顺序检查索引中的键值对恰好是expected，并检查prev_leaf指针与next_leaf一致 */
+    void check_leaves(IxIndexHandle *ih, const std::map<int, Rid> &expected) {
+        auto it = expected.begin();
+        for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get()); !scan.is_end(); scan.next()) {
+            ASSERT_NE(it, expected.end());
+            IxNodeHandle node = ih->fetch_node(scan.iid().page_no);
+            EXPECT_EQ(node.key_at(scan.iid().slot_no), it->first);
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+            EXPECT_EQ(scan.rid(), it->second);
+            ++it;
+        }
+        EXPECT_EQ(it, expected.end());
+
+        page_id_t prev = IX_LEAF_HEADER_PAGE;
+        page_id_t curr = ih->file_hdr_->first_leaf_;
+        while (curr != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle node = ih->fetch_node(curr);
+            EXPECT_TRUE(node.is_leaf_page());
+            EXPECT_EQ(node.get_prev_leaf(), prev);
+            prev = curr;
+            curr = node.get_next_leaf();
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        }
+        EXPECT_EQ(prev, ih->file_hdr_->last_leaf_);
+    }
+};
+
+/**
+ * @brief 内存上限很小时分成多个run写入临时文件，归并结果按(key, rid)有序
+ */
+TEST_F(BPlusTreeBulkLoadTest, SorterTest) {
+    std::vector<std::pair<int, int>> entries;
+    std::mt19937 rng(0);
+    // 只放得下100个键值对，key有重复
+    IxSorter sorter({TYPE_INT}, {4}, 100 * (sizeof(int) + sizeof(Rid)));
+    for (int i = 0; i < 10000; i++) {
+        int key = rng() % 3000;
+        entries.emplace_back(key, i);
+        sorter.add((const char *)&key, Rid{i, i});
+    }
+    sorter.finish();
+    EXPECT_EQ(sorter.size(), entries.size());
+    EXPECT_EQ(sorter.num_runs(), 100);
+
+    std::sort(entries.begin(), entries.end());
+    const char *key;
+    Rid rid;
+    for (auto &entry : entries) {
+        ASSERT_TRUE(sorter.next(&key, &rid));
+        EXPECT_EQ(*(int *)key, entry.first);
+        EXPECT_EQ(rid, (Rid{entry.second, entry.second}));
+    }
+    EXPECT_FALSE(sorter.next(&key, &rid));
+}
+
+/**
+ * @brief 在已有记录的表上建索引，批量建树之后能查到所有记录，叶子链表完整，之后的插入和删除正常
+ */
+TEST_F(BPlusTreeBulkLoadTest, CreateIndexTest) {
+    std::vector<int> keys;
+    for (int i = 0; i < 30000; i++) {
+        keys.push_back(i * 2);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    auto expected = insert_rows(keys);
+
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    ASSERT_TRUE(tab.is_index(TEST_COL));
+    IxIndexHandle *ih = get_index();
+    // 叶子结点按填充率装满，三万个键值对只需要两层
+    int fill = ih->file_hdr_->btree_order_ * IX_FILL_FACTOR;
+    int num_leaves = (keys.size() + fill - 1) / fill;
+    EXPECT_LE(ih->file_hdr_->num_pages_, IX_INIT_NUM_PAGES + num_leaves + num_leaves / fill + 2);
+    IxNodeHandle root = ih->fetch_node(ih->file_hdr_->root_page_);
+    EXPECT_TRUE(root.is_root_page());
+    EXPECT_FALSE(root.is_leaf_page());
+    IxNodeHandle child = ih->fetch_node(root.value_at(0));
+    EXPECT_TRUE(child.is_leaf_page());
+    EXPECT_EQ(root.get_size(), num_leaves);
+    EXPECT_EQ(child.get_parent_page_no(), root.get_page_no());
+    buffer_pool_manager_->unpin_page(child.get_page_id(), false);
+    buffer_pool_manager_->unpin_page(root.get_page_id(), false);
+
+    for (auto &[key, rid] : expected) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih->get_value((const char *)&key, &result, nullptr));
+        EXPECT_EQ(result[0], rid);
+    }
+    check_leaves(ih, expected);
+
+    // 批量建树之后的索引与逐条插入建立的索引一样可以继续插入和删除
+    for (int key = -1; key < 2000; key += 2) {
+        Rid rid{key, key};
+        EXPECT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        expected[key] = rid;
+    }
+    for (int key = 0; key < 40000; key += 4) {
+        EXPECT_TRUE(ih->delete_entry((const char *)&key, expected[key], nullptr));
+        expected.erase(key);
+    }
+    check_leaves(ih, expected);
+}
+
+/**
+ * @brief 已有记录中存在重复的key时建索引失败，不留下索引文件
+ */
+TEST_F(BPlusTreeBulkLoadTest, DuplicateKeyTest) {
+    insert_rows({3, 1, 2});
+    int row[2] = {2, 0};
+    sm_manager_->fhs_.at(TEST_TAB_NAME)->insert_record((char *)row, context_.get());
+
+    EXPECT_THROW(sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr), IndexDuplicateKeyError);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    EXPECT_FALSE(tab.is_index(TEST_COL));
+    EXPECT_FALSE(tab.get_col("col1")->index);
+    EXPECT_FALSE(ix_manager_->exists(TEST_TAB_NAME, TEST_COL));
+    EXPECT_EQ(sm_manager_->ihs_.size(), 0);
+}
+
+/**
+ * @brief 扫描表之前加表锁失败时同样删掉建了一半的索引文件，元数据不变
+ */
+TEST_F(BPlusTreeBulkLoadTest, LockFailureTest) {
+    insert_rows({3, 1, 2});
+    // 读未提交级别的事务加表锁时被中止
+    Transaction txn(1, IsolationLevel::READ_UNCOMMITTED);
+    Context context(lock_manager_.get(), nullptr, &txn);
+
+    EXPECT_THROW(sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, &context), TransactionAbortException);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    EXPECT_FALSE(tab.is_index(TEST_COL));
+    EXPECT_FALSE(ix_manager_->exists(TEST_TAB_NAME, TEST_COL));
+    EXPECT_EQ(sm_manager_->ihs_.size(), 0);
+}
+
+/**
+ * @brief 非唯一索引：已有记录中有重复的key时也能建索引，get_value返回key的所有rid，delete_entry只删除指定rid的键值对
+ * 每个key的键值对比一个结点能放下的多，跨越多个叶子结点
+ */
+TEST_F(BPlusTreeBulkLoadTest, NonUniqueTest) {
+    RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+    std::map<int, std::vector<Rid>> expected;
+    for (int i = 0; i < 3000; i++) {
+        int row[2] = {i % 7 - 3, i};
+        expected[row[0]].push_back(fh->insert_record((char *)row, context_.get()));
+    }
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, false);
+    EXPECT_FALSE(sm_manager_->db_.get_table(TEST_TAB_NAME).get_index_meta(TEST_COL)->unique);
+    IxIndexHandle *ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, TEST_COL)).get();
+    ASSERT_FALSE(ih->file_hdr_->unique_);
+    ASSERT_LT(ih->file_hdr_->btree_order_, 3000 / 7);
+
+    auto rid_less = [](const Rid &a, const Rid &b) {
+        return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+    };
+    auto check = [&]() {
+        for (auto &[key, rids] : expected) {
+            std::sort(rids.begin(), rids.end(), rid_less);
+            std::vector<Rid> result;
+            EXPECT_EQ(ih->get_value((const char *)&key, &result, nullptr), !rids.empty());
+            EXPECT_EQ(result, rids);
+            // [lower_bound, upper_bound)恰好是key的所有键值对
+            std::vector<Rid> scanned;
+            for (IxScan scan(ih, ih->lower_bound((const char *)&key), ih->upper_bound((const char *)&key),
+                             buffer_pool_manager_.get());
+                 !scan.is_end(); scan.next()) {
+                scanned.push_back(scan.rid());
+            }
+            EXPECT_EQ(scanned, rids);
+        }
+        int missing = 100;
+        std::vector<Rid> result;
+        EXPECT_FALSE(ih->get_value((const char *)&missing, &result, nullptr));
+
+        // 批量查找：同一个key的键值对跨越多个叶子结点
+        std::vector<int> probes = {missing, 3, -3, 0, -4, 0, 1};
+        std::vector<const char *> keys;
+        for (int &probe : probes) {
+            keys.push_back((const char *)&probe);
+        }
+        std::vector<std::vector<Rid>> results;
+        ih->get_values(keys, &results, nullptr);
+        ASSERT_EQ(results.size(), probes.size());
+        for (size_t i = 0; i < probes.size(); i++) {
+            EXPECT_EQ(results[i], expected.count(probes[i]) ? expected[probes[i]] : std::vector<Rid>());
+        }
+    };
+    check();
+
+    // 相同的(key, rid)只能插入一次，key相同rid不同的键值对可以继续插入
+    int key = 0;
+    EXPECT_EQ(ih->insert_entry((const char *)&key, expected[key][0], nullptr), IX_NO_PAGE);
+    for (int i = 0; i < 500; i++) {
+        Rid rid{-1, i};
+        EXPECT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        expected[key].push_back(rid);
+    }
+    // 只删除指定rid的键值对，同一个key的其他键值对不受影响
+    EXPECT_FALSE(ih->delete_entry((const char *)&key, Rid{-2, 0}, nullptr));
+    for (int k = -3; k <= 3; k++) {
+        auto &rids = expected[k];
+        std::vector<Rid> kept;
+        for (size_t i = 0; i < rids.size(); i++) {
+            if (i % 3 == 0 || k == 3) {
+                EXPECT_TRUE(ih->delete_entry((const char *)&k, rids[i], nullptr));
+            } else {
+                kept.push_back(rids[i]);
+            }
+        }
+        rids = kept;
+    }
+    check();
+}
+
+/**
+ * @brief 批量查找的结果与逐个get_value相同：key无序、有重复、有不存在的key，相邻的key有的在同一个叶子结点，有的相隔很远
+ */
+TEST_F(BPlusTreeBulkLoadTest, GetValuesTest) {
+    std::vector<int> inserted;
+    for (int i = 0; i < 20000; i++) {
+        inserted.push_back(i * 2);
+    }
+    auto rids = insert_rows(inserted);
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = get_index();
+
+    std::mt19937 rng(3);
+    std::vector<int> probes = {-1, 0, 39998, 39999, 100000, 0};
+    for (int i = 0; i < 3000; i++) {
+        probes.push_back(rng() % 42000 - 1000);
+    }
+    for (int i = 500; i < 700; i++) {
+        probes.push_back(i);
+    }
+    std::shuffle(probes.begin(), probes.end(), rng);
+    std::vector<const char *> keys;
+    for (int &probe : probes) {
+        keys.push_back((const char *)&probe);
+    }
+    std::vector<std::vector<Rid>> results;
+    ih->get_values(keys, &results, nullptr);
+    ASSERT_EQ(results.size(), probes.size());
+    for (size_t i = 0; i < probes.size(); i++) {
+        std::vector<Rid> result;
+        EXPECT_EQ(ih->get_value(keys[i], &result, nullptr), !results[i].empty());
+        EXPECT_EQ(results[i], result);
+        if (rids.count(probes[i])) {
+            ASSERT_EQ(results[i].size(), 1);
+            EXPECT_EQ(results[i][0], rids[probes[i]]);
+        }
+    }
+
+    ih->get_values({}, &results, nullptr);
+    EXPECT_TRUE(results.empty());
+}
+
+/**
+ * @brief 长key的结点只能放下几个键值对，批量建树时会逐层建立多层内部结点
+ * key包含int字段，编码为按字节比较的格式后使用压缩格式的结点；key的内容随机，叶子结点几乎不能压缩
+ */
+TEST_F(BPlusTreeBulkLoadTest, MultiLevelTest) {
+    const std::string tab_name = "wide";
+    const int key_len = 400;
+    sm_manager_->create_table(tab_name,
+                              {{.name = "k", .type = TYPE_STRING, .len = key_len - 4}, {.name = "n", .type = TYPE_INT, .len = 4}},
+                              nullptr);
+    RmFileHandle *fh = sm_manager_->fhs_.at(tab_name).get();
+    std::map<std::string, Rid> expected;
+    std::mt19937 rng(2);
+    for (int key = 0; key < 5000; key++) {
+        std::string row(key_len - 4, '\0');
+        for (char &c : row) {
+            c = 'a' + rng() % 26;
+        }
+        int n = key - 2500;
+        row.append((const char *)&n, 4);
+        expected[row] = fh->insert_record(row.data(), context_.get());
+    }
+
+    sm_manager_->create_index(tab_name, {"k", "n"}, nullptr);
+    IxIndexHandle *ih =
+        sm_manager_->ihs_.at(ix_manager_->get_index_name(tab_name, std::vector<std::string>{"k", "n"})).get();
+    ASSERT_TRUE(ih->file_hdr_->encoded_);
+    ASSERT_TRUE(ih->file_hdr_->compressed_);
+
+    // 从根结点一直走到最左边的叶子，每一层都是上一层的孩子；第二个孩子的key不大于孩子中的key（内部结点的第0个key不保存）
+    int depth = 1;
+    IxNodeHandle node = ih->fetch_node(ih->file_hdr_->root_page_);
+    std::vector<char> sep(key_len), first(key_len);
+    while (!node.is_leaf_page()) {
+        IxNodeHandle child = ih->fetch_node(node.value_at(0));
+        EXPECT_EQ(child.get_parent_page_no(), node.get_page_no());
+        IxNodeHandle second = ih->fetch_node(node.value_at(1));
+        node.read_key(1, sep.data());
+        second.read_key(second.is_leaf_page() ? 0 : 1, first.data());
+        EXPECT_LE(memcmp(sep.data(), first.data(), key_len), 0);
+        buffer_pool_manager_->unpin_page(second.get_page_id(), false);
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+        node = child;
+        depth++;
+    }
+    EXPECT_EQ(node.get_page_no(), ih->file_hdr_->first_leaf_);
+    EXPECT_LT(node.get_size(), 10);
+    buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+    EXPECT_GE(depth, 3);
+
+    std::vector<const char *> keys;
+    for (auto &[key, rid] : expected) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih->get_value(key.data(), &result, nullptr));
+        EXPECT_EQ(result[0], rid);
+        keys.push_back(key.data());
+    }
+    // 批量查找压缩格式的叶子结点
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<std::vector<Rid>> results;
+    ih->get_values(keys, &results, nullptr);
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(results[i].size(), 1);
+        EXPECT_EQ(results[i][0], expected.at(std::string(keys[i], key_len)));
+    }
+    // 叶子结点中的key解码后与插入的key相同，并且有序
+    auto it = expected.begin();
+    std::vector<char> key(key_len), decoded(key_len);
+    for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get()); !scan.is_end(); scan.next()) {
+        ASSERT_NE(it, expected.end());
+        IxNodeHandle leaf = ih->fetch_node(scan.iid().page_no);
+        leaf.read_key(scan.iid().slot_no, key.data());
+        buffer_pool_manager_->unpin_page(leaf.get_page_id(), false);
+        ix_decode_key(key.data(), ih->file_hdr_, decoded.data());
+        EXPECT_EQ(memcmp(decoded.data(), it->first.data(), key_len), 0);
+        EXPECT_EQ(scan.rid(), it->second);
+        ++it;
+    }
+    EXPECT_EQ(it, expected.end());
+}
+
+/**
+ * @brief 按key的范围切分后各段拼起来与整体归并的结果一致
+ */
+TEST_F(BPlusTreeBulkLoadTest, PartitionTest) {
+    std::mt19937 rng(3);
+    std::vector<int> keys;
+    IxSorter sorter({TYPE_INT}, {4}, 500 * (sizeof(int) + sizeof(Rid)));
+    for (int i = 0; i < 20000; i++) {
+        int key = rng() % 100000;
+        keys.push_back(key);
+        sorter.add((const char *)&key, Rid{i, 0});
+    }
+    sorter.finish();
+    std::sort(keys.begin(), keys.end());
+
+    auto cursors = sorter.partition(7);
+    ASSERT_EQ(cursors.size(), 7);
+    size_t idx = 0;
+    for (auto &cursor : cursors) {
+        // 样本均匀，每段的大小接近平均值
+        EXPECT_GT(cursor.size(), keys.size() / 7 / 2);
+        const char *key;
+        Rid rid;
+        for (size_t i = 0; i < cursor.size(); i++) {
+            ASSERT_TRUE(cursor.next(&key, &rid));
+            EXPECT_EQ(*(int *)key, keys[idx++]);
+        }
+        EXPECT_FALSE(cursor.next(&key, &rid));
+    }
+    EXPECT_EQ(idx, keys.size());
+}
+
+/**
+ * @brief 多个线程生成run、分段建立叶子结点和内部结点，结果与串行建树一样是一棵完整的B+树
+ * 长字符串key使用压缩格式的结点
+ */
+TEST_F(BPlusTreeBulkLoadTest, ParallelBulkLoadTest) {
+    const int key_len = 200;
+    const int num_workers = 4;
+    std::vector<ColMeta> cols = {{.tab_name = TEST_TAB_NAME, .name = "wide", .type = TYPE_STRING, .len = key_len}};
+    ix_manager_->create_index(TEST_TAB_NAME, cols);
+    auto ih = ix_manager_->open_index(TEST_TAB_NAME, cols);
+    ASSERT_TRUE(ih->file_hdr_->compressed_);
+
+    std::map<std::string, Rid> expected;
+    std::vector<std::unique_ptr<IxSorter>> sorters;
+    for (int w = 0; w < num_workers; w++) {
+        sorters.push_back(std::make_unique<IxSorter>(std::vector<ColType>{TYPE_STRING}, std::vector<int>{key_len},
+                                                     1000 * (key_len + sizeof(Rid))));
+    }
+    parallel_for(num_workers, [&](size_t w) {
+        for (int i = w; i < 20000; i += num_workers) {
+            std::string key = std::to_string(i * 7919 % 20000);
+            key.resize(key_len, '\0');
+            sorters[w]->add(key.data(), Rid{i, (int)w});
+        }
+        sorters[w]->finish();
+    });
+    for (int i = 0; i < 20000; i++) {
+        std::string key = std::to_string(i * 7919 % 20000);
+        key.resize(key_len, '\0');
+        expected[key] = Rid{i, i % num_workers};
+    }
+    IxSorter sorter({TYPE_STRING}, {key_len});
+    for (auto &worker_sorter : sorters) {
+        sorter.absorb(*worker_sorter);
+    }
+    sorter.finish();
+    EXPECT_EQ(sorter.size(), expected.size());
+    EXPECT_GT(sorter.num_runs(), (size_t)num_workers);
+    ih->bulk_load(&sorter, IX_FILL_FACTOR, num_workers);
+
+    for (auto &[key, rid] : expected) {
+        std::vector<Rid> result;
+        ASSERT_TRUE(ih->get_value(key.data(), &result, nullptr));
+        EXPECT_EQ(result[0], rid);
+    }
+    auto it = expected.begin();
+    page_id_t prev = IX_LEAF_HEADER_PAGE;
+    std::vector<char> buf(key_len);
+    for (page_id_t curr = ih->file_hdr_->first_leaf_; curr != IX_LEAF_HEADER_PAGE;) {
+        IxNodeHandle node = ih->fetch_node(curr);
+        EXPECT_EQ(node.get_prev_leaf(), prev);
+        for (int i = 0; i < node.get_size(); i++, ++it) {
+            ASSERT_NE(it, expected.end());
+            node.read_key(i, buf.data());
+            EXPECT_EQ(memcmp(buf.data(), it->first.data(), key_len), 0);
+        }
+        // 各段的结点数分别取整，叶子结点不会过空
+        EXPECT_GE(node.get_size(), node.get_min_size() / 2);
+        prev = curr;
+        curr = node.get_next_leaf();
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+    }
+    EXPECT_EQ(it, expected.end());
+    EXPECT_EQ(prev, ih->file_hdr_->last_leaf_);
+
+    // 建好的树可以继续插入和删除
+    for (int i = 0; i < 20000; i += 3) {
+        std::string key = std::to_string(i);
+        key.resize(key_len, '\0');
+        EXPECT_TRUE(ih->delete_entry(key.data(), Rid{}, nullptr));
+        EXPECT_NE(ih->insert_entry(key.data(), Rid{-1, -1}, nullptr), IX_NO_PAGE);
+    }
+    ix_manager_->close_index(ih.get());
+}
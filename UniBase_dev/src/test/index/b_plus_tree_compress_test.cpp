@@ -0,0 +1,342 @@
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "transaction/concurrency/lock_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeCompressTest_db";
+const std::string TEST_TAB_NAME = "tab";
+const std::vector<std::string> TEST_COL = {"path"};
+const int KEY_LEN = 64;
+
+/* 生成有较长公共前缀的key，例如"tenant-03/users/00001234/profile"，末尾补'\0' */
+std::string make_key(int tenant, int id) {
+    char buf[KEY_LEN];
+    snprintf(buf, sizeof(buf), "tenant-%02d/users/%08d/profile", tenant, id);
+    std::string key(buf);
+    key.resize(KEY_LEN, '\0');
+    return key;
+}
+
+class BPlusTreeCompressTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    char result_[BUFFER_LENGTH];
+    int offset_ = 0;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get(), result_, &offset_);
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        sm_manager_->create_table(TEST_TAB_NAME, {{.name = "path", .type = TYPE_STRING, .len = KEY_LEN}}, nullptr);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    IxIndexHandle *get_index() {
+        return sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, TEST_COL)).get();
+    }
+
+    std::string read_key(const IxNodeHandle &node, int i) {
+        std::string key(KEY_LEN, '\0');
+        node.read_key(i, key.data());
+        return key;
+    }
+
+    /**
+     * @brief 递归检查子树：父结点指针正确，所有key在[lower, upper)之间并且有序
+     * @param max_leaf_size 传出参数，叶子结点的最大键值对个数
+     * @param num_entries 传出参数，叶子结点的键值对总数
+     */
+    void check_subtree(IxIndexHandle *ih, page_id_t page_no, page_id_t parent, const std::string &lower,
+                       const std::string &upper, int *max_leaf_size, int *num_entries) {
+        IxNodeHandle node = ih->fetch_node(page_no);
+        EXPECT_TRUE(node.is_compressed());
+        EXPECT_EQ(node.get_parent_page_no(), parent);
+        EXPECT_LE(node.used_bytes(), PAGE_SIZE);
+        if (node.is_leaf_page()) {
+            std::string prev;
+            for (int i = 0; i < node.get_size(); i++) {
+                std::string key = read_key(node, i);
+                EXPECT_GE(key, lower);
+                EXPECT_TRUE(upper.empty() || key < upper);
+                EXPECT_TRUE(i == 0 || prev < key);
+                prev = key;
+            }
+            *max_leaf_size = std::max(*max_leaf_size, node.get_size());
+            *num_entries += node.get_size();
+        } else {
+            EXPECT_GE(node.get_size(), 2);
+            for (int i = 0; i < node.get_size(); i++) {
+                std::string child_lower = i == 0 ? lower : read_key(node, i);
+                std::string child_upper = i + 1 == node.get_size() ? upper : read_key(node, i + 1);
+                EXPECT_TRUE(child_upper.empty() || child_lower < child_upper);
+                check_subtree(ih, node.value_at(i), page_no, child_lower, child_upper, max_leaf_size, num_entries);
+            }
+        }
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
+    }
+
+    /* 检查索引中的键值对恰好是expected，树的结构正确，返回叶子结点的最大键值对个数 */
+    int check_tree(IxIndexHandle *ih, const std::map<std::string, Rid> &expected) {
+        int max_leaf_size = 0, num_entries = 0;
+        check_subtree(ih, ih->file_hdr_->root_page_, IX_NO_PAGE, "", "", &max_leaf_size, &num_entries);
+        EXPECT_EQ(num_entries, (int)expected.size());
+        for (auto &[key, rid] : expected) {
+            std::vector<Rid> result;
+            EXPECT_TRUE(ih->get_value(key.data(), &result, nullptr));
+            EXPECT_EQ(result.size(), 1);
+            if (!result.empty()) {
+                EXPECT_EQ(result[0], rid);
+            }
+        }
+        auto it = expected.begin();
+        for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get()); !scan.is_end(); scan.next()) {
+            if (it == expected.end()) {
+                ADD_FAILURE();
+                break;
+            }
+            EXPECT_EQ(scan.rid(), it->second);
+            ++it;
+        }
+        EXPECT_EQ(it, expected.end());
+        return max_leaf_size;
+    }
+};
+
+/**
+ * @brief 随机插入和删除，结点的前缀和分隔key随之变化，结果与std::map一致；压缩后叶子结点放得下比btree_order更多的键值对
+ */
+TEST_F(BPlusTreeCompressTest, RandomInsertDeleteTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = get_index();
+    ASSERT_TRUE(ih->file_hdr_->compressed_);
+
+    std::mt19937 rng(0);
+    std::map<std::string, Rid> expected;
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 6000; i++) {
+            std::string key = make_key(rng() % 5, rng() % 20000);
+            Rid rid{i, round};
+            bool exists = expected.count(key) > 0;
+            page_id_t page_no = ih->insert_entry(key.data(), rid, nullptr);
+            EXPECT_EQ(page_no == IX_NO_PAGE, exists);
+            if (!exists) {
+                expected[key] = rid;
+            }
+        }
+        for (int i = 0; i < 5000; i++) {
+            std::string key = make_key(rng() % 5, rng() % 20000);
+            bool exists = expected.erase(key) > 0;
+            EXPECT_EQ(ih->delete_entry(key.data(), Rid{}, nullptr), exists);
+        }
+        int max_leaf_size = check_tree(ih, expected);
+        EXPECT_GT(max_leaf_size, ih->file_hdr_->btree_order_);
+    }
+
+    // 全部删除之后仍然可以插入
+    for (auto &[key, rid] : expected) {
+        EXPECT_TRUE(ih->delete_entry(key.data(), rid, nullptr));
+    }
+    expected.clear();
+    check_tree(ih, expected);
+    for (int i = 0; i < 1000; i++) {
+        std::string key = make_key(i % 3, i);
+        EXPECT_NE(ih->insert_entry(key.data(), Rid{i, 0}, nullptr), IX_NO_PAGE);
+        expected[key] = Rid{i, 0};
+    }
+    check_tree(ih, expected);
+}
+
+/**
+ * @brief 叶子结点分裂时向父结点插入最短的分隔key，比完整的key短
+ */
+TEST_F(BPlusTreeCompressTest, ShortSeparatorTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = get_index();
+    std::map<std::string, Rid> expected;
+    for (int i = 0; i < 5000; i++) {
+        std::string key = make_key(1, i * 37);
+        EXPECT_NE(ih->insert_entry(key.data(), Rid{i, 0}, nullptr), IX_NO_PAGE);
+        expected[key] = Rid{i, 0};
+    }
+    check_tree(ih, expected);
+
+    int key_len = ix_trimmed_len(make_key(1, 0).data(), KEY_LEN);
+    IxNodeHandle root = ih->fetch_node(ih->file_hdr_->root_page_);
+    ASSERT_FALSE(root.is_leaf_page());
+    for (int i = 1; i < root.get_size(); i++) {
+        std::string sep = read_key(root, i);
+        EXPECT_LT(ix_trimmed_len(sep.data(), KEY_LEN), key_len);
+    }
+    buffer_pool_manager_->unpin_page(root.get_page_id(), false);
+}
+
+/**
+ * @brief 在已有数据的表上建索引时批量建立压缩格式的结点，之后可以继续插入和删除
+ */
+TEST_F(BPlusTreeCompressTest, BulkLoadTest) {
+    RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+    std::map<std::string, Rid> expected;
+    for (int i = 0; i < 20000; i++) {
+        std::string key = make_key(i % 7, i * 7919 % 20000);
+        expected[key] = fh->insert_record(key.data(), context_.get());
+    }
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = get_index();
+    ASSERT_TRUE(ih->file_hdr_->compressed_);
+    EXPECT_GT(check_tree(ih, expected), ih->file_hdr_->btree_order_);
+
+    std::mt19937 rng(1);
+    for (int i = 0; i < 10000; i++) {
+        std::string key = make_key(rng() % 8, rng() % 30000);
+        if (rng() % 2 == 0) {
+            bool exists = expected.count(key) > 0;
+            EXPECT_EQ(ih->insert_entry(key.data(), Rid{-1, i}, nullptr) == IX_NO_PAGE, exists);
+            if (!exists) {
+                expected[key] = Rid{-1, i};
+            }
+        } else {
+            bool exists = expected.erase(key) > 0;
+            EXPECT_EQ(ih->delete_entry(key.data(), Rid{}, nullptr), exists);
+        }
+    }
+    check_tree(ih, expected);
+}
+
+/**
+ * @brief 多个线程同时插入，压缩格式按字节数判断结点是否安全
+ */
+TEST_F(BPlusTreeCompressTest, ConcurrentInsertTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = get_index();
+    const int num_threads = 4;
+    const int num_keys = 4000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = t; i < num_keys; i += num_threads) {
+                std::string key = make_key(i % 3, i);
+                EXPECT_NE(ih->insert_entry(key.data(), Rid{i, t}, nullptr), IX_NO_PAGE);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::map<std::string, Rid> expected;
+    for (int i = 0; i < num_keys; i++) {
+        expected[make_key(i % 3, i)] = Rid{i, i % num_threads};
+    }
+    check_tree(ih, expected);
+}
+
+/**
+ * @brief 包含数值字段的多字段key编码后按字节比较：负数和浮点数的顺序正确，上层仍然传入原来格式的key
+ * 短key使用定长格式，长key使用压缩格式
+ */
+TEST_F(BPlusTreeCompressTest, CompositeKeyTest) {
+    for (int str_len : {4, 20}) {
+        std::string tab_name = "composite" + std::to_string(str_len);
+        std::vector<std::string> cols = {"a", "b", "c"};
+        sm_manager_->create_table(tab_name,
+                                  {{.name = "a", .type = TYPE_INT, .len = 4},
+                                   {.name = "b", .type = TYPE_FLOAT, .len = 4},
+                                   {.name = "c", .type = TYPE_STRING, .len = str_len}},
+                                  nullptr);
+        sm_manager_->create_index(tab_name, cols, nullptr);
+        IxIndexHandle *ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(tab_name, cols)).get();
+        ASSERT_TRUE(ih->file_hdr_->encoded_);
+        EXPECT_EQ(ih->file_hdr_->compressed_, 8 + str_len >= IX_COMPRESS_MIN_KEY_LEN);
+
+        // 按(a, b, c)的值排序的key
+        std::vector<std::string> keys;
+        for (int a = -3; a <= 3; a++) {
+            for (float b : {-1e10f, -2.5f, 0.0f, 0.75f, 1e10f}) {
+                for (const char *c : {"", "ab", "b"}) {
+                    std::string key((const char *)&a, 4);
+                    key.append((const char *)&b, 4);
+                    std::string str(c);
+                    str.resize(str_len, '\0');
+                    keys.push_back(key + str);
+                }
+            }
+        }
+        std::mt19937 rng(4);
+        std::vector<int> order(keys.size());
+        for (int i = 0; i < (int)order.size(); i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int i : order) {
+            EXPECT_NE(ih->insert_entry(keys[i].data(), Rid{i, 0}, nullptr), IX_NO_PAGE);
+        }
+        // -0.0与0.0是同一个key
+        std::string negative_zero = keys[2 * 3];
+        float minus_zero = -0.0f;
+        memcpy(negative_zero.data() + 4, &minus_zero, 4);
+        EXPECT_EQ(ih->insert_entry(negative_zero.data(), Rid{-1, -1}, nullptr), IX_NO_PAGE);
+
+        int idx = 0;
+        for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get()); !scan.is_end(); scan.next()) {
+            EXPECT_EQ(scan.rid(), (Rid{idx, 0}));
+            idx++;
+        }
+        EXPECT_EQ(idx, (int)keys.size());
+        for (int i = 0; i < (int)keys.size(); i++) {
+            std::vector<Rid> result;
+            EXPECT_TRUE(ih->get_value(keys[i].data(), &result, nullptr));
+            EXPECT_EQ(ih->get_rid(ih->lower_bound(keys[i].data())), (Rid{i, 0}));
+            if (i + 1 < (int)keys.size()) {
+                EXPECT_EQ(ih->get_rid(ih->upper_bound(keys[i].data())), (Rid{i + 1, 0}));
+            }
+        }
+        for (int i = 0; i < (int)keys.size(); i += 2) {
+            EXPECT_TRUE(ih->delete_entry(keys[i].data(), (Rid{i, 0}), nullptr));
+        }
+        for (int i = 0; i < (int)keys.size(); i++) {
+            std::vector<Rid> result;
+            EXPECT_EQ(ih->get_value(keys[i].data(), &result, nullptr), i % 2 == 1);
+        }
+    }
+}
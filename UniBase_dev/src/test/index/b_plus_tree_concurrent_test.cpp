@@ -1,3 +1,4 @@
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -69,8 +70,10 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
-        // 打开测试文件
-        ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+        // create_index已经打开了索引，从系统管理器中取出由测试管理
+        auto index_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ih_ = std::move(sm_->ihs_.at(index_name));
+        sm_->ihs_.erase(index_name);
         assert(ih_ != nullptr);
     }
 
@@ -154,15 +157,15 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
             }
             // Print leaves
             for (int i = 0; i < inner->get_size(); i++) {
-                IxNodeHandle *child_node = ih->fetch_node(inner->value_at(i));
-                ToGraph(ih, child_node, bpm, out);  // 继续递归
+                IxNodeHandle child_node = ih->fetch_node(inner->value_at(i));
+                ToGraph(ih, &child_node, bpm, out);  // 继续递归
                 if (i > 0) {
-                    IxNodeHandle *sibling_node = ih->fetch_node(inner->value_at(i - 1));
-                    if (!sibling_node->is_leaf_page() && !child_node->is_leaf_page()) {
-                        out << "{rank=same " << internal_prefix << sibling_node->get_page_no() << " " << internal_prefix
-                            << child_node->get_page_no() << "};\n";
+                    IxNodeHandle sibling_node = ih->fetch_node(inner->value_at(i - 1));
+                    if (!sibling_node.is_leaf_page() && !child_node.is_leaf_page()) {
+                        out << "{rank=same " << internal_prefix << sibling_node.get_page_no() << " " << internal_prefix
+                            << child_node.get_page_no() << "};\n";
                     }
-                    bpm->unpin_page(sibling_node->get_page_id(), false);
+                    bpm->unpin_page(sibling_node.get_page_id(), false);
                 }
             }
         }
@@ -179,8 +182,8 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         std::ofstream out(outf);
         out << "digraph G {" << std::endl;
         
-        IxNodeHandle *node = ih_->fetch_node(ih_->file_hdr_->root_page_);
-        ToGraph(ih_.get(), node, bpm, out);
+        IxNodeHandle node = ih_->fetch_node(ih_->file_hdr_->root_page_);
+        ToGraph(ih_.get(), &node, bpm, out);
         out << "}" << std::endl;
         out.close();
 
@@ -206,16 +209,16 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         // check leaf list
         page_id_t leaf_no = ih->file_hdr_->first_leaf_;
         while (leaf_no != IX_LEAF_HEADER_PAGE) {
-            IxNodeHandle *curr = ih->fetch_node(leaf_no);
-            IxNodeHandle *prev = ih->fetch_node(curr->get_prev_leaf());
-            IxNodeHandle *next = ih->fetch_node(curr->get_next_leaf());
-            // Ensure prev->next == curr && next->prev == curr
-            ASSERT_EQ(prev->get_next_leaf(), leaf_no);
-            ASSERT_EQ(next->get_prev_leaf(), leaf_no);
-            leaf_no = curr->get_next_leaf();
-            buffer_pool_manager_->unpin_page(curr->get_page_id(), false);
-            buffer_pool_manager_->unpin_page(prev->get_page_id(), false);
-            buffer_pool_manager_->unpin_page(next->get_page_id(), false);
+            IxNodeHandle curr = ih->fetch_node(leaf_no);
+            IxNodeHandle prev = ih->fetch_node(curr.get_prev_leaf());
+            IxNodeHandle next = ih->fetch_node(curr.get_next_leaf());
+            // Ensure prev.next == curr && next.prev == curr
+            ASSERT_EQ(prev.get_next_leaf(), leaf_no);
+            ASSERT_EQ(next.get_prev_leaf(), leaf_no);
+            leaf_no = curr.get_next_leaf();
+            buffer_pool_manager_->unpin_page(curr.get_page_id(), false);
+            buffer_pool_manager_->unpin_page(prev.get_page_id(), false);
+            buffer_pool_manager_->unpin_page(next.get_page_id(), false);
         }
     }
 
@@ -226,33 +229,33 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
      * @param now_page_no 当前遍历到的结点
      */
     void check_tree(const IxIndexHandle *ih, int now_page_no) {
-        IxNodeHandle *node = ih->fetch_node(now_page_no);
-        if (node->is_leaf_page()) {
-            buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        IxNodeHandle node = ih->fetch_node(now_page_no);
+        if (node.is_leaf_page()) {
+            buffer_pool_manager_->unpin_page(node.get_page_id(), false);
             return;
         }
-        for (int i = 0; i < node->get_size(); i++) {                 // 遍历node的所有孩子
-            IxNodeHandle *child = ih->fetch_node(node->value_at(i));  // 第i个孩子
+        for (int i = 0; i < node.get_size(); i++) {                 // 遍历node的所有孩子
+            IxNodeHandle child = ih->fetch_node(node.value_at(i));  // 第i个孩子
             // check parent
-            assert(child->get_parent_page_no() == now_page_no);
+            assert(child.get_parent_page_no() == now_page_no);
             // check first key
-            int node_key = node->key_at(i);  // node的第i个key
-            int child_first_key = child->key_at(0);
-            int child_last_key = child->key_at(child->get_size() - 1);
+            int node_key = node.key_at(i);  // node的第i个key
+            int child_first_key = child.key_at(0);
+            int child_last_key = child.key_at(child.get_size() - 1);
             if (i != 0) {
                 // 除了第0个key之外，node的第i个key与其第i个孩子的第0个key的值相同
                 ASSERT_EQ(node_key, child_first_key);
             }
-            if (i + 1 < node->get_size()) {
+            if (i + 1 < node.get_size()) {
                 // 满足制约大小关系
-                ASSERT_LT(child_last_key, node->key_at(i + 1));  // child_last_key < node->KeyAt(i + 1)
+                ASSERT_LT(child_last_key, node.key_at(i + 1));  // child_last_key < node.KeyAt(i + 1)
             }
 
-            buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+            buffer_pool_manager_->unpin_page(child.get_page_id(), false);
 
-            check_tree(ih, node->value_at(i));  // 递归子树
+            check_tree(ih, node.value_at(i));  // 递归子树
         }
-        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        buffer_pool_manager_->unpin_page(node.get_page_id(), false);
     }
 
     /**
@@ -370,7 +373,8 @@ void DeleteHelper(IxIndexHandle *tree, const std::vector<int64_t> &keys,
     const char *index_key;
     for (auto key : keys) {
         index_key = (const char *)&key;
-        tree->delete_entry(index_key, transaction);
+        Rid rid = {.page_no = static_cast<int32_t>(key >> 32), .slot_no = static_cast<int32_t>(key & 0xFFFFFFFF)};
+        tree->delete_entry(index_key, rid, transaction);
     }
 
     delete transaction;
@@ -462,4 +466,89 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
         scan.next();
     }
     EXPECT_EQ(size, keys.size() - delete_keys.size());
-}
\ No newline at end of file
+}
+/**
+ * @brief 插入、删除和查找同时进行：阶数很小，分裂与合并频繁，覆盖find_leaf_page的加锁下降、is_safe和release_latches
+ * 每个写线程只修改属于自己的key，因此能随时检查自己的key是否在树中；读线程反复查找一组始终不变的key，
+ * 结束后检查树的结构和叶子链表，并与各线程记录的结果比较
+ */
+TEST_F(BPlusTreeConcurrentTest, CrabbingTest) {
+    const int scale = 4000;
+    const int num_writers = 8;
+    const int num_readers = 2;
+    const int ops_per_writer = 2000;
+    const int order = 6;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+
+    // key % (num_writers + 1) == num_writers的key始终在树中，其余key属于第key % (num_writers + 1)个写线程
+    auto owner = [&](int key) { return key % (num_writers + 1); };
+    auto make_rid = [](int key) { return Rid{.page_no = 0, .slot_no = key}; };
+    std::vector<std::vector<bool>> present(num_writers + 1, std::vector<bool>(scale, false));
+    Transaction load_txn(0);
+    for (int key = 0; key < scale; key += 2) {
+        ASSERT_NE(ih_->insert_entry((const char *)&key, make_rid(key), &load_txn), IX_NO_PAGE);
+        present[owner(key)][key] = true;
+    }
+    for (int key = 1; key < scale; key += 2) {
+        if (owner(key) == num_writers) {
+            ASSERT_NE(ih_->insert_entry((const char *)&key, make_rid(key), &load_txn), IX_NO_PAGE);
+            present[num_writers][key] = true;
+        }
+    }
+
+    std::atomic<int> num_running = num_writers;
+    std::vector<std::thread> threads;
+    for (int w = 0; w < num_writers; w++) {
+        threads.emplace_back([&, w]() {
+            Transaction txn(w + 1);
+            std::mt19937 rng(w);
+            std::vector<bool> &mine = present[w];
+            std::vector<Rid> rids;
+            for (int i = 0; i < ops_per_writer; i++) {
+                int key = (int)(rng() % (scale / (num_writers + 1))) * (num_writers + 1) + w;
+                if (key >= scale) {
+                    continue;
+                }
+                if (mine[key]) {
+                    ASSERT_TRUE(ih_->delete_entry((const char *)&key, make_rid(key), &txn));
+                } else {
+                    ASSERT_NE(ih_->insert_entry((const char *)&key, make_rid(key), &txn), IX_NO_PAGE);
+                }
+                mine[key] = !mine[key];
+                rids.clear();
+                ASSERT_EQ(ih_->get_value((const char *)&key, &rids, &txn), mine[key]);
+                ASSERT_EQ(rids.size(), mine[key] ? 1u : 0u);
+            }
+            num_running--;
+        });
+    }
+    for (int r = 0; r < num_readers; r++) {
+        threads.emplace_back([&, r]() {
+            Transaction txn(num_writers + 1 + r);
+            std::vector<Rid> rids;
+            while (num_running > 0) {
+                for (int key = num_writers; key < scale; key += num_writers + 1) {
+                    rids.clear();
+                    ASSERT_TRUE(ih_->get_value((const char *)&key, &rids, &txn));
+                    ASSERT_EQ(rids.size(), 1u);
+                    ASSERT_EQ(rids[0], make_rid(key));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::multimap<int, Rid> mock;
+    for (auto &keys : present) {
+        for (int key = 0; key < scale; key++) {
+            if (keys[key]) {
+                mock.emplace(key, make_rid(key));
+            }
+        }
+    }
+    check_all(ih_.get(), mock);
+}
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "transaction/concurrency/lock_manager.h"
+
+const std::string TEST_DB_NAME = "IxHashTest_db";
+const std::string TEST_TAB_NAME = "tab";
+const std::vector<std::string> TEST_COL = {"col1"};
+
+class IxHashTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<LockManager> lock_manager_;
+    std::unique_ptr<Transaction> txn_;
+    std::unique_ptr<Context> context_;
+    char result_[BUFFER_LENGTH];
+    int offset_ = 0;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        lock_manager_ = std::make_unique<LockManager>();
+        txn_ = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+        context_ = std::make_unique<Context>(lock_manager_.get(), nullptr, txn_.get(), result_, &offset_);
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+        sm_manager_->create_table(TEST_TAB_NAME, {{.name = "col1", .type = TYPE_INT, .len = 4},
+                                                  {.name = "col2", .type = TYPE_INT, .len = 4}},
+                                  nullptr);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    /* 向表中插入(col1, col2)记录，返回每条记录的(col1, rid) */
+    std::vector<std::pair<int, Rid>> insert_rows(const std::vector<int> &keys) {
+        std::vector<std::pair<int, Rid>> rows;
+        RmFileHandle *fh = sm_manager_->fhs_.at(TEST_TAB_NAME).get();
+        for (int key : keys) {
+            int row[2] = {key, -key};
+            rows.emplace_back(key, fh->insert_record((char *)row, context_.get()));
+        }
+        return rows;
+    }
+
+    IxIndexHandle *get_index() {
+        return sm_manager_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, TEST_COL)).get();
+    }
+
+    /* 检查每个key在索引中恰好对应expected中的rid，并且按(page_no, slot_no)排列 */
+    void check_values(IxIndexHandle *ih, const std::map<int, std::vector<Rid>> &expected) {
+        for (auto &[key, rids] : expected) {
+            std::vector<Rid> result;
+            EXPECT_EQ(ih->get_value((const char *)&key, &result, nullptr), !rids.empty());
+            EXPECT_EQ(result, rids);
+        }
+    }
+};
+
+/**
+ * @brief 唯一哈希索引：插入大量key时目录扩大、桶分裂，之后查找、重复插入、删除都正确
+ */
+TEST_F(IxHashTest, UniqueTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, true, {}, INDEX_HASH);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    EXPECT_EQ(tab.get_index_meta(TEST_COL)->type, INDEX_HASH);
+    IxIndexHandle *ih = get_index();
+    ASSERT_TRUE(ih->is_hash());
+    EXPECT_EQ(ih->get_global_depth(), 0);
+
+    std::vector<int> keys;
+    for (int i = 0; i < 20000; i++) {
+        keys.push_back(i * 3);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    std::map<int, std::vector<Rid>> expected;
+    for (int key : keys) {
+        Rid rid{key / 100, key % 100};
+        EXPECT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        expected[key] = {rid};
+    }
+    // 每个桶页面最多BUCKET_SIZE个键值对，没有重复的key时不需要溢出页面
+    int num_buckets = (keys.size() + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    EXPECT_GE(1 << ih->get_global_depth(), num_buckets);
+    EXPECT_LE(ih->get_global_depth(), IX_HASH_MAX_DEPTH);
+    check_values(ih, expected);
+
+    // 唯一索引中key已存在时插入失败，不管rid是否相同
+    for (int key = 0; key < 300; key += 3) {
+        EXPECT_EQ(ih->insert_entry((const char *)&key, Rid{-1, -1}, nullptr), IX_NO_PAGE);
+    }
+    std::vector<int> probes = {1, 0, 3, 60000, 6, 3};
+    std::vector<const char *> probe_keys;
+    for (int &key : probes) {
+        probe_keys.push_back((const char *)&key);
+    }
+    std::vector<std::vector<Rid>> results;
+    ih->get_values(probe_keys, &results, nullptr);
+    for (size_t i = 0; i < probes.size(); i++) {
+        EXPECT_EQ(results[i], expected[probes[i]]);
+    }
+
+    for (int key = 0; key < 60000; key += 6) {
+        EXPECT_TRUE(ih->delete_entry((const char *)&key, expected[key][0], nullptr));
+        EXPECT_FALSE(ih->delete_entry((const char *)&key, expected[key][0], nullptr));
+        expected[key].clear();
+    }
+    check_values(ih, expected);
+    // 删除之后空出的位置可以再插入
+    for (int key = 0; key < 600; key += 6) {
+        EXPECT_NE(ih->insert_entry((const char *)&key, Rid{key, key}, nullptr), IX_NO_PAGE);
+        expected[key] = {Rid{key, key}};
+    }
+    check_values(ih, expected);
+}
+
+/**
+ * @brief 非唯一哈希索引：大量重复的key分不到不同的桶中，链接溢出页面；查到的rid按顺序排列，删除按(key, rid)进行
+ */
+TEST_F(IxHashTest, NonUniqueTest) {
+    // 表中已有的记录在建索引时插入
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; i++) {
+        keys.push_back(i % 10);
+    }
+    std::map<int, std::vector<Rid>> expected;
+    for (auto &[key, rid] : insert_rows(keys)) {
+        expected[key].push_back(rid);
+    }
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, false, {}, INDEX_HASH);
+    IxIndexHandle *ih = get_index();
+
+    std::mt19937 rng(1);
+    for (int i = 0; i < 5000; i++) {
+        int key = rng() % 10;
+        Rid rid{(int)(rng() % 1000) + RM_FIRST_RECORD_PAGE + 100, i};
+        EXPECT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        expected[key].push_back(rid);
+    }
+    // 相同的(key, rid)不能重复插入
+    EXPECT_EQ(ih->insert_entry((const char *)&expected.begin()->first, expected.begin()->second[0], nullptr),
+              IX_NO_PAGE);
+    for (auto &[key, rids] : expected) {
+        std::sort(rids.begin(), rids.end(), [](const Rid &a, const Rid &b) {
+            return a.page_no != b.page_no ? a.page_no < b.page_no : a.slot_no < b.slot_no;
+        });
+    }
+    check_values(ih, expected);
+
+    for (auto &[key, rids] : expected) {
+        for (size_t i = 0; i < rids.size(); i += 2) {
+            EXPECT_TRUE(ih->delete_entry((const char *)&key, rids[i], nullptr));
+        }
+        std::vector<Rid> left;
+        for (size_t i = 1; i < rids.size(); i += 2) {
+            left.push_back(rids[i]);
+        }
+        rids = left;
+    }
+    check_values(ih, expected);
+}
+
+/**
+ * @brief 在已有记录的表上建唯一哈希索引，所有记录都能查到
+ */
+TEST_F(IxHashTest, CreateIndexTest) {
+    std::vector<int> keys;
+    for (int i = 0; i < 10000; i++) {
+        keys.push_back(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(2));
+    std::map<int, std::vector<Rid>> expected;
+    for (auto &[key, rid] : insert_rows(keys)) {
+        expected[key] = {rid};
+    }
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, true, {}, INDEX_HASH);
+    check_values(get_index(), expected);
+}
+
+/**
+ * @brief 已有记录中存在重复的key时建唯一哈希索引失败
+ */
+TEST_F(IxHashTest, DuplicateKeyTest) {
+    insert_rows({3, 1, 2, 2});
+    EXPECT_THROW(sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, true, {}, INDEX_HASH),
+                 IndexDuplicateKeyError);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    EXPECT_FALSE(tab.is_index(TEST_COL));
+    EXPECT_FALSE(ix_manager_->exists(TEST_TAB_NAME, TEST_COL));
+}
+
+/**
+ * @brief 关闭后重新打开索引文件，目录和桶都从磁盘读回，之后可以继续插入
+ */
+TEST_F(IxHashTest, ReopenTest) {
+    std::vector<ColMeta> cols = {*sm_manager_->db_.get_table(TEST_TAB_NAME).get_col("col1")};
+    ix_manager_->create_index("reopen", cols, true, 0, INDEX_HASH);
+    auto ih = ix_manager_->open_index("reopen", cols);
+    std::map<int, std::vector<Rid>> expected;
+    for (int key = 0; key < 5000; key++) {
+        ih->insert_entry((const char *)&key, Rid{key, 0}, nullptr);
+        expected[key] = {Rid{key, 0}};
+    }
+    int global_depth = ih->get_global_depth();
+    int num_pages = ih->file_hdr_->num_pages_;
+    ix_manager_->close_index(ih.get());
+
+    ih = ix_manager_->open_index("reopen", cols);
+    ASSERT_TRUE(ih->is_hash());
+    EXPECT_EQ(ih->get_global_depth(), global_depth);
+    EXPECT_EQ(ih->file_hdr_->num_pages_, num_pages);
+    check_values(ih.get(), expected);
+    for (int key = 5000; key < 6000; key++) {
+        EXPECT_NE(ih->insert_entry((const char *)&key, Rid{key, 0}, nullptr), IX_NO_PAGE);
+        expected[key] = {Rid{key, 0}};
+    }
+    check_values(ih.get(), expected);
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief 多个线程同时插入、查找和删除，插入线程之间互不重叠，结束后索引中恰好是预期的键值对
+ */
+TEST_F(IxHashTest, ConcurrentTest) {
+    sm_manager_->create_index(TEST_TAB_NAME, TEST_COL, nullptr, true, {}, INDEX_HASH);
+    IxIndexHandle *ih = get_index();
+    const int num_threads = 4;
+    const int keys_per_thread = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([ih, t]() {
+            for (int i = 0; i < keys_per_thread; i++) {
+                int key = i * num_threads + t;
+                EXPECT_NE(ih->insert_entry((const char *)&key, Rid{key, t}, nullptr), IX_NO_PAGE);
+                // 查找自己插入过、没有删除的key，期间其他线程在分裂桶
+                int probe = i % 3 == 0 ? key : (i / 3 * 3 + 1) * num_threads + t;
+                std::vector<Rid> result;
+                EXPECT_TRUE(ih->get_value((const char *)&probe, &result, nullptr));
+                if (i % 3 == 0) {
+                    EXPECT_TRUE(ih->delete_entry((const char *)&key, Rid{key, t}, nullptr));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::map<int, std::vector<Rid>> expected;
+    for (int t = 0; t < num_threads; t++) {
+        for (int i = 0; i < keys_per_thread; i++) {
+            int key = i * num_threads + t;
+            expected[key] = i % 3 == 0 ? std::vector<Rid>{} : std::vector<Rid>{Rid{key, t}};
+        }
+    }
+    check_values(ih, expected);
+}
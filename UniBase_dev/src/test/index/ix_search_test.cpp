@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "index/ix_index_handle.h"
+#include "index/ix_search.h"
+
+/* 对每个长度和区间起点，SIMD查找的结果与std::lower_bound/std::upper_bound一致 */
+template <typename T>
+void check_bounds(const std::vector<T> &keys, const std::vector<T> &targets) {
+    const char *data = reinterpret_cast<const char *>(keys.data());
+    for (T target : targets) {
+        for (int lo : {0, 1}) {
+            int hi = std::max<int>(lo, keys.size());
+            int expected_lower = std::lower_bound(keys.begin() + lo, keys.begin() + hi, target) - keys.begin();
+            int expected_upper = std::upper_bound(keys.begin() + lo, keys.begin() + hi, target) - keys.begin();
+            EXPECT_EQ((ix_numeric_bound<T, false>(data, lo, hi, reinterpret_cast<const char *>(&target))),
+                      expected_lower);
+            EXPECT_EQ((ix_numeric_bound<T, true>(data, lo, hi, reinterpret_cast<const char *>(&target))),
+                      expected_upper);
+        }
+    }
+}
+
+/**
+ * @brief 有重复和负数的INT key，覆盖线性扫描、二分加线性扫描以及不足4个key的尾部
+ */
+TEST(IxSearchTest, IntTest) {
+    std::mt19937 rng(0);
+    for (int n = 1; n <= 340; n += 7) {
+        std::vector<int> keys(n);
+        for (int &key : keys) {
+            key = (int)(rng() % 200) - 100;
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<int> targets = {INT32_MIN, INT32_MAX, keys.front(), keys.back()};
+        for (int i = -101; i <= 101; i += 3) {
+            targets.push_back(i);
+        }
+        check_bounds(keys, targets);
+    }
+}
+
+TEST(IxSearchTest, FloatTest) {
+    std::mt19937 rng(1);
+    for (int n = 1; n <= 340; n += 7) {
+        std::vector<float> keys(n);
+        for (float &key : keys) {
+            key = (float)(rng() % 2000) / 8 - 125;
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<float> targets = {-1e30f, 1e30f, keys.front(), keys.back(), 0.0f, -0.0f};
+        for (int i = 0; i < 50; i++) {
+            targets.push_back(keys[rng() % n]);
+            targets.push_back((float)(rng() % 2000) / 8 - 125.0625f);
+        }
+        check_bounds(keys, targets);
+    }
+}
+
+IxFileHdr make_hdr(const std::vector<ColType> &types, const std::vector<int> &lens, bool encoded = false) {
+    IxFileHdr hdr;
+    hdr.col_num_ = types.size();
+    hdr.col_types_ = types;
+    hdr.col_lens_ = lens;
+    hdr.col_tot_len_ = 0;
+    for (int len : lens) {
+        hdr.col_tot_len_ += len;
+    }
+    hdr.encoded_ = encoded;
+    hdr.init_key_schema();
+    return hdr;
+}
+
+/**
+ * @brief 按字段类型选择key的形式
+ */
+TEST(IxSearchTest, KeySchemaTest) {
+    EXPECT_EQ(make_hdr({TYPE_INT}, {4}).key_schema_, IxKeySchema::INT);
+    EXPECT_EQ(make_hdr({TYPE_FLOAT}, {4}).key_schema_, IxKeySchema::FLOAT);
+    EXPECT_EQ(make_hdr({TYPE_STRING, TYPE_STRING}, {8, 4}).key_schema_, IxKeySchema::BYTES);
+    EXPECT_EQ(make_hdr({TYPE_STRING, TYPE_INT}, {8, 4}).key_schema_, IxKeySchema::GENERIC);
+    EXPECT_EQ(make_hdr({TYPE_STRING, TYPE_INT}, {8, 4}, true).key_schema_, IxKeySchema::BYTES);
+}
+
+/**
+ * @brief 编码后的多字段key按字节比较的结果与逐个字段比较一致，解码还原原来的key
+ */
+TEST(IxSearchTest, EncodeKeyTest) {
+    IxFileHdr hdr = make_hdr({TYPE_INT, TYPE_FLOAT, TYPE_STRING}, {4, 4, 3}, true);
+    std::mt19937 rng(2);
+    const std::vector<float> floats = {-1e30f, -2.5f, -1.0f, -0.0f, 0.0f, 1e-30f, 0.5f, 1.0f, 3e30f};
+    auto make_key = [&](std::vector<char> *key) {
+        int i = (int)(rng() % 7) - 3;
+        i = i == 3 ? INT32_MAX : (i == -3 ? INT32_MIN : i);
+        float f = floats[rng() % floats.size()];
+        key->resize(hdr.col_tot_len_);
+        memcpy(key->data(), &i, 4);
+        memcpy(key->data() + 4, &f, 4);
+        for (int j = 8; j < 11; j++) {
+            (*key)[j] = (char)(rng() % 3 == 0 ? 0 : 'a' + rng() % 2);
+        }
+    };
+    auto sign = [](int x) { return (x > 0) - (x < 0); };
+    for (int i = 0; i < 5000; i++) {
+        std::vector<char> a, b, ea(hdr.col_tot_len_), eb(hdr.col_tot_len_), da(hdr.col_tot_len_);
+        make_key(&a);
+        make_key(&b);
+        ix_encode_key(a.data(), &hdr, ea.data());
+        ix_encode_key(b.data(), &hdr, eb.data());
+        EXPECT_EQ(sign(memcmp(ea.data(), eb.data(), hdr.col_tot_len_)),
+                  sign(ix_compare(a.data(), b.data(), hdr.col_types_, hdr.col_lens_)));
+        ix_decode_key(ea.data(), &hdr, da.data());
+        EXPECT_EQ(ix_compare(a.data(), da.data(), hdr.col_types_, hdr.col_lens_), 0);
+    }
+}
@@ -0,0 +1,68 @@
+#include "common/arena.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "record/rm_defs.h"
+
+/**
+ * @brief 分配的地址满足对齐要求且互不重叠，大块分配单独占用内存块，reset后复用第一个块
+ */
+TEST(ArenaTest, AllocateTest) {
+    Arena arena(1024);
+    EXPECT_EQ(arena.memory_usage(), 0u);
+
+    std::vector<std::pair<char *, size_t>> allocs;
+    for (size_t i = 1; i <= 200; i++) {
+        size_t align = size_t(1) << (i % 4);
+        char *ptr = arena.allocate(i % 50 + 1, align);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % align, 0u);
+        memset(ptr, (int)i, i % 50 + 1);
+        allocs.emplace_back(ptr, i);
+    }
+    for (auto &alloc : allocs) {
+        size_t len = alloc.second % 50 + 1;
+        for (size_t j = 0; j < len; j++) {
+            ASSERT_EQ(alloc.first[j], (char)alloc.second);
+        }
+    }
+
+    // reset后只保留第一个块
+    arena.reset();
+    EXPECT_EQ(arena.memory_usage(), 1024u);
+    char *first = arena.allocate(8);
+
+    // 大块分配单独占用内存块，之后当前块剩余的空间仍然可用
+    char *large = arena.allocate(4000);
+    memset(large, 1, 4000);
+    size_t usage = arena.memory_usage();
+    EXPECT_EQ(usage, 1024u + 4000 + alignof(std::max_align_t));
+    char *second = arena.allocate(8);
+    EXPECT_EQ(second, first + alignof(std::max_align_t));
+    EXPECT_EQ(arena.memory_usage(), usage);
+}
+
+/**
+ * @brief 来自arena的RmRecord不单独释放数据；拷贝赋值时长度相同则复用原缓冲区，不再泄漏旧缓冲区
+ */
+TEST(ArenaTest, RecordTest) {
+    Arena arena;
+    char buf[16] = "hello arena";
+    RmRecord rec(16, buf, &arena);
+    EXPECT_FALSE(rec.allocated_);
+    EXPECT_EQ(memcmp(rec.data, buf, 16), 0);
+
+    RmRecord other(16);
+    memset(other.data, 'x', 16);
+    char *data = rec.data;
+    rec = other;
+    EXPECT_EQ(rec.data, data);
+    EXPECT_EQ(memcmp(rec.data, other.data, 16), 0);
+
+    RmRecord longer(32);
+    memset(longer.data, 'y', 32);
+    rec = longer;
+    EXPECT_TRUE(rec.allocated_);
+    EXPECT_EQ(rec.size, 32);
+    EXPECT_EQ(memcmp(rec.data, longer.data, 32), 0);
+}
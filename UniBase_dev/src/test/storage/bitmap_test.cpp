@@ -0,0 +1,82 @@
+#include "record/bitmap.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 逐位扫描的参考实现，用于校验按字扫描的结果
+ */
+static int naive_next_bit(bool bit, const char *bm, int max_n, int curr) {
+    for (int i = curr + 1; i < max_n; i++) {
+        if (Bitmap::is_set(bm, i) == bit) {
+            return i;
+        }
+    }
+    return max_n;
+}
+
+/**
+ * @brief 随机生成不同长度、不同密度的bitmap，比较next_bit/count/for_each_set_bit与逐位扫描的结果
+ */
+TEST(BitmapTest, MatchNaiveScan) {
+    std::mt19937 rng(2024);
+    const std::vector<int> lengths = {1, 7, 8, 9, 63, 64, 65, 127, 128, 129, 500, 1021, 4000};
+    const std::vector<int> densities = {0, 1, 50, 99, 100};  // 每一位为1的概率（%）
+
+    for (int max_n : lengths) {
+        for (int density : densities) {
+            int size = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+            std::vector<char> bm(size);
+            Bitmap::init(bm.data(), size);
+            int expect_cnt = 0;
+            std::vector<int> expect_set;
+            for (int i = 0; i < max_n; i++) {
+                if (static_cast<int>(rng() % 100) < density) {
+                    Bitmap::set(bm.data(), i);
+                    expect_cnt++;
+                    expect_set.push_back(i);
+                }
+            }
+            // 最后一个字节中超出max_n的位置为1，不能影响结果
+            for (int i = max_n; i < size * BITMAP_WIDTH; i++) {
+                Bitmap::set(bm.data(), i);
+            }
+
+            for (int curr = -1; curr < max_n; curr++) {
+                EXPECT_EQ(naive_next_bit(true, bm.data(), max_n, curr), Bitmap::next_bit(true, bm.data(), max_n, curr));
+                EXPECT_EQ(naive_next_bit(false, bm.data(), max_n, curr),
+                          Bitmap::next_bit(false, bm.data(), max_n, curr));
+            }
+            EXPECT_EQ(expect_cnt, Bitmap::count(bm.data(), max_n));
+
+            std::vector<int> actual_set;
+            Bitmap::for_each_set_bit(bm.data(), max_n, [&](int pos) { actual_set.push_back(pos); });
+            EXPECT_EQ(expect_set, actual_set);
+        }
+    }
+}
+
+/**
+ * @brief 只有最后一位可用时，first_bit应当越过前面所有已满的字
+ */
+TEST(BitmapTest, FirstFreeAfterFullWords) {
+    const int max_n = 1000;
+    int size = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    std::vector<char> bm(size);
+    Bitmap::init(bm.data(), size);
+    for (int i = 0; i < max_n - 1; i++) {
+        Bitmap::set(bm.data(), i);
+    }
+    EXPECT_EQ(max_n - 1, Bitmap::first_bit(false, bm.data(), max_n));
+    EXPECT_EQ(0, Bitmap::first_bit(true, bm.data(), max_n));
+
+    Bitmap::set(bm.data(), max_n - 1);
+    EXPECT_EQ(max_n, Bitmap::first_bit(false, bm.data(), max_n));
+    EXPECT_EQ(max_n, Bitmap::count(bm.data(), max_n));
+
+    Bitmap::reset(bm.data(), 517);
+    EXPECT_EQ(517, Bitmap::first_bit(false, bm.data(), max_n));
+    EXPECT_EQ(518, Bitmap::next_bit(true, bm.data(), max_n, 516));
+}
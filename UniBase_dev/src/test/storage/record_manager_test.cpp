@@ -4,10 +4,14 @@
 #include "record/rm.h"
 #undef private  // for use private variables in "rm.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <thread>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
@@ -28,10 +32,12 @@ struct rid_equal_t {
 };
 
 void check_equal(const RmFileHandle *file_handle,
-                 const std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> &mock) {
-    char *result = new char[BUFFER_LENGTH];
-    int offset = 0;
-    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+                 const std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> &mock, Context *context = nullptr) {
+    if (context == nullptr) {
+        char *result = new char[BUFFER_LENGTH];
+        int offset = 0;
+        context = new Context(nullptr, nullptr, nullptr, result, &offset);
+    }
     // Test all records
     for (auto &entry : mock) {
         Rid rid = entry.first;
@@ -96,7 +102,7 @@ TEST(RecordManagerTest, SimpleTest) {
         std::unique_ptr<RmFileHandle> file_handle = rm_manager->open_file(filename);
         // 检查filename文件在内存中的file header的参数
         assert(file_handle->file_hdr_.record_size == record_size);
-        assert(file_handle->file_hdr_.first_free_page_no == RM_NO_PAGE);
+        assert(file_handle->fsm_.find(1) == RM_NO_PAGE);
         assert(file_handle->file_hdr_.num_pages == 1);
 
         int max_bytes = file_handle->file_hdr_.record_size * file_handle->file_hdr_.num_records_per_page +
@@ -202,7 +208,7 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::unique_ptr<RmFileHandle> file_handle = rm_manager->open_file(filename);
         // 检查filename文件在内存中的file header的参数
         assert(file_handle->file_hdr_.record_size == record_size);
-        assert(file_handle->file_hdr_.first_free_page_no == RM_NO_PAGE);
+        assert(file_handle->fsm_.find(1) == RM_NO_PAGE);
         // printf("file_handle->file_hdr_.num_pages=%d\n", file_handle->file_hdr_.num_pages);
         assert(file_handle->file_hdr_.num_pages == 1);
 
@@ -223,4 +229,811 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 生成一条字段为 INT, CHAR(200), CHAR(100) 的记录，CHAR字段随机长度、尾部补0
+ */
+void rand_var_record(char *out_buf) {
+    memset(out_buf, 0, 304);
+    *(int *)out_buf = rand();
+    int len1 = rand() % 201;
+    int len2 = rand() % 101;
+    for (int i = 0; i < len1; i++) out_buf[4 + i] = 'a' + rand() % 26;
+    for (int i = 0; i < len2; i++) out_buf[204 + i] = 'a' + rand() % 26;
+}
+
+/**
+ * @brief 测试SLOTTED格式：变长元组的增删改查、页面整理和跨页迁移后rid保持不变
+ */
+TEST(RecordManagerTest, SlottedTest) {
+    srand((unsigned)time(nullptr));
+
+    auto lock_manager = std::make_unique<LockManager>();
+    // 每次操作后立即释放行锁，同一事务反复访问同一条记录时不会阻塞在自己持有的锁上
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "slotted.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    rm_manager->create_file(filename, 304, RM_STORAGE_SLOTTED, cols);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(file_handle->file_hdr_.storage_type == RM_STORAGE_SLOTTED);
+    assert(file_handle->file_hdr_.num_cols == 3);
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    char write_buf[PAGE_SIZE];
+    for (int round = 0; round < 3000; round++) {
+        double insert_prob = 1. - mock.size() / 500.;
+        double dice = rand() * 1. / RAND_MAX;
+        if (mock.empty() || dice < insert_prob) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            assert(mock.count(rid) == 0);
+            mock[rid] = std::string(write_buf, 304);
+        } else {
+            auto it = mock.begin();
+            std::advance(it, rand() % mock.size());
+            auto rid = it->first;
+            if (rand() % 2 == 0) {
+                rand_var_record(write_buf);
+                file_handle->update_record(rid, write_buf, context);
+                mock[rid] = std::string(write_buf, 304);
+            } else {
+                file_handle->delete_record(rid, context);
+                mock.erase(rid);
+            }
+        }
+        if (round % 500 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+        if (round % 100 == 0) {
+            check_equal(file_handle.get(), mock, context);
+        }
+    }
+    check_equal(file_handle.get(), mock, context);
+    // 平均每条记录约160字节，定长格式下每页只能放13条
+    int fixed_pages = (mock.size() + 12) / 13;
+    std::cout << "slotted pages " << file_handle->file_hdr_.num_pages - 1 << ", fixed pages at least " << fixed_pages
+              << '\n';
+    EXPECT_LT(file_handle->file_hdr_.num_pages - 1, fixed_pages);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief SLOTTED格式下迁移过的元组再变长、新位置也放不下时重新放置：扫描只持有页面读锁跟着FORWARD槽读取，
+ * 始终读到某一次完整写入的记录，不会读到已删除的旧元组
+ */
+TEST(RecordManagerTest, SlottedForwardScanTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "slotted_forward_scan.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    rm_manager->create_file(filename, 304, RM_STORAGE_SLOTTED, cols);
+    auto file_handle = rm_manager->open_file(filename);
+
+    // 记录的CHAR字段都由第一个字段给出的同一个字符填充，读到的记录可以自行校验
+    char write_buf[PAGE_SIZE];
+    auto make_record = [&](int c, int len1, int len2) {
+        memset(write_buf, 0, 304);
+        *(int *)write_buf = c;
+        memset(write_buf + 4, c, len1);
+        memset(write_buf + 204, c, len2);
+    };
+    // 先插入短记录把页面填满，之后变长的更新大多要迁移，已迁移的元组再变长时常常需要重新放置
+    std::vector<Rid> rids;
+    for (int i = 0; i < 300; i++) {
+        make_record('a' + i % 26, 0, 0);
+        rids.push_back(file_handle->insert_record(write_buf, context));
+    }
+
+    std::atomic<bool> stop = false;
+    std::atomic<bool> corrupted = false;
+    std::atomic<int> num_scans = 0;
+    auto valid = [](const char *record) {
+        int c = *(const int *)record;
+        return c >= 'a' && c <= 'z' &&
+               std::all_of(record + 4, record + 304, [&](char ch) { return ch == c || ch == 0; });
+    };
+    std::thread scanner([&]() {
+        std::vector<Rid> page_rids;
+        std::vector<const char *> records;
+        while (!stop && !corrupted) {
+            for (RmScan scan(file_handle.get()); scan.next_page(&page_rids, &records);) {
+                corrupted = corrupted || !std::all_of(records.begin(), records.end(), valid);
+            }
+            num_scans++;
+        }
+    });
+    for (int round = 0; !corrupted && (round < 5000 || num_scans < 10); round++) {
+        make_record('a' + round % 26, rand() % 201, rand() % 101);
+        file_handle->update_record(rids[rand() % rids.size()], write_buf, context);
+    }
+    stop = true;
+    scanner.join();
+    EXPECT_FALSE(corrupted);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 测试记录视图：FIXED格式直接指向页面，SLOTTED/PAX格式拼到视图缓冲区，内容都应与get_record一致
+ */
+TEST(RecordManagerTest, RecordViewTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        // 关闭文件时缓冲池不会淘汰该文件的页面，复用同一个fd会读到旧页面，所以每轮使用新的缓冲池
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "view.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        std::vector<Rid> rids;
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < 100; i++) {
+            rand_var_record(write_buf);
+            rids.push_back(file_handle->insert_record(write_buf, context));
+        }
+        RmRecordView view;
+        for (auto &rid : rids) {
+            file_handle->get_record_view(rid, context, &view);
+            auto rec = file_handle->get_record(rid, context);
+            ASSERT_TRUE(view.is_valid());
+            ASSERT_EQ(view.size(), rec->size);
+            EXPECT_EQ(memcmp(view.data(), rec->data, rec->size), 0);
+            EXPECT_EQ(memcmp(view.to_record()->data, rec->data, rec->size), 0);
+        }
+        // 释放视图后才能修改同一页面
+        view.release();
+        EXPECT_FALSE(view.is_valid());
+        file_handle->delete_record(rids[0], context);
+        EXPECT_THROW(file_handle->get_record_view(rids[0], context, &view), RecordNotFoundError);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 按页扫描：缓冲池只有很少的页框，扫描若漏掉unpin会很快耗尽缓冲池；
+ * 校验逐条扫描、按页扫描以及按页面范围切分后的扫描结果都与实际记录一致
+ */
+TEST(RecordManagerTest, PageScanTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(8, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "page_scan.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+        std::vector<Rid> inserted;
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < 400; i++) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+            inserted.push_back(rid);
+        }
+        // 删掉一部分记录，留下空槽和整页为空的页面
+        for (size_t i = 0; i < inserted.size(); i++) {
+            if (i % 3 == 0 || (i >= 100 && i < 160)) {
+                file_handle->delete_record(inserted[i], context);
+                mock.erase(inserted[i]);
+            }
+        }
+        int num_pages = file_handle->file_hdr_.num_pages;
+        ASSERT_GT(num_pages, 8);
+
+        for (int round = 0; round < 3; round++) {
+            check_equal(file_handle.get(), mock, context);
+
+            size_t num_records = 0;
+            std::vector<Rid> rids;
+            std::vector<const char *> records;
+            for (RmScan scan(file_handle.get()); scan.next_page(&rids, &records);) {
+                ASSERT_FALSE(rids.empty());
+                ASSERT_EQ(rids.size(), records.size());
+                for (size_t i = 0; i < rids.size(); i++) {
+                    EXPECT_EQ(rids[i].page_no, rids[0].page_no);
+                    ASSERT_TRUE(mock.count(rids[i]) > 0);
+                    EXPECT_EQ(memcmp(records[i], mock.at(rids[i]).c_str(), 304), 0);
+                }
+                num_records += rids.size();
+            }
+            EXPECT_EQ(num_records, mock.size());
+
+            // 按字段访问，每个字段的值都与整条记录中对应位置的数据一致
+            num_records = 0;
+            std::vector<RmColumnView> columns;
+            for (RmScan scan(file_handle.get()); scan.next_page_columns(&rids, &columns);) {
+                ASSERT_EQ(columns.size(), cols.size());
+                for (auto &rid : rids) {
+                    auto &expected = mock.at(rid);
+                    for (size_t c = 0; c < cols.size(); c++) {
+                        const char *value = columns[c].base + rid.slot_no * columns[c].stride;
+                        EXPECT_EQ(memcmp(value, expected.c_str() + cols[c].offset, cols[c].len), 0);
+                    }
+                }
+                num_records += rids.size();
+            }
+            EXPECT_EQ(num_records, mock.size());
+
+            // 把页面切成三段分别扫描，结果合起来应当与整表扫描一致
+            num_records = 0;
+            int step = num_pages / 3 + 1;
+            for (int start = 0; start < num_pages; start += step) {
+                for (RmScan scan(file_handle.get(), start, start + step); !scan.is_end(); scan.next()) {
+                    EXPECT_GE(scan.rid().page_no, start);
+                    EXPECT_LT(scan.rid().page_no, start + step);
+                    EXPECT_TRUE(mock.count(scan.rid()) > 0);
+                    num_records++;
+                }
+            }
+            EXPECT_EQ(num_records, mock.size());
+        }
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 批量插入：记录先填满已有页面的空闲槽位，再按页连续写入新页面，结果与逐条插入一致
+ */
+TEST(RecordManagerTest, BulkInsertTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "bulk.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+        char write_buf[PAGE_SIZE];
+        std::vector<Rid> single;
+        for (int i = 0; i < 50; i++) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+            single.push_back(rid);
+        }
+        for (size_t i = 0; i < single.size(); i += 2) {
+            file_handle->delete_record(single[i], context);
+            mock.erase(single[i]);
+        }
+
+        const int num_records = 500;
+        std::vector<char> bufs(num_records * 304);
+        for (int i = 0; i < num_records; i++) {
+            rand_var_record(bufs.data() + i * 304);
+        }
+        auto rids = file_handle->insert_records(bufs.data(), num_records, context);
+        ASSERT_EQ(rids.size(), (size_t)num_records);
+        for (int i = 0; i < num_records; i++) {
+            ASSERT_EQ(mock.count(rids[i]), 0u);
+            mock[rids[i]] = std::string(bufs.data() + i * 304, 304);
+        }
+        // 删除留下的空槽被优先利用
+        EXPECT_TRUE(mock.count(single[0]) > 0);
+        if (storage_type != RM_STORAGE_SLOTTED) {
+            int per_page = file_handle->file_hdr_.num_records_per_page;
+            EXPECT_EQ(file_handle->file_hdr_.num_pages - 1, ((int)mock.size() + per_page - 1) / per_page);
+        }
+        check_equal(file_handle.get(), mock, context);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 插入时槽位先加上行级排他锁再在bitmap中置位：其他事务未提交的删除空出来的槽位不会被复用，
+ * 插入的记录对其他事务可见时已经被锁住
+ */
+TEST(RecordManagerTest, InsertLockTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        auto lock_manager = std::make_unique<LockManager>();
+        // SERIALIZABLE下锁一直持有到事务结束
+        auto txn0 = std::make_unique<Transaction>(0, IsolationLevel::SERIALIZABLE);
+        auto txn1 = std::make_unique<Transaction>(1, IsolationLevel::SERIALIZABLE);
+        auto context0 = std::make_unique<Context>(lock_manager.get(), nullptr, txn0.get(), result, &offset);
+        auto context1 = std::make_unique<Context>(lock_manager.get(), nullptr, txn1.get(), result, &offset);
+        // 准备数据的事务插入后立即释放锁
+        auto load_txn = std::make_unique<Transaction>(2, IsolationLevel::REPEATABLE_READ);
+        auto load_context = std::make_unique<Context>(lock_manager.get(), nullptr, load_txn.get(), result, &offset);
+
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "insert_lock.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+        int fd = file_handle->GetFd();
+
+        char write_buf[PAGE_SIZE];
+        std::vector<Rid> inserted;
+        for (int i = 0; i < 10; i++) {
+            rand_var_record(write_buf);
+            inserted.push_back(file_handle->insert_record(write_buf, load_context.get()));
+        }
+        // txn0删除的槽位在txn0结束前仍被txn0锁住
+        file_handle->delete_record(inserted[3], context0.get());
+        file_handle->delete_record(inserted[5], context0.get());
+
+        rand_var_record(write_buf);
+        Rid rid = file_handle->insert_record(write_buf, context1.get());
+        EXPECT_NE(rid, inserted[3]);
+        EXPECT_NE(rid, inserted[5]);
+        EXPECT_TRUE(txn1->get_lock_set()->count(LockDataId(fd, rid, LockDataType::RECORD)) > 0);
+
+        std::vector<char> bufs(20 * 304);
+        for (int i = 0; i < 20; i++) {
+            rand_var_record(bufs.data() + i * 304);
+        }
+        auto rids = file_handle->insert_records(bufs.data(), 20, context1.get());
+        ASSERT_EQ(rids.size(), 20u);
+        for (auto &r : rids) {
+            EXPECT_NE(r, inserted[3]);
+            EXPECT_NE(r, inserted[5]);
+            EXPECT_TRUE(txn1->get_lock_set()->count(LockDataId(fd, r, LockDataType::RECORD)) > 0);
+        }
+
+        // 单条记录的写操作也加表级IX锁，建索引的表级S锁要等写记录的事务都结束
+        auto table_id = LockDataId(fd, LockDataType::TABLE);
+        auto txn3 = std::make_unique<Transaction>(3, IsolationLevel::SERIALIZABLE);
+        std::atomic<bool> table_locked{false};
+        std::thread build_thread([&]() {
+            lock_manager->lock_shared_on_table(txn3.get(), fd);
+            table_locked = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(table_locked);
+        lock_manager->unlock(txn1.get(), table_id);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(table_locked);  // txn0只删除过记录
+        lock_manager->unlock(txn0.get(), table_id);
+        build_thread.join();
+        EXPECT_TRUE(table_locked);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 空闲空间映射：删除记录后空出来的页面会被之后的插入找到；映射随文件关闭写入磁盘，
+ * 映射文件缺失时打开文件会扫描页面重建，两种方式得到的映射一致
+ */
+TEST(RecordManagerTest, FreeSpaceMapTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "fsm.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+        std::vector<Rid> rids;
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < 300; i++) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+            rids.push_back(rid);
+        }
+        int num_pages = file_handle->file_hdr_.num_pages;
+        ASSERT_GT(num_pages, 6);
+        // 清空第3页，之后的插入应当回到这个页面，而不是继续追加新页面
+        for (auto &rid : rids) {
+            if (rid.page_no == 3) {
+                file_handle->delete_record(rid, context);
+                mock.erase(rid);
+            }
+        }
+        EXPECT_EQ(file_handle->fsm_.get_level(3), RM_FSM_MAX_LEVEL);
+        // 映射在若干个有空闲的页面中按线程挑选，最后一页也有空闲，放满之前都不会追加新页面
+        for (bool reused = false; !reused;) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+            ASSERT_EQ(file_handle->file_hdr_.num_pages, num_pages);
+            reused = rid.page_no == 3;
+        }
+
+        std::vector<int> levels;
+        for (int page_no = 0; page_no < num_pages; page_no++) {
+            levels.push_back(file_handle->fsm_.get_level(page_no));
+        }
+        for (bool drop_fsm_file : {false, true}) {
+            rm_manager->close_file(file_handle.get());
+            if (drop_fsm_file) {
+                disk_manager->destroy_file(filename + ".fsm");
+            }
+            file_handle = rm_manager->open_file(filename);
+            for (int page_no = 0; page_no < num_pages; page_no++) {
+                EXPECT_EQ(file_handle->fsm_.get_level(page_no), levels[page_no]);
+            }
+        }
+        check_equal(file_handle.get(), mock, context);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief 空闲空间映射按记录需要的等级查找，空闲空间不多但放得下的页面也能找到；找到的页面可能差一点放不下，
+ * 调用者从下一个页面继续找；映射文件原地覆盖写，末尾残留上次的数据时仍能正确读回
+ */
+TEST(RecordManagerTest, FreeSpaceMapFindTest) {
+    RmFreeSpaceMap fsm(4000);
+    fsm.clear(4);
+    fsm.update(1, 100);
+    fsm.update(2, 300);
+    fsm.update(3, 4000);
+    EXPECT_EQ(fsm.get_level(1), 1);
+    EXPECT_EQ(fsm.get_level(2), 1);
+    // 需要200字节时等级1的页面都是候选，第1页差一点放不下，从头按顺序再找，跳过它后找到第2页
+    EXPECT_EQ(fsm.find(200, 2), 1);
+    int begin_page_no = RmFreeSpaceMap::retry_from(-1, 1);
+    EXPECT_EQ(fsm.find(200, 3, begin_page_no), 1);
+    begin_page_no = RmFreeSpaceMap::retry_from(begin_page_no, 1);
+    EXPECT_EQ(fsm.find(200, 3, begin_page_no), 2);
+    EXPECT_EQ(fsm.find(600, 3), RM_NO_PAGE);
+    EXPECT_EQ(fsm.find(4000, -1, 0), 3);
+
+    std::vector<char> buf(fsm.serialized_size());
+    fsm.serialize(buf.data());
+    buf.resize(buf.size() + 16, 0x7f);
+    RmFreeSpaceMap loaded(4000);
+    ASSERT_TRUE(loaded.deserialize(buf.data(), buf.size(), 4));
+    for (int page_no = 0; page_no < 4; page_no++) {
+        EXPECT_EQ(loaded.get_level(page_no), fsm.get_level(page_no));
+    }
+    EXPECT_FALSE(loaded.deserialize(buf.data(), sizeof(int), 4));
+}
+
+/**
+ * @brief PAX格式：页面内同一字段的值连续存放在minipage中，按Rid的增删改查与FIXED格式一致
+ */
+TEST(RecordManagerTest, PaxTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "pax.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    // 字段没有首尾相接地铺满记录时无法按字段切分页面，退化为与FIXED相同的布局
+    std::vector<RmColHdr> gap_cols = {{.offset = 0, .len = 4, .trim = false}, {.offset = 8, .len = 4, .trim = false}};
+    rm_manager->create_file(filename, 12, RM_STORAGE_PAX, gap_cols);
+    auto gap_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(gap_handle->file_hdr_.num_cols, 0);
+    rm_manager->close_file(gap_handle.get());
+    rm_manager->destroy_file(filename);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    rm_manager->create_file(filename, 304, RM_STORAGE_PAX, cols);
+    auto file_handle = rm_manager->open_file(filename);
+    assert(file_handle->file_hdr_.storage_type == RM_STORAGE_PAX);
+    int per_page = file_handle->file_hdr_.num_records_per_page;
+
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    char write_buf[PAGE_SIZE];
+    for (int round = 0; round < 2000; round++) {
+        double insert_prob = 1. - mock.size() / 300.;
+        double dice = rand() * 1. / RAND_MAX;
+        if (mock.empty() || dice < insert_prob) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+        } else {
+            auto it = mock.begin();
+            std::advance(it, rand() % mock.size());
+            auto rid = it->first;
+            if (rand() % 2 == 0) {
+                rand_var_record(write_buf);
+                file_handle->update_record(rid, write_buf, context);
+                mock[rid] = std::string(write_buf, 304);
+            } else {
+                file_handle->delete_record(rid, context);
+                mock.erase(rid);
+            }
+        }
+        if (round % 500 == 0) {
+            rm_manager->close_file(file_handle.get());
+            file_handle = rm_manager->open_file(filename);
+        }
+        if (round % 100 == 0) {
+            check_equal(file_handle.get(), mock, context);
+        }
+    }
+    check_equal(file_handle.get(), mock, context);
+
+    // 第一个字段的值在页面中是一段以槽号为下标的int数组
+    auto &first = *mock.begin();
+    auto page_handle = file_handle->fetch_page_handle(first.first.page_no);
+    const int *ints = reinterpret_cast<const int *>(page_handle.get_minipage(0));
+    EXPECT_EQ(ints[first.first.slot_no], *reinterpret_cast<const int *>(first.second.c_str()));
+    EXPECT_EQ(page_handle.get_minipage(1), page_handle.slots + per_page * 4);
+    buffer_pool_manager->unpin_page(page_handle.page->get_page_id(), false);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 文件整理：把尾部页面上的记录移动到前面的空闲槽位后截断文件，记录内容不变，只有rid改变；
+ * SLOTTED格式下迁移到尾部页面的元组随原记录一起移动
+ */
+TEST(RecordManagerTest, RelocateTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    std::vector<RmColHdr> cols = {{.offset = 0, .len = 4, .trim = false},
+                                  {.offset = 4, .len = 200, .trim = true},
+                                  {.offset = 204, .len = 100, .trim = true}};
+    for (auto storage_type : {RM_STORAGE_FIXED, RM_STORAGE_SLOTTED, RM_STORAGE_PAX}) {
+        auto disk_manager = std::make_unique<DiskManager>();
+        auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+        auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+        std::string filename = "relocate.txt";
+        if (disk_manager->is_file(filename)) {
+            disk_manager->destroy_file(filename);
+        }
+        rm_manager->create_file(filename, 304, storage_type, cols);
+        auto file_handle = rm_manager->open_file(filename);
+
+        std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+        std::vector<Rid> inserted;
+        char write_buf[PAGE_SIZE];
+        for (int i = 0; i < 600; i++) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+            inserted.push_back(rid);
+        }
+        // 删掉四分之三的记录，SLOTTED格式下再把一部分记录改长，使元组迁移到其他页面
+        for (size_t i = 0; i < inserted.size(); i++) {
+            if (i % 4 != 0) {
+                file_handle->delete_record(inserted[i], context);
+                mock.erase(inserted[i]);
+            } else if (storage_type == RM_STORAGE_SLOTTED && i % 8 == 0) {
+                memset(write_buf, 'z', 304);
+                file_handle->update_record(inserted[i], write_buf, context);
+                mock[inserted[i]] = std::string(write_buf, 304);
+            }
+        }
+        int old_pages = file_handle->file_hdr_.num_pages;
+
+        // 与SmManager::vacuum_table相同的过程，只是没有索引
+        int num_truncated = file_handle->truncate_empty_pages(context);
+        while (file_handle->file_hdr_.num_pages - 1 > RM_FIRST_RECORD_PAGE) {
+            int page_no = file_handle->file_hdr_.num_pages - 1;
+            bool vacated = true;
+            for (auto &rid : file_handle->get_relocation_rids(page_no)) {
+                Rid new_rid;
+                std::unique_ptr<RmRecord> record;
+                if (!file_handle->relocate_record(rid, page_no, context, &new_rid, &record)) {
+                    ASSERT_NE(record, nullptr);
+                    vacated = false;
+                    break;
+                }
+                ASSERT_LT(new_rid.page_no, page_no);
+                ASSERT_EQ(memcmp(record->data, mock.at(rid).c_str(), 304), 0);
+                mock.erase(rid);
+                mock[new_rid] = std::string(record->data, 304);
+            }
+            if (!vacated) {
+                break;
+            }
+            int n = file_handle->truncate_empty_pages(context);
+            ASSERT_GT(n, 0);
+            num_truncated += n;
+        }
+        int new_pages = file_handle->file_hdr_.num_pages;
+        EXPECT_EQ(old_pages - new_pages, num_truncated);
+        EXPECT_LT(new_pages * 2, old_pages);
+        check_equal(file_handle.get(), mock, context);
+
+        // 截断后的文件重新打开，文件大小与页面数一致，之后的插入从截断处继续分配页面
+        rm_manager->close_file(file_handle.get());
+        EXPECT_EQ(disk_manager->get_file_size(filename), new_pages * PAGE_SIZE);
+        file_handle = rm_manager->open_file(filename);
+        check_equal(file_handle.get(), mock, context);
+        for (int i = 0; i < 300; i++) {
+            rand_var_record(write_buf);
+            Rid rid = file_handle->insert_record(write_buf, context);
+            mock[rid] = std::string(write_buf, 304);
+        }
+        check_equal(file_handle.get(), mock, context);
+
+        rm_manager->close_file(file_handle.get());
+        rm_manager->destroy_file(filename);
+    }
+}
+
+/**
+ * @brief VACUUM截断文件时其他线程仍在顺序扫描：扫描按当前的页面数结束，不会访问已被截断的页面
+ */
+TEST(RecordManagerTest, TruncateScanTest) {
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn = std::make_unique<Transaction>(0, IsolationLevel::REPEATABLE_READ);
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(lock_manager.get(), nullptr, txn.get(), result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "truncate_scan.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, 304);
+    auto file_handle = rm_manager->open_file(filename);
+
+    const int num_kept = 1000;
+    const int num_appended = 500;
+    std::vector<char> bufs(num_kept * 304, 'a');
+    file_handle->insert_records(bufs.data(), num_kept, context);
+
+    std::atomic<bool> stop = false;
+    std::atomic<int> num_scans = 0;
+    std::thread scanner([&]() {
+        while (!stop) {
+            int count = 0;
+            for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+                count++;
+            }
+            ASSERT_GE(count, num_kept);
+            ASSERT_LE(count, num_kept + num_appended);
+            num_scans++;
+        }
+    });
+    // 反复在文件末尾追加页面再删空、截断
+    for (int round = 0; round < 50 || num_scans < 10; round++) {
+        auto rids = file_handle->insert_records(bufs.data(), num_appended, context);
+        for (auto &rid : rids) {
+            file_handle->delete_record(rid, context);
+        }
+        file_handle->truncate_empty_pages(context);
+    }
+    stop = true;
+    scanner.join();
+    EXPECT_LE(file_handle->file_hdr_.num_pages,
+              RM_FIRST_RECORD_PAGE + (num_kept + num_appended) / file_handle->file_hdr_.num_records_per_page + 2);
+
+    // 截断的表级X锁与写记录的表级IX锁冲突：未提交的插入放到了末尾的页面上时，截断要等插入的事务结束
+    auto writer_txn = std::make_unique<Transaction>(1, IsolationLevel::SERIALIZABLE);
+    Context writer_context(lock_manager.get(), nullptr, writer_txn.get());
+    int num_pages = file_handle->file_hdr_.num_pages;
+    Rid rid;
+    do {
+        rid = file_handle->insert_record(bufs.data(), &writer_context);
+    } while (rid.page_no < num_pages);
+    auto vacuum_txn = std::make_unique<Transaction>(2, IsolationLevel::SERIALIZABLE);
+    Context vacuum_context(lock_manager.get(), nullptr, vacuum_txn.get());
+    std::atomic<bool> truncated = false;
+    std::thread vacuum([&]() {
+        file_handle->truncate_empty_pages(&vacuum_context);
+        truncated = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(truncated);
+    lock_manager->unlock(writer_txn.get(), LockDataId(file_handle->GetFd(), LockDataType::TABLE));
+    vacuum.join();
+    EXPECT_EQ(file_handle->file_hdr_.num_pages, num_pages + 1);
+    EXPECT_TRUE(file_handle->is_record(rid));
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
@@ -0,0 +1,142 @@
+/**
+ * @brief 离线回放缓冲池访问轨迹，比较各Replacer在不同缓冲池大小下的命中率和开销
+ * @note 轨迹文件由BufferPoolManager::start_trace()生成，用法：
+ *       replacer_trace_bench <trace_file> [pool_size ...]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_replacer.h"
+#include "storage/buffer_pool_trace.h"
+
+struct ReplacerFactory {
+    std::string name;
+    std::function<std::unique_ptr<Replacer>(size_t)> create;
+};
+
+struct ReplayResult {
+    size_t fetches = 0;  // FETCH操作次数
+    size_t hits = 0;     // FETCH命中缓冲池的次数
+    size_t failed = 0;   // 所有frame都被pin住、无法分配frame的次数
+    double ns_per_op = 0;
+};
+
+/**
+ * @description: 只模拟BufferPoolManager的页表、pin计数和替换策略，不做磁盘读写
+ * @param {vector<BpmTraceRecord>&} trace 访问轨迹
+ * @param {Replacer*} replacer 被测替换策略
+ * @param {size_t} pool_size 缓冲池帧数
+ */
+ReplayResult replay(const std::vector<BpmTraceRecord> &trace, Replacer *replacer, size_t pool_size) {
+    ReplayResult res;
+    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table;
+    std::vector<PageId> frame_pages(pool_size);
+    std::vector<int> pin_counts(pool_size, 0);
+    std::list<frame_id_t> free_list;
+    for (size_t i = 0; i < pool_size; i++) {
+        free_list.push_back(static_cast<frame_id_t>(i));
+    }
+
+    // 分配一个frame并装入page，对应BufferPoolManager::find_victim_page + update_page
+    auto load = [&](const PageId &page_id) {
+        frame_id_t frame_id;
+        if (!free_list.empty()) {
+            frame_id = free_list.front();
+            free_list.pop_front();
+        } else if (replacer->victim(&frame_id)) {
+            page_table.erase(frame_pages[frame_id]);
+        } else {
+            res.failed++;
+            return;
+        }
+        page_table[page_id] = frame_id;
+        frame_pages[frame_id] = page_id;
+        pin_counts[frame_id] = 1;
+        replacer->pin(frame_id);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto &rec : trace) {
+        auto it = page_table.find(rec.page_id);
+        switch (rec.op) {
+            case BpmTraceOp::FETCH:
+                res.fetches++;
+                if (it != page_table.end()) {
+                    res.hits++;
+                    pin_counts[it->second]++;
+                    replacer->pin(it->second);
+                } else {
+                    load(rec.page_id);
+                }
+                break;
+            case BpmTraceOp::NEW:
+                if (it == page_table.end()) {
+                    load(rec.page_id);
+                }
+                break;
+            case BpmTraceOp::UNPIN:
+                if (it != page_table.end() && pin_counts[it->second] > 0 && --pin_counts[it->second] == 0) {
+                    replacer->unpin(it->second);
+                }
+                break;
+            case BpmTraceOp::DELETE:
+                if (it != page_table.end() && pin_counts[it->second] == 0) {
+                    replacer->pin(it->second);  // 从replacer中移除
+                    free_list.push_back(it->second);
+                    page_table.erase(it);
+                }
+                break;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    res.ns_per_op = trace.empty() ? 0 : static_cast<double>(ns) / trace.size();
+    return res;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace_file> [pool_size ...]\n", argv[0]);
+        return 1;
+    }
+    std::vector<size_t> pool_sizes;
+    for (int i = 2; i < argc; i++) {
+        pool_sizes.push_back(strtoul(argv[i], nullptr, 10));
+    }
+    if (pool_sizes.empty()) {
+        pool_sizes = {64, 256, 1024, 4096, 16384};
+    }
+
+    std::vector<BpmTraceRecord> trace;
+    BpmTraceReader reader(argv[1]);
+    BpmTraceRecord rec;
+    while (reader.next(&rec)) {
+        trace.push_back(rec);
+    }
+    printf("trace: %s, %zu records\n", argv[1], trace.size());
+
+    std::vector<ReplacerFactory> factories = {
+        {"LRU", [](size_t n) { return std::make_unique<LRUReplacer>(n); }},
+        {"CLOCK", [](size_t n) { return std::make_unique<ClockReplacer>(n); }},
+    };
+
+    printf("%-8s %10s %12s %10s %10s %10s\n", "replacer", "pool_size", "fetches", "hit_ratio", "failed", "ns/op");
+    for (auto &factory : factories) {
+        for (size_t pool_size : pool_sizes) {
+            auto replacer = factory.create(pool_size);
+            auto res = replay(trace, replacer.get(), pool_size);
+            double hit_ratio = res.fetches == 0 ? 0 : static_cast<double>(res.hits) / res.fetches;
+            printf("%-8s %10zu %12zu %10.4f %10zu %10.1f\n", factory.name.c_str(), pool_size, res.fetches, hit_ratio,
+                   res.failed, res.ns_per_op);
+        }
+    }
+    return 0;
+}
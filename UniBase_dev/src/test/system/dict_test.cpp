@@ -0,0 +1,180 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_abstract.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+
+const std::string TEST_DB_NAME = "DictTest_db";
+const std::string TEST_TAB_NAME = "tab";
+
+class DictTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        open_sm();
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+    }
+
+    void TearDown() override {
+        sm_manager_ = nullptr;
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        std::string cmd = "rm -rf " + TEST_DB_NAME;
+        if (system(cmd.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    /* 模拟重启：丢弃所有打开的文件，重新创建各个管理器 */
+    void open_sm() {
+        sm_manager_ = nullptr;
+        ix_manager_ = nullptr;
+        rm_manager_ = nullptr;
+        buffer_pool_manager_ = nullptr;
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+    }
+};
+
+/**
+ * @description: 字典编码字段在记录中只占一个int，编码在重新打开数据库后保持不变
+ */
+TEST_F(DictTest, EncodeTest) {
+    std::vector<ColDef> col_defs = {{.name = "id", .type = TYPE_INT, .len = 4},
+                                    {.name = "city", .type = TYPE_STRING, .len = 32, .dict = true},
+                                    {.name = "note", .type = TYPE_STRING, .len = 8}};
+    sm_manager_->create_table(TEST_TAB_NAME, col_defs, nullptr);
+    TabMeta &tab = sm_manager_->db_.get_table(TEST_TAB_NAME);
+    EXPECT_EQ(tab.cols[1].len, (int)sizeof(int));
+    EXPECT_EQ(tab.cols[1].dict_len, 32);
+    EXPECT_EQ(tab.cols[2].offset, 8);
+    EXPECT_EQ(sm_manager_->fhs_.at(TEST_TAB_NAME)->get_file_hdr().record_size, 16);
+    EXPECT_EQ(sm_manager_->get_col_dict(tab.cols[2]), nullptr);
+
+    std::vector<std::string> cities = {"beijing", "shanghai", "", "beijing", "shenzhen", "shanghai"};
+    std::vector<int> codes;
+    ColDict *dict = sm_manager_->get_col_dict(tab.cols[1]);
+    for (auto &city : cities) {
+        codes.push_back(dict->encode(city));
+    }
+    EXPECT_EQ(codes, std::vector<int>({0, 1, 2, 0, 3, 1}));
+    EXPECT_EQ(dict->size(), 4);
+    EXPECT_EQ(dict->lookup("guangzhou"), ColDict::NO_CODE);
+    EXPECT_EQ(dict->decode(3), "shenzhen");
+
+    // 重新打开数据库，字典从字典文件中恢复
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    open_sm();
+    sm_manager_->open_db(TEST_DB_NAME);
+    ColMeta city_col = *sm_manager_->db_.get_table(TEST_TAB_NAME).get_col("city");
+    EXPECT_EQ(city_col.dict_len, 32);
+    dict = sm_manager_->get_col_dict(city_col);
+    ASSERT_NE(dict, nullptr);
+    EXPECT_EQ(dict->size(), 4);
+    for (size_t i = 0; i < cities.size(); i++) {
+        EXPECT_EQ(dict->lookup(cities[i]), codes[i]);
+        EXPECT_EQ(dict->decode(codes[i]), cities[i]);
+    }
+    EXPECT_EQ(dict->encode("guangzhou"), 4);
+
+    // 删除表时字典文件一起删除，同名的新表从空字典开始
+    sm_manager_->drop_table(TEST_TAB_NAME, nullptr);
+    EXPECT_FALSE(disk_manager_->is_file(SmDict::get_file_name(TEST_TAB_NAME)));
+    sm_manager_->create_table(TEST_TAB_NAME, col_defs, nullptr);
+    dict = sm_manager_->get_col_dict(sm_manager_->db_.get_table(TEST_TAB_NAME).cols[1]);
+    EXPECT_EQ(dict->size(), 0);
+}
+
+/**
+ * @description: 等值条件直接比较编码，范围条件解码后按字符串比较
+ */
+TEST_F(DictTest, CompareTest) {
+    sm_manager_->create_table(TEST_TAB_NAME,
+                              {{.name = "a", .type = TYPE_STRING, .len = 16, .dict = true},
+                               {.name = "b", .type = TYPE_STRING, .len = 16}},
+                              nullptr);
+    ColMeta col_a = sm_manager_->db_.get_table(TEST_TAB_NAME).cols[0];
+    ColMeta col_b = sm_manager_->db_.get_table(TEST_TAB_NAME).cols[1];
+    ColDict *dict = sm_manager_->get_col_dict(col_a);
+    // 编码顺序与字符串顺序相反
+    int code_z = dict->encode("zebra");
+    int code_a = dict->encode("apple");
+
+    Condition eq_cond;
+    eq_cond.op = OP_EQ;
+    EXPECT_EQ(AbstractExecutor::compare_cond(eq_cond, col_a, (char *)&code_z, TYPE_STRING, (char *)&code_z, 4), 0);
+    EXPECT_NE(AbstractExecutor::compare_cond(eq_cond, col_a, (char *)&code_z, TYPE_STRING, (char *)&code_a, 4), 0);
+
+    Condition lt_cond;
+    lt_cond.op = OP_LT;
+    lt_cond.lhs_dict = dict;
+    std::string rhs = "banana";
+    rhs.resize(col_a.dict_len, '\0');
+    EXPECT_LT(AbstractExecutor::compare_cond(lt_cond, col_a, (char *)&code_a, TYPE_STRING, rhs.data(), rhs.size()), 0);
+    EXPECT_GT(AbstractExecutor::compare_cond(lt_cond, col_a, (char *)&code_z, TYPE_STRING, rhs.data(), rhs.size()), 0);
+
+    // 字典编码字段与普通CHAR字段比较
+    Condition col_cond;
+    col_cond.op = OP_EQ;
+    col_cond.lhs_dict = dict;
+    std::string b = "apple";
+    b.resize(col_b.len, '\0');
+    EXPECT_EQ(AbstractExecutor::compare_cond(col_cond, col_a, (char *)&code_a, TYPE_STRING, b.data(), b.size()), 0);
+    EXPECT_NE(AbstractExecutor::compare_cond(col_cond, col_a, (char *)&code_z, TYPE_STRING, b.data(), b.size()), 0);
+}
+
+/**
+ * @brief 当前版本写出的元数据能原样读回；没有版本行的旧版本数据库（表文件头、索引文件头的格式也不同）
+ * 和更新版本的数据库都拒绝打开
+ */
+TEST_F(DictTest, MetaVersionTest) {
+    std::istringstream old_meta(
+        "old_db\n1\n"
+        "tab\n2\ntab a 0 4 0 0\ntab b 2 16 4 0\n"
+        "1\ntab 4 1\ntab a 0 4 0 0\n\n");
+    DbMeta old_db;
+    EXPECT_THROW(old_meta >> old_db, InternalError);
+
+    sm_manager_->create_table(TEST_TAB_NAME,
+                              {{.name = "a", .type = TYPE_STRING, .len = 16, .dict = true},
+                               {.name = "b", .type = TYPE_INT, .len = 4}},
+                              nullptr);
+    std::stringstream meta;
+    meta << sm_manager_->db_;
+    DbMeta db;
+    meta >> db;
+    ASSERT_TRUE(meta);
+    TabMeta &tab = db.get_table(TEST_TAB_NAME);
+    ASSERT_EQ(tab.cols.size(), 2);
+    EXPECT_EQ(tab.cols[0].dict_len, 16);
+    EXPECT_EQ(tab.cols[1].offset, sm_manager_->db_.get_table(TEST_TAB_NAME).cols[1].offset);
+
+    std::istringstream future_meta(DB_META_VERSION_TAG + " " + std::to_string(DB_META_VERSION + 1) + "\nnew_db\n0\n");
+    DbMeta future_db;
+    EXPECT_THROW(future_meta >> future_db, InternalError);
+}
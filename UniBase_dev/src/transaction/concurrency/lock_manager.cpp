@@ -8,30 +8,7 @@
  * @param {int} tab_fd
  */
 bool LockManager::lock_shared_on_record(Transaction* txn, const Rid& rid, int tab_fd) {
-    std::unique_lock<std::mutex> lock(latch_);
-    // 读未提交的级别不支持加锁
-    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
-        txn->set_state(TransactionState::ABORTED);
-        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
-    }
-
-    auto lockDataId = LockDataId(tab_fd, rid, LockDataType::RECORD);
-    txn->get_lock_set()->insert(lockDataId);
-    txn->set_state(TransactionState::GROWING);
-
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::SHARED);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (
-        lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::NON_LOCK &&
-        lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::S) {
-        lock_table_[lockDataId].cv_.wait(lock);  // S锁只与S锁相容
-    }
-
-    request->granted_ = true;
-    lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::S;
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+    return acquire(txn, LockDataId(tab_fd, rid, LockDataType::RECORD), LockMode::SHARED);
 }
 
 /**
@@ -42,75 +19,57 @@ bool LockManager::lock_shared_on_record(Transaction* txn, const Rid& rid, int ta
  * @param {int} tab_fd 记录所在的表的fd
  */
 bool LockManager::lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd) {
+    return acquire(txn, LockDataId(tab_fd, rid, LockDataType::RECORD), LockMode::EXLUCSIVE);
+}
+
+/**
+ * @description: 不等待地申请同一张表上一批记录的行级排他锁，整批只获取一次锁表的latch
+ * 供插入在持有页面写锁时锁住将要使用的空闲槽位：槽位上的锁被其他事务持有时（如未提交的删除）不等待，
+ * 调用者不复用这个槽位，避免在持有页面写锁时等待行锁
+ * @return {bool} 是否全部加锁成功
+ * @param {Transaction*} txn 要申请锁的事务对象指针
+ * @param {vector<Rid>&} rids 加锁的目标记录
+ * @param {int} tab_fd 记录所在的表的fd
+ * @param {vector<Rid>*} locked 加锁成功的记录，与rids中的顺序一致
+ */
+bool LockManager::try_lock_exclusive_on_records(Transaction* txn, const std::vector<Rid>& rids, int tab_fd,
+                                                std::vector<Rid>* locked) {
     std::unique_lock<std::mutex> lock(latch_);
     // 读未提交的级别不支持加锁
     if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
         txn->set_state(TransactionState::ABORTED);
         throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
     }
-
-    auto lockDataId = LockDataId(tab_fd, rid, LockDataType::RECORD);
-    txn->get_lock_set()->insert(lockDataId);
     txn->set_state(TransactionState::GROWING);
 
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::EXLUCSIVE);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::NON_LOCK) {
-        lock_table_[lockDataId].cv_.wait(lock);  // X锁不与其他任何锁相容
+    for (auto& rid : rids) {
+        auto lockDataId = LockDataId(tab_fd, rid, LockDataType::RECORD);
+        auto& request_queue = lock_table_[lockDataId];
+        if (!compatible(held_mode(request_queue, txn->get_transaction_id()), LockMode::EXLUCSIVE)) {
+            continue;  // X锁不与其他事务的任何锁相容
+        }
+        locked->push_back(rid);
+        // 本事务已经持有这条记录的X锁（如复用了本事务刚删除的槽位），无需再申请
+        if (request_queue.group_lock_mode_ == GroupLockMode::X) {
+            continue;
+        }
+        txn->get_lock_set()->insert(lockDataId);
+        auto request = request_queue.request_queue_.emplace(request_queue.request_queue_.end(),
+                                                            txn->get_transaction_id(), LockMode::EXLUCSIVE);
+        request->granted_ = true;
+        request_queue.group_lock_mode_ = GroupLockMode::X;
     }
-
-    request->granted_ = true;
-    lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::X;
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+    return locked->size() == rids.size();
 }
 
-/*
-本来这几个锁的内部实现挺相似可以写一个抽象类让这几个哥儿继承但是有点麻烦
-还是复制粘贴最稳妥
-*/
-
 /**
  * @description: 申请表级读锁
  * @return {bool} 返回加锁是否成功
  * @param {Transaction*} txn 要申请锁的事务对象指针
  * @param {int} tab_fd 目标表的fd
  */
-bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd) {  
-    // 淦我写半天才反应过来tab是table的缩写
-    std::unique_lock<std::mutex> lock(latch_);
-    // 读未提交的级别不支持加锁
-    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
-        txn->set_state(TransactionState::ABORTED);
-        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
-    }
-
-    auto lockDataId = LockDataId(tab_fd, LockDataType::TABLE);
-    txn->get_lock_set()->insert(lockDataId);
-    txn->set_state(TransactionState::GROWING);
-
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::SHARED);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (
-        lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::NON_LOCK &&
-        lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::S &&
-        lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::IS) {
-        lock_table_[lockDataId].cv_.wait(lock);  // S锁只和IS锁及S锁相容
-    }
-
-    request->granted_ = true;
-
-    if (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::NON_LOCK ||
-        lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::IS) {
-        lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::S;
-    } else if (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::IX) {
-        lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::SIX;
-    }
-
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd) {
+    return acquire(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::SHARED);
 }
 
 /**
@@ -120,28 +79,7 @@ bool LockManager::lock_shared_on_table(Transaction* txn, int tab_fd) {
  * @param {int} tab_fd 目标表的fd
  */
 bool LockManager::lock_exclusive_on_table(Transaction* txn, int tab_fd) {
-    std::unique_lock<std::mutex> lock(latch_);
-    // 读未提交的级别不支持加锁
-    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
-        txn->set_state(TransactionState::ABORTED);
-        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
-    }
-
-    auto lockDataId = LockDataId(tab_fd, LockDataType::TABLE);
-    txn->get_lock_set()->insert(lockDataId);
-    txn->set_state(TransactionState::GROWING);
-
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::EXLUCSIVE);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (lock_table_[lockDataId].group_lock_mode_ != GroupLockMode::NON_LOCK) {
-        lock_table_[lockDataId].cv_.wait(lock);  // X锁不与其他任何锁相容
-    }
-
-    request->granted_ = true;
-    lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::X;
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+    return acquire(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::EXLUCSIVE);
 }
 
 /**
@@ -151,30 +89,7 @@ bool LockManager::lock_exclusive_on_table(Transaction* txn, int tab_fd) {
  * @param {int} tab_fd 目标表的fd
  */
 bool LockManager::lock_IS_on_table(Transaction* txn, int tab_fd) {
-    std::unique_lock<std::mutex> lock(latch_);
-    // 读未提交的级别不支持加锁
-    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
-        txn->set_state(TransactionState::ABORTED);
-        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
-    }
-
-    auto lockDataId = LockDataId(tab_fd, LockDataType::TABLE);
-    txn->get_lock_set()->insert(lockDataId);
-    txn->set_state(TransactionState::GROWING);
-
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::INTENTION_SHARED);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::X) {
-        lock_table_[lockDataId].cv_.wait(lock);  // IS锁与除X锁外的其他锁都相容
-    }
-
-    request->granted_ = true;
-    if (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::NON_LOCK) {
-        lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::IS;
-    }
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+    return acquire(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::INTENTION_SHARED);
 }
 
 /**
@@ -184,36 +99,7 @@ bool LockManager::lock_IS_on_table(Transaction* txn, int tab_fd) {
  * @param {int} tab_fd 目标表的fd
  */
 bool LockManager::lock_IX_on_table(Transaction* txn, int tab_fd) {
-    std::unique_lock<std::mutex> lock(latch_);
-    // 读未提交的级别不支持加锁
-    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
-        txn->set_state(TransactionState::ABORTED);
-        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
-    }
-
-    auto lockDataId = LockDataId(tab_fd, LockDataType::TABLE);
-    txn->get_lock_set()->insert(lockDataId);
-    txn->set_state(TransactionState::GROWING);
-
-    LockRequest* request = new LockRequest(txn->get_transaction_id(), LockMode::INTENTION_EXCLUSIVE);
-    lock_table_[lockDataId].request_queue_.push_back(*request);
-
-    while (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::S ||
-           lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::SIX ||
-           lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::X) {
-        lock_table_[lockDataId].cv_.wait(lock);  // IX锁与S锁，SIX锁及X锁不相容
-    }
-
-    request->granted_ = true;
-    if (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::NON_LOCK ||
-        lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::IS) {
-        lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::IX;
-    } else if (lock_table_[lockDataId].group_lock_mode_ == GroupLockMode::S) {
-        lock_table_[lockDataId].group_lock_mode_ = GroupLockMode::SIX;
-    }
-
-    lock_table_[lockDataId].cv_.notify_all();
-    return true;
+    return acquire(txn, LockDataId(tab_fd, LockDataType::TABLE), LockMode::INTENTION_EXCLUSIVE);
 }
 
 /**
@@ -224,7 +110,26 @@ bool LockManager::lock_IX_on_table(Transaction* txn, int tab_fd) {
  */
 bool LockManager::unlock(Transaction* txn, LockDataId lock_data_id) {
     std::unique_lock<std::mutex> lock(latch_);
+    return unlock_without_latch(txn, lock_data_id);
+}
 
+/**
+ * @description: 释放同一张表上一批记录的锁，整批只获取一次锁表的latch
+ * @param {Transaction*} txn 要释放锁的事务对象指针
+ * @param {vector<Rid>&} rids 要释放锁的记录
+ * @param {int} tab_fd 记录所在的表的fd
+ */
+void LockManager::unlock_records(Transaction* txn, const std::vector<Rid>& rids, int tab_fd) {
+    std::unique_lock<std::mutex> lock(latch_);
+    for (auto& rid : rids) {
+        unlock_without_latch(txn, LockDataId(tab_fd, rid, LockDataType::RECORD));
+    }
+}
+
+/**
+ * @description: 释放锁的实际操作，调用者需要持有latch_
+ */
+bool LockManager::unlock_without_latch(Transaction* txn, const LockDataId& lock_data_id) {
     txn->set_state(TransactionState::SHRINKING);
     if (txn->get_lock_set()->find(lock_data_id) == txn->get_lock_set()->end()) {
         return false;
@@ -242,34 +147,99 @@ bool LockManager::unlock(Transaction* txn, LockDataId lock_data_id) {
     }
 
     // 根据请求队列的情况重新为该组分配锁的等级
-    GroupLockMode mode = GroupLockMode::NON_LOCK;
-    for (auto request : *requestQueue) {
-        if (request.granted_) {
-            if (request.lock_mode_ == LockMode::EXLUCSIVE) {
-                mode = GroupLockMode::X;
+    GroupLockMode mode = held_mode(lock_table_[lock_data_id], INVALID_TXN_ID);
+    lock_table_[lock_data_id].group_lock_mode_ = mode;
+    lock_table_[lock_data_id].cv_.notify_all();
+    return true;
+}
+
+/**
+ * @description: 申请锁的公共过程，只等待其他事务持有的不相容的锁
+ * 本事务已经持有的锁不会阻塞自己：如先插入（IX）再建索引（S）时合并为SIX，持有S锁的记录可以升级为X锁
+ * @return {bool} 加锁是否成功
+ * @param {Transaction*} txn 要申请锁的事务对象指针
+ * @param {LockDataId&} lock_data_id 加锁的目标
+ * @param {LockMode} mode 申请的锁类型
+ */
+bool LockManager::acquire(Transaction* txn, const LockDataId& lock_data_id, LockMode mode) {
+    std::unique_lock<std::mutex> lock(latch_);
+    // 读未提交的级别不支持加锁
+    if (txn->get_isolation_level() == IsolationLevel::READ_UNCOMMITTED) {
+        txn->set_state(TransactionState::ABORTED);
+        throw TransactionAbortException(txn->get_transaction_id(), AbortReason::LOCK_ON_SHIRINKING);
+    }
+
+    txn->get_lock_set()->insert(lock_data_id);
+    txn->set_state(TransactionState::GROWING);
+
+    auto& request_queue = lock_table_[lock_data_id];
+    auto request =
+        request_queue.request_queue_.emplace(request_queue.request_queue_.end(), txn->get_transaction_id(), mode);
+    while (!compatible(held_mode(request_queue, txn->get_transaction_id()), mode)) {
+        request_queue.cv_.wait(lock);
+    }
+
+    request->granted_ = true;
+    request_queue.group_lock_mode_ = held_mode(request_queue, INVALID_TXN_ID);
+    request_queue.cv_.notify_all();
+    return true;
+}
+
+/**
+ * @description: 队列中已获得的锁合在一起的锁模式，不计入事务except_txn_id的锁；except_txn_id为INVALID_TXN_ID时计入所有锁
+ */
+LockManager::GroupLockMode LockManager::held_mode(const LockRequestQueue& request_queue, txn_id_t except_txn_id) {
+    bool shared = false;
+    bool intention_exclusive = false;
+    bool intention_shared = false;
+    for (auto& request : request_queue.request_queue_) {
+        if (!request.granted_ || request.txn_id_ == except_txn_id) {
+            continue;
+        }
+        switch (request.lock_mode_) {
+            case LockMode::EXLUCSIVE:
+                return GroupLockMode::X;
+            case LockMode::S_IX:
+                shared = intention_exclusive = true;
+                break;
+            case LockMode::SHARED:
+                shared = true;
+                break;
+            case LockMode::INTENTION_EXCLUSIVE:
+                intention_exclusive = true;
+                break;
+            case LockMode::INTENTION_SHARED:
+                intention_shared = true;
                 break;
-            } else if (request.lock_mode_ == LockMode::S_IX) {
-                mode = GroupLockMode::SIX;
-            } else if (request.lock_mode_ == LockMode::SHARED && mode != GroupLockMode::SIX) {
-                if (mode == GroupLockMode::IX) {
-                    mode = GroupLockMode::SIX;
-                } else {
-                    mode = GroupLockMode::S;
-                }
-            } else if (request.lock_mode_ == LockMode::INTENTION_EXCLUSIVE && mode != GroupLockMode::SIX) {
-                if (mode == GroupLockMode::S) {
-                    mode = GroupLockMode::SIX;
-                } else {
-                    mode = GroupLockMode::IX;
-                }
-            } else if (request.lock_mode_ == LockMode::INTENTION_SHARED &&
-                       (mode == GroupLockMode::NON_LOCK || mode == GroupLockMode::IS)) {
-                mode = GroupLockMode::IS;
-            }
         }
     }
+    if (shared && intention_exclusive) {
+        return GroupLockMode::SIX;
+    }
+    if (shared) {
+        return GroupLockMode::S;
+    }
+    if (intention_exclusive) {
+        return GroupLockMode::IX;
+    }
+    return intention_shared ? GroupLockMode::IS : GroupLockMode::NON_LOCK;
+}
 
-    lock_table_[lock_data_id].group_lock_mode_ = mode;
-    lock_table_[lock_data_id].cv_.notify_all();
-    return true;
-}
\ No newline at end of file
+/**
+ * @description: 申请的锁mode与已有的锁held是否相容
+ */
+bool LockManager::compatible(GroupLockMode held, LockMode mode) {
+    switch (mode) {
+        case LockMode::EXLUCSIVE:
+            return held == GroupLockMode::NON_LOCK;  // X锁不与其他任何锁相容
+        case LockMode::SHARED:
+            return held == GroupLockMode::NON_LOCK || held == GroupLockMode::IS || held == GroupLockMode::S;
+        case LockMode::INTENTION_SHARED:
+            return held != GroupLockMode::X;  // IS锁与除X锁外的其他锁都相容
+        case LockMode::INTENTION_EXCLUSIVE:
+            return held == GroupLockMode::NON_LOCK || held == GroupLockMode::IS || held == GroupLockMode::IX;
+        case LockMode::S_IX:
+            return held == GroupLockMode::NON_LOCK || held == GroupLockMode::IS;
+    }
+    return false;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <vector>
 #include <condition_variable>
 #include "transaction/transaction.h"
 
@@ -41,6 +42,9 @@ public:
 
     bool lock_exclusive_on_record(Transaction* txn, const Rid& rid, int tab_fd);
 
+    bool try_lock_exclusive_on_records(Transaction* txn, const std::vector<Rid>& rids, int tab_fd,
+                                       std::vector<Rid>* locked);
+
     bool lock_shared_on_table(Transaction* txn, int tab_fd);
 
     bool lock_exclusive_on_table(Transaction* txn, int tab_fd);
@@ -51,7 +55,17 @@ public:
 
     bool unlock(Transaction* txn, LockDataId lock_data_id);
 
+    void unlock_records(Transaction* txn, const std::vector<Rid>& rids, int tab_fd);
+
 private:
+    bool acquire(Transaction* txn, const LockDataId& lock_data_id, LockMode mode);
+
+    static GroupLockMode held_mode(const LockRequestQueue& request_queue, txn_id_t except_txn_id);
+
+    static bool compatible(GroupLockMode held, LockMode mode);
+
+    bool unlock_without_latch(Transaction* txn, const LockDataId& lock_data_id);
+
     std::mutex latch_;      // 用于锁表的并发
     std::unordered_map<LockDataId, LockRequestQueue> lock_table_;   // 全局锁表
 };
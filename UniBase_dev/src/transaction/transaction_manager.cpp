@@ -79,16 +79,16 @@ void TransactionManager::abort(Transaction* txn, LogManager* log_manager) {
     auto writeSet = txn->get_write_set();
     while (!writeSet->empty()) {
         auto& item = writeSet->back();
-        auto context = new Context(lock_manager_, log_manager, txn);
+        Context context(lock_manager_, log_manager, txn);
         switch (item->GetWriteType()) {
         case WType::INSERT_TUPLE:
-            sm_manager_->rollback_insert(item->GetTableName(), item->GetRid(), context);
+            sm_manager_->rollback_insert(item->GetTableName(), item->GetRid(), &context);
             break;
         case WType::UPDATE_TUPLE:
-            sm_manager_->rollback_update(item->GetTableName(), item->GetRid(), item->GetRecord(), context);
+            sm_manager_->rollback_update(item->GetTableName(), item->GetRid(), item->GetRecord(), &context);
             break;
         case WType::DELETE_TUPLE:
-            sm_manager_->rollback_delete(item->GetTableName(), item->GetRecord(), context);
+            sm_manager_->rollback_delete(item->GetTableName(), item->GetRecord(), &context);
             break;
         default:
             break;
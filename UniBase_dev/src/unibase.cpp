@@ -1,5 +1,6 @@
 #include <netinet/in.h>
 #include <readline/readline.h>
+#include <climits>
 #include <csetjmp>
 #include <csignal>
 #include <unistd.h>
@@ -164,6 +165,7 @@ void *client_handler(void *sock_fd) {
         // future TODO: 格式化 sql_handler.result, 传给客户端
         // send result with fixed format, use protobuf in the future
         if (write(fd, data_send, offset + 1) == -1) {
+            delete context;
             break;
         }
         // 如果是单挑语句，需要按照一个完整的事务来执行，所以执行完当前语句后，自动提交事务
@@ -171,6 +173,8 @@ void *client_handler(void *sock_fd) {
         {
             txn_manager->commit(context->txn_, context->log_mgr_);
         }
+        // 语句执行完毕，本条语句在context的arena中分配的内存随context一次性释放
+        delete context;
     }
 
     // Clear
@@ -249,6 +253,7 @@ void start_server() {
     if(ret == -1) { printf("%s\n", strerror(errno)); }
 //    assert(ret != -1);
     sm_manager->close_db();
+    buffer_pool_manager->stop_trace();
     std::cout << " DB has been closed.\n";
     std::cout << "Server shuts down." << std::endl;
 }
@@ -273,9 +278,24 @@ int main(int argc, char **argv) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
         }
+        // 设置了UNIBASE_BPM_TRACE环境变量时，记录缓冲池访问轨迹，供replacer_trace_bench离线分析
+        // open_db会切换到数据库目录，相对路径要先按启动时的工作目录转为绝对路径
+        std::string trace_path;
+        if (const char *path = getenv("UNIBASE_BPM_TRACE")) {
+            trace_path = path;
+            char cwd[PATH_MAX];
+            if (!trace_path.empty() && trace_path[0] != '/' && getcwd(cwd, sizeof(cwd)) != nullptr) {
+                trace_path = std::string(cwd) + "/" + trace_path;
+            }
+        }
+
         // Open database
         sm_manager->open_db(db_name);
 
+        if (!trace_path.empty()) {
+            buffer_pool_manager->start_trace(trace_path);
+        }
+
         // recovery database
         recovery->analyze();
         recovery->redo();